@@ -2,6 +2,22 @@
 #define CRC32_HEADER
 #include "STDTypes.h"
 
+//////////////////////////////////////////////////////////////////////////////
+// CRC32_SLICE_BY selects how many bytes one loop iteration consumes:
+// 1 is the classic table loop, 8 and 16 use the slicing tables.
+//////////////////////////////////////////////////////////////////////////////
+#ifndef CRC32_SLICE_BY
+#define CRC32_SLICE_BY 16
+#endif
+
+#if ( CRC32_SLICE_BY != 1 ) && ( CRC32_SLICE_BY != 8 ) && ( CRC32_SLICE_BY != 16 )
+#error "CRC32_SLICE_BY must be 1, 8 or 16"
+#endif
+
+#if CRC32_SLICE_BY > 1
+#include "CRC32Slicing.h"
+#endif
+
 //////////////////////////////////////////////////////////////////////////////
 // Standard CRC-32 constants table
 // It's polynomial is 0x04C11DB7 and stc is 0xffffffff
@@ -96,12 +112,24 @@ uint32_t __crc32_table[ 256 ] = { ( uint32_t ) ( 0x00000000 ), ( uint32_t ) ( 0x
                                   ( uint32_t ) ( 0x2d02ef8d ) };
 
 /**
- * Get standard CRC32(which the polynomial is 0x04C11DB7) value.
+ * Continue a standard CRC32 with the next buffer, crc is the value returned for the previous data (0 to start).
  */
 
-uint32_t CRC32( uint8_t* buffer, uint32_t length )
+uint32_t CRC32TableUpdate( uint32_t crc, uint8_t* buffer, uint32_t length )
 {
-    uint32_t crc = 0xFFFFFFFF;
+    crc = crc ^ 0xFFFFFFFF;
+#if CRC32_SLICE_BY > 1
+    const uint32_t( *t )[ 256 ] = __crc32_slicing_table;
+    for ( ; length >= CRC32_SLICE_BY; length -= CRC32_SLICE_BY, buffer += CRC32_SLICE_BY )
+    {
+        // Bytes are assembled one by one so the loop does not depend on alignment or endianness.
+        uint32_t a = crc ^ ( ( uint32_t ) buffer[ 0 ] | ( ( uint32_t ) buffer[ 1 ] << 8 ) |
+                             ( ( uint32_t ) buffer[ 2 ] << 16 ) | ( ( uint32_t ) buffer[ 3 ] << 24 ) );
+        crc = t[ CRC32_SLICE_BY - 1 ][ a & 0xFF ] ^ t[ CRC32_SLICE_BY - 2 ][ ( a >> 8 ) & 0xFF ] ^
+              t[ CRC32_SLICE_BY - 3 ][ ( a >> 16 ) & 0xFF ] ^ t[ CRC32_SLICE_BY - 4 ][ a >> 24 ];
+        for ( uint32_t i = 4; i < CRC32_SLICE_BY; ++i ) { crc ^= t[ CRC32_SLICE_BY - 1 - i ][ buffer[ i ] ]; }
+    }
+#endif
     for ( uint32_t i = 0; i < length; ++i )
     {
         uint8_t k = ( ( uint8_t* ) buffer )[ i ];
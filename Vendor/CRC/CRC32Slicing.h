@@ -0,0 +1,733 @@
+#ifndef CRC32_SLICING_HEADER
+#define CRC32_SLICING_HEADER
+#include "STDTypes.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// Slicing-by-16 CRC-32 tables, same polynomial and reflection as CRC32.h
+// Table 0 is the classic one byte table, table k holds the CRC of a byte
+// followed by k zero bytes: T[k][i] = (T[k-1][i] >> 8) ^ T[0][T[k-1][i] & 0xFF]
+//////////////////////////////////////////////////////////////////////////////
+static const uint32_t __crc32_slicing_table[ 16 ][ 256 ] = {
+        {
+                0x00000000u, 0x77073096u, 0xee0e612cu, 0x990951bau, 0x076dc419u, 0x706af48fu,
+                0xe963a535u, 0x9e6495a3u, 0x0edb8832u, 0x79dcb8a4u, 0xe0d5e91eu, 0x97d2d988u,
+                0x09b64c2bu, 0x7eb17cbdu, 0xe7b82d07u, 0x90bf1d91u, 0x1db71064u, 0x6ab020f2u,
+                0xf3b97148u, 0x84be41deu, 0x1adad47du, 0x6ddde4ebu, 0xf4d4b551u, 0x83d385c7u,
+                0x136c9856u, 0x646ba8c0u, 0xfd62f97au, 0x8a65c9ecu, 0x14015c4fu, 0x63066cd9u,
+                0xfa0f3d63u, 0x8d080df5u, 0x3b6e20c8u, 0x4c69105eu, 0xd56041e4u, 0xa2677172u,
+                0x3c03e4d1u, 0x4b04d447u, 0xd20d85fdu, 0xa50ab56bu, 0x35b5a8fau, 0x42b2986cu,
+                0xdbbbc9d6u, 0xacbcf940u, 0x32d86ce3u, 0x45df5c75u, 0xdcd60dcfu, 0xabd13d59u,
+                0x26d930acu, 0x51de003au, 0xc8d75180u, 0xbfd06116u, 0x21b4f4b5u, 0x56b3c423u,
+                0xcfba9599u, 0xb8bda50fu, 0x2802b89eu, 0x5f058808u, 0xc60cd9b2u, 0xb10be924u,
+                0x2f6f7c87u, 0x58684c11u, 0xc1611dabu, 0xb6662d3du, 0x76dc4190u, 0x01db7106u,
+                0x98d220bcu, 0xefd5102au, 0x71b18589u, 0x06b6b51fu, 0x9fbfe4a5u, 0xe8b8d433u,
+                0x7807c9a2u, 0x0f00f934u, 0x9609a88eu, 0xe10e9818u, 0x7f6a0dbbu, 0x086d3d2du,
+                0x91646c97u, 0xe6635c01u, 0x6b6b51f4u, 0x1c6c6162u, 0x856530d8u, 0xf262004eu,
+                0x6c0695edu, 0x1b01a57bu, 0x8208f4c1u, 0xf50fc457u, 0x65b0d9c6u, 0x12b7e950u,
+                0x8bbeb8eau, 0xfcb9887cu, 0x62dd1ddfu, 0x15da2d49u, 0x8cd37cf3u, 0xfbd44c65u,
+                0x4db26158u, 0x3ab551ceu, 0xa3bc0074u, 0xd4bb30e2u, 0x4adfa541u, 0x3dd895d7u,
+                0xa4d1c46du, 0xd3d6f4fbu, 0x4369e96au, 0x346ed9fcu, 0xad678846u, 0xda60b8d0u,
+                0x44042d73u, 0x33031de5u, 0xaa0a4c5fu, 0xdd0d7cc9u, 0x5005713cu, 0x270241aau,
+                0xbe0b1010u, 0xc90c2086u, 0x5768b525u, 0x206f85b3u, 0xb966d409u, 0xce61e49fu,
+                0x5edef90eu, 0x29d9c998u, 0xb0d09822u, 0xc7d7a8b4u, 0x59b33d17u, 0x2eb40d81u,
+                0xb7bd5c3bu, 0xc0ba6cadu, 0xedb88320u, 0x9abfb3b6u, 0x03b6e20cu, 0x74b1d29au,
+                0xead54739u, 0x9dd277afu, 0x04db2615u, 0x73dc1683u, 0xe3630b12u, 0x94643b84u,
+                0x0d6d6a3eu, 0x7a6a5aa8u, 0xe40ecf0bu, 0x9309ff9du, 0x0a00ae27u, 0x7d079eb1u,
+                0xf00f9344u, 0x8708a3d2u, 0x1e01f268u, 0x6906c2feu, 0xf762575du, 0x806567cbu,
+                0x196c3671u, 0x6e6b06e7u, 0xfed41b76u, 0x89d32be0u, 0x10da7a5au, 0x67dd4accu,
+                0xf9b9df6fu, 0x8ebeeff9u, 0x17b7be43u, 0x60b08ed5u, 0xd6d6a3e8u, 0xa1d1937eu,
+                0x38d8c2c4u, 0x4fdff252u, 0xd1bb67f1u, 0xa6bc5767u, 0x3fb506ddu, 0x48b2364bu,
+                0xd80d2bdau, 0xaf0a1b4cu, 0x36034af6u, 0x41047a60u, 0xdf60efc3u, 0xa867df55u,
+                0x316e8eefu, 0x4669be79u, 0xcb61b38cu, 0xbc66831au, 0x256fd2a0u, 0x5268e236u,
+                0xcc0c7795u, 0xbb0b4703u, 0x220216b9u, 0x5505262fu, 0xc5ba3bbeu, 0xb2bd0b28u,
+                0x2bb45a92u, 0x5cb36a04u, 0xc2d7ffa7u, 0xb5d0cf31u, 0x2cd99e8bu, 0x5bdeae1du,
+                0x9b64c2b0u, 0xec63f226u, 0x756aa39cu, 0x026d930au, 0x9c0906a9u, 0xeb0e363fu,
+                0x72076785u, 0x05005713u, 0x95bf4a82u, 0xe2b87a14u, 0x7bb12baeu, 0x0cb61b38u,
+                0x92d28e9bu, 0xe5d5be0du, 0x7cdcefb7u, 0x0bdbdf21u, 0x86d3d2d4u, 0xf1d4e242u,
+                0x68ddb3f8u, 0x1fda836eu, 0x81be16cdu, 0xf6b9265bu, 0x6fb077e1u, 0x18b74777u,
+                0x88085ae6u, 0xff0f6a70u, 0x66063bcau, 0x11010b5cu, 0x8f659effu, 0xf862ae69u,
+                0x616bffd3u, 0x166ccf45u, 0xa00ae278u, 0xd70dd2eeu, 0x4e048354u, 0x3903b3c2u,
+                0xa7672661u, 0xd06016f7u, 0x4969474du, 0x3e6e77dbu, 0xaed16a4au, 0xd9d65adcu,
+                0x40df0b66u, 0x37d83bf0u, 0xa9bcae53u, 0xdebb9ec5u, 0x47b2cf7fu, 0x30b5ffe9u,
+                0xbdbdf21cu, 0xcabac28au, 0x53b39330u, 0x24b4a3a6u, 0xbad03605u, 0xcdd70693u,
+                0x54de5729u, 0x23d967bfu, 0xb3667a2eu, 0xc4614ab8u, 0x5d681b02u, 0x2a6f2b94u,
+                0xb40bbe37u, 0xc30c8ea1u, 0x5a05df1bu, 0x2d02ef8du
+        },
+        {
+                0x00000000u, 0x191b3141u, 0x32366282u, 0x2b2d53c3u, 0x646cc504u, 0x7d77f445u,
+                0x565aa786u, 0x4f4196c7u, 0xc8d98a08u, 0xd1c2bb49u, 0xfaefe88au, 0xe3f4d9cbu,
+                0xacb54f0cu, 0xb5ae7e4du, 0x9e832d8eu, 0x87981ccfu, 0x4ac21251u, 0x53d92310u,
+                0x78f470d3u, 0x61ef4192u, 0x2eaed755u, 0x37b5e614u, 0x1c98b5d7u, 0x05838496u,
+                0x821b9859u, 0x9b00a918u, 0xb02dfadbu, 0xa936cb9au, 0xe6775d5du, 0xff6c6c1cu,
+                0xd4413fdfu, 0xcd5a0e9eu, 0x958424a2u, 0x8c9f15e3u, 0xa7b24620u, 0xbea97761u,
+                0xf1e8e1a6u, 0xe8f3d0e7u, 0xc3de8324u, 0xdac5b265u, 0x5d5daeaau, 0x44469febu,
+                0x6f6bcc28u, 0x7670fd69u, 0x39316baeu, 0x202a5aefu, 0x0b07092cu, 0x121c386du,
+                0xdf4636f3u, 0xc65d07b2u, 0xed705471u, 0xf46b6530u, 0xbb2af3f7u, 0xa231c2b6u,
+                0x891c9175u, 0x9007a034u, 0x179fbcfbu, 0x0e848dbau, 0x25a9de79u, 0x3cb2ef38u,
+                0x73f379ffu, 0x6ae848beu, 0x41c51b7du, 0x58de2a3cu, 0xf0794f05u, 0xe9627e44u,
+                0xc24f2d87u, 0xdb541cc6u, 0x94158a01u, 0x8d0ebb40u, 0xa623e883u, 0xbf38d9c2u,
+                0x38a0c50du, 0x21bbf44cu, 0x0a96a78fu, 0x138d96ceu, 0x5ccc0009u, 0x45d73148u,
+                0x6efa628bu, 0x77e153cau, 0xbabb5d54u, 0xa3a06c15u, 0x888d3fd6u, 0x91960e97u,
+                0xded79850u, 0xc7cca911u, 0xece1fad2u, 0xf5facb93u, 0x7262d75cu, 0x6b79e61du,
+                0x4054b5deu, 0x594f849fu, 0x160e1258u, 0x0f152319u, 0x243870dau, 0x3d23419bu,
+                0x65fd6ba7u, 0x7ce65ae6u, 0x57cb0925u, 0x4ed03864u, 0x0191aea3u, 0x188a9fe2u,
+                0x33a7cc21u, 0x2abcfd60u, 0xad24e1afu, 0xb43fd0eeu, 0x9f12832du, 0x8609b26cu,
+                0xc94824abu, 0xd05315eau, 0xfb7e4629u, 0xe2657768u, 0x2f3f79f6u, 0x362448b7u,
+                0x1d091b74u, 0x04122a35u, 0x4b53bcf2u, 0x52488db3u, 0x7965de70u, 0x607eef31u,
+                0xe7e6f3feu, 0xfefdc2bfu, 0xd5d0917cu, 0xcccba03du, 0x838a36fau, 0x9a9107bbu,
+                0xb1bc5478u, 0xa8a76539u, 0x3b83984bu, 0x2298a90au, 0x09b5fac9u, 0x10aecb88u,
+                0x5fef5d4fu, 0x46f46c0eu, 0x6dd93fcdu, 0x74c20e8cu, 0xf35a1243u, 0xea412302u,
+                0xc16c70c1u, 0xd8774180u, 0x9736d747u, 0x8e2de606u, 0xa500b5c5u, 0xbc1b8484u,
+                0x71418a1au, 0x685abb5bu, 0x4377e898u, 0x5a6cd9d9u, 0x152d4f1eu, 0x0c367e5fu,
+                0x271b2d9cu, 0x3e001cddu, 0xb9980012u, 0xa0833153u, 0x8bae6290u, 0x92b553d1u,
+                0xddf4c516u, 0xc4eff457u, 0xefc2a794u, 0xf6d996d5u, 0xae07bce9u, 0xb71c8da8u,
+                0x9c31de6bu, 0x852aef2au, 0xca6b79edu, 0xd37048acu, 0xf85d1b6fu, 0xe1462a2eu,
+                0x66de36e1u, 0x7fc507a0u, 0x54e85463u, 0x4df36522u, 0x02b2f3e5u, 0x1ba9c2a4u,
+                0x30849167u, 0x299fa026u, 0xe4c5aeb8u, 0xfdde9ff9u, 0xd6f3cc3au, 0xcfe8fd7bu,
+                0x80a96bbcu, 0x99b25afdu, 0xb29f093eu, 0xab84387fu, 0x2c1c24b0u, 0x350715f1u,
+                0x1e2a4632u, 0x07317773u, 0x4870e1b4u, 0x516bd0f5u, 0x7a468336u, 0x635db277u,
+                0xcbfad74eu, 0xd2e1e60fu, 0xf9ccb5ccu, 0xe0d7848du, 0xaf96124au, 0xb68d230bu,
+                0x9da070c8u, 0x84bb4189u, 0x03235d46u, 0x1a386c07u, 0x31153fc4u, 0x280e0e85u,
+                0x674f9842u, 0x7e54a903u, 0x5579fac0u, 0x4c62cb81u, 0x8138c51fu, 0x9823f45eu,
+                0xb30ea79du, 0xaa1596dcu, 0xe554001bu, 0xfc4f315au, 0xd7626299u, 0xce7953d8u,
+                0x49e14f17u, 0x50fa7e56u, 0x7bd72d95u, 0x62cc1cd4u, 0x2d8d8a13u, 0x3496bb52u,
+                0x1fbbe891u, 0x06a0d9d0u, 0x5e7ef3ecu, 0x4765c2adu, 0x6c48916eu, 0x7553a02fu,
+                0x3a1236e8u, 0x230907a9u, 0x0824546au, 0x113f652bu, 0x96a779e4u, 0x8fbc48a5u,
+                0xa4911b66u, 0xbd8a2a27u, 0xf2cbbce0u, 0xebd08da1u, 0xc0fdde62u, 0xd9e6ef23u,
+                0x14bce1bdu, 0x0da7d0fcu, 0x268a833fu, 0x3f91b27eu, 0x70d024b9u, 0x69cb15f8u,
+                0x42e6463bu, 0x5bfd777au, 0xdc656bb5u, 0xc57e5af4u, 0xee530937u, 0xf7483876u,
+                0xb809aeb1u, 0xa1129ff0u, 0x8a3fcc33u, 0x9324fd72u
+        },
+        {
+                0x00000000u, 0x01c26a37u, 0x0384d46eu, 0x0246be59u, 0x0709a8dcu, 0x06cbc2ebu,
+                0x048d7cb2u, 0x054f1685u, 0x0e1351b8u, 0x0fd13b8fu, 0x0d9785d6u, 0x0c55efe1u,
+                0x091af964u, 0x08d89353u, 0x0a9e2d0au, 0x0b5c473du, 0x1c26a370u, 0x1de4c947u,
+                0x1fa2771eu, 0x1e601d29u, 0x1b2f0bacu, 0x1aed619bu, 0x18abdfc2u, 0x1969b5f5u,
+                0x1235f2c8u, 0x13f798ffu, 0x11b126a6u, 0x10734c91u, 0x153c5a14u, 0x14fe3023u,
+                0x16b88e7au, 0x177ae44du, 0x384d46e0u, 0x398f2cd7u, 0x3bc9928eu, 0x3a0bf8b9u,
+                0x3f44ee3cu, 0x3e86840bu, 0x3cc03a52u, 0x3d025065u, 0x365e1758u, 0x379c7d6fu,
+                0x35dac336u, 0x3418a901u, 0x3157bf84u, 0x3095d5b3u, 0x32d36beau, 0x331101ddu,
+                0x246be590u, 0x25a98fa7u, 0x27ef31feu, 0x262d5bc9u, 0x23624d4cu, 0x22a0277bu,
+                0x20e69922u, 0x2124f315u, 0x2a78b428u, 0x2bbade1fu, 0x29fc6046u, 0x283e0a71u,
+                0x2d711cf4u, 0x2cb376c3u, 0x2ef5c89au, 0x2f37a2adu, 0x709a8dc0u, 0x7158e7f7u,
+                0x731e59aeu, 0x72dc3399u, 0x7793251cu, 0x76514f2bu, 0x7417f172u, 0x75d59b45u,
+                0x7e89dc78u, 0x7f4bb64fu, 0x7d0d0816u, 0x7ccf6221u, 0x798074a4u, 0x78421e93u,
+                0x7a04a0cau, 0x7bc6cafdu, 0x6cbc2eb0u, 0x6d7e4487u, 0x6f38fadeu, 0x6efa90e9u,
+                0x6bb5866cu, 0x6a77ec5bu, 0x68315202u, 0x69f33835u, 0x62af7f08u, 0x636d153fu,
+                0x612bab66u, 0x60e9c151u, 0x65a6d7d4u, 0x6464bde3u, 0x662203bau, 0x67e0698du,
+                0x48d7cb20u, 0x4915a117u, 0x4b531f4eu, 0x4a917579u, 0x4fde63fcu, 0x4e1c09cbu,
+                0x4c5ab792u, 0x4d98dda5u, 0x46c49a98u, 0x4706f0afu, 0x45404ef6u, 0x448224c1u,
+                0x41cd3244u, 0x400f5873u, 0x4249e62au, 0x438b8c1du, 0x54f16850u, 0x55330267u,
+                0x5775bc3eu, 0x56b7d609u, 0x53f8c08cu, 0x523aaabbu, 0x507c14e2u, 0x51be7ed5u,
+                0x5ae239e8u, 0x5b2053dfu, 0x5966ed86u, 0x58a487b1u, 0x5deb9134u, 0x5c29fb03u,
+                0x5e6f455au, 0x5fad2f6du, 0xe1351b80u, 0xe0f771b7u, 0xe2b1cfeeu, 0xe373a5d9u,
+                0xe63cb35cu, 0xe7fed96bu, 0xe5b86732u, 0xe47a0d05u, 0xef264a38u, 0xeee4200fu,
+                0xeca29e56u, 0xed60f461u, 0xe82fe2e4u, 0xe9ed88d3u, 0xebab368au, 0xea695cbdu,
+                0xfd13b8f0u, 0xfcd1d2c7u, 0xfe976c9eu, 0xff5506a9u, 0xfa1a102cu, 0xfbd87a1bu,
+                0xf99ec442u, 0xf85cae75u, 0xf300e948u, 0xf2c2837fu, 0xf0843d26u, 0xf1465711u,
+                0xf4094194u, 0xf5cb2ba3u, 0xf78d95fau, 0xf64fffcdu, 0xd9785d60u, 0xd8ba3757u,
+                0xdafc890eu, 0xdb3ee339u, 0xde71f5bcu, 0xdfb39f8bu, 0xddf521d2u, 0xdc374be5u,
+                0xd76b0cd8u, 0xd6a966efu, 0xd4efd8b6u, 0xd52db281u, 0xd062a404u, 0xd1a0ce33u,
+                0xd3e6706au, 0xd2241a5du, 0xc55efe10u, 0xc49c9427u, 0xc6da2a7eu, 0xc7184049u,
+                0xc25756ccu, 0xc3953cfbu, 0xc1d382a2u, 0xc011e895u, 0xcb4dafa8u, 0xca8fc59fu,
+                0xc8c97bc6u, 0xc90b11f1u, 0xcc440774u, 0xcd866d43u, 0xcfc0d31au, 0xce02b92du,
+                0x91af9640u, 0x906dfc77u, 0x922b422eu, 0x93e92819u, 0x96a63e9cu, 0x976454abu,
+                0x9522eaf2u, 0x94e080c5u, 0x9fbcc7f8u, 0x9e7eadcfu, 0x9c381396u, 0x9dfa79a1u,
+                0x98b56f24u, 0x99770513u, 0x9b31bb4au, 0x9af3d17du, 0x8d893530u, 0x8c4b5f07u,
+                0x8e0de15eu, 0x8fcf8b69u, 0x8a809decu, 0x8b42f7dbu, 0x89044982u, 0x88c623b5u,
+                0x839a6488u, 0x82580ebfu, 0x801eb0e6u, 0x81dcdad1u, 0x8493cc54u, 0x8551a663u,
+                0x8717183au, 0x86d5720du, 0xa9e2d0a0u, 0xa820ba97u, 0xaa6604ceu, 0xaba46ef9u,
+                0xaeeb787cu, 0xaf29124bu, 0xad6fac12u, 0xacadc625u, 0xa7f18118u, 0xa633eb2fu,
+                0xa4755576u, 0xa5b73f41u, 0xa0f829c4u, 0xa13a43f3u, 0xa37cfdaau, 0xa2be979du,
+                0xb5c473d0u, 0xb40619e7u, 0xb640a7beu, 0xb782cd89u, 0xb2cddb0cu, 0xb30fb13bu,
+                0xb1490f62u, 0xb08b6555u, 0xbbd72268u, 0xba15485fu, 0xb853f606u, 0xb9919c31u,
+                0xbcde8ab4u, 0xbd1ce083u, 0xbf5a5edau, 0xbe9834edu
+        },
+        {
+                0x00000000u, 0xb8bc6765u, 0xaa09c88bu, 0x12b5afeeu, 0x8f629757u, 0x37def032u,
+                0x256b5fdcu, 0x9dd738b9u, 0xc5b428efu, 0x7d084f8au, 0x6fbde064u, 0xd7018701u,
+                0x4ad6bfb8u, 0xf26ad8ddu, 0xe0df7733u, 0x58631056u, 0x5019579fu, 0xe8a530fau,
+                0xfa109f14u, 0x42acf871u, 0xdf7bc0c8u, 0x67c7a7adu, 0x75720843u, 0xcdce6f26u,
+                0x95ad7f70u, 0x2d111815u, 0x3fa4b7fbu, 0x8718d09eu, 0x1acfe827u, 0xa2738f42u,
+                0xb0c620acu, 0x087a47c9u, 0xa032af3eu, 0x188ec85bu, 0x0a3b67b5u, 0xb28700d0u,
+                0x2f503869u, 0x97ec5f0cu, 0x8559f0e2u, 0x3de59787u, 0x658687d1u, 0xdd3ae0b4u,
+                0xcf8f4f5au, 0x7733283fu, 0xeae41086u, 0x525877e3u, 0x40edd80du, 0xf851bf68u,
+                0xf02bf8a1u, 0x48979fc4u, 0x5a22302au, 0xe29e574fu, 0x7f496ff6u, 0xc7f50893u,
+                0xd540a77du, 0x6dfcc018u, 0x359fd04eu, 0x8d23b72bu, 0x9f9618c5u, 0x272a7fa0u,
+                0xbafd4719u, 0x0241207cu, 0x10f48f92u, 0xa848e8f7u, 0x9b14583du, 0x23a83f58u,
+                0x311d90b6u, 0x89a1f7d3u, 0x1476cf6au, 0xaccaa80fu, 0xbe7f07e1u, 0x06c36084u,
+                0x5ea070d2u, 0xe61c17b7u, 0xf4a9b859u, 0x4c15df3cu, 0xd1c2e785u, 0x697e80e0u,
+                0x7bcb2f0eu, 0xc377486bu, 0xcb0d0fa2u, 0x73b168c7u, 0x6104c729u, 0xd9b8a04cu,
+                0x446f98f5u, 0xfcd3ff90u, 0xee66507eu, 0x56da371bu, 0x0eb9274du, 0xb6054028u,
+                0xa4b0efc6u, 0x1c0c88a3u, 0x81dbb01au, 0x3967d77fu, 0x2bd27891u, 0x936e1ff4u,
+                0x3b26f703u, 0x839a9066u, 0x912f3f88u, 0x299358edu, 0xb4446054u, 0x0cf80731u,
+                0x1e4da8dfu, 0xa6f1cfbau, 0xfe92dfecu, 0x462eb889u, 0x549b1767u, 0xec277002u,
+                0x71f048bbu, 0xc94c2fdeu, 0xdbf98030u, 0x6345e755u, 0x6b3fa09cu, 0xd383c7f9u,
+                0xc1366817u, 0x798a0f72u, 0xe45d37cbu, 0x5ce150aeu, 0x4e54ff40u, 0xf6e89825u,
+                0xae8b8873u, 0x1637ef16u, 0x048240f8u, 0xbc3e279du, 0x21e91f24u, 0x99557841u,
+                0x8be0d7afu, 0x335cb0cau, 0xed59b63bu, 0x55e5d15eu, 0x47507eb0u, 0xffec19d5u,
+                0x623b216cu, 0xda874609u, 0xc832e9e7u, 0x708e8e82u, 0x28ed9ed4u, 0x9051f9b1u,
+                0x82e4565fu, 0x3a58313au, 0xa78f0983u, 0x1f336ee6u, 0x0d86c108u, 0xb53aa66du,
+                0xbd40e1a4u, 0x05fc86c1u, 0x1749292fu, 0xaff54e4au, 0x322276f3u, 0x8a9e1196u,
+                0x982bbe78u, 0x2097d91du, 0x78f4c94bu, 0xc048ae2eu, 0xd2fd01c0u, 0x6a4166a5u,
+                0xf7965e1cu, 0x4f2a3979u, 0x5d9f9697u, 0xe523f1f2u, 0x4d6b1905u, 0xf5d77e60u,
+                0xe762d18eu, 0x5fdeb6ebu, 0xc2098e52u, 0x7ab5e937u, 0x680046d9u, 0xd0bc21bcu,
+                0x88df31eau, 0x3063568fu, 0x22d6f961u, 0x9a6a9e04u, 0x07bda6bdu, 0xbf01c1d8u,
+                0xadb46e36u, 0x15080953u, 0x1d724e9au, 0xa5ce29ffu, 0xb77b8611u, 0x0fc7e174u,
+                0x9210d9cdu, 0x2aacbea8u, 0x38191146u, 0x80a57623u, 0xd8c66675u, 0x607a0110u,
+                0x72cfaefeu, 0xca73c99bu, 0x57a4f122u, 0xef189647u, 0xfdad39a9u, 0x45115eccu,
+                0x764dee06u, 0xcef18963u, 0xdc44268du, 0x64f841e8u, 0xf92f7951u, 0x41931e34u,
+                0x5326b1dau, 0xeb9ad6bfu, 0xb3f9c6e9u, 0x0b45a18cu, 0x19f00e62u, 0xa14c6907u,
+                0x3c9b51beu, 0x842736dbu, 0x96929935u, 0x2e2efe50u, 0x2654b999u, 0x9ee8defcu,
+                0x8c5d7112u, 0x34e11677u, 0xa9362eceu, 0x118a49abu, 0x033fe645u, 0xbb838120u,
+                0xe3e09176u, 0x5b5cf613u, 0x49e959fdu, 0xf1553e98u, 0x6c820621u, 0xd43e6144u,
+                0xc68bceaau, 0x7e37a9cfu, 0xd67f4138u, 0x6ec3265du, 0x7c7689b3u, 0xc4caeed6u,
+                0x591dd66fu, 0xe1a1b10au, 0xf3141ee4u, 0x4ba87981u, 0x13cb69d7u, 0xab770eb2u,
+                0xb9c2a15cu, 0x017ec639u, 0x9ca9fe80u, 0x241599e5u, 0x36a0360bu, 0x8e1c516eu,
+                0x866616a7u, 0x3eda71c2u, 0x2c6fde2cu, 0x94d3b949u, 0x090481f0u, 0xb1b8e695u,
+                0xa30d497bu, 0x1bb12e1eu, 0x43d23e48u, 0xfb6e592du, 0xe9dbf6c3u, 0x516791a6u,
+                0xccb0a91fu, 0x740cce7au, 0x66b96194u, 0xde0506f1u
+        },
+        {
+                0x00000000u, 0x3d6029b0u, 0x7ac05360u, 0x47a07ad0u, 0xf580a6c0u, 0xc8e08f70u,
+                0x8f40f5a0u, 0xb220dc10u, 0x30704bc1u, 0x0d106271u, 0x4ab018a1u, 0x77d03111u,
+                0xc5f0ed01u, 0xf890c4b1u, 0xbf30be61u, 0x825097d1u, 0x60e09782u, 0x5d80be32u,
+                0x1a20c4e2u, 0x2740ed52u, 0x95603142u, 0xa80018f2u, 0xefa06222u, 0xd2c04b92u,
+                0x5090dc43u, 0x6df0f5f3u, 0x2a508f23u, 0x1730a693u, 0xa5107a83u, 0x98705333u,
+                0xdfd029e3u, 0xe2b00053u, 0xc1c12f04u, 0xfca106b4u, 0xbb017c64u, 0x866155d4u,
+                0x344189c4u, 0x0921a074u, 0x4e81daa4u, 0x73e1f314u, 0xf1b164c5u, 0xccd14d75u,
+                0x8b7137a5u, 0xb6111e15u, 0x0431c205u, 0x3951ebb5u, 0x7ef19165u, 0x4391b8d5u,
+                0xa121b886u, 0x9c419136u, 0xdbe1ebe6u, 0xe681c256u, 0x54a11e46u, 0x69c137f6u,
+                0x2e614d26u, 0x13016496u, 0x9151f347u, 0xac31daf7u, 0xeb91a027u, 0xd6f18997u,
+                0x64d15587u, 0x59b17c37u, 0x1e1106e7u, 0x23712f57u, 0x58f35849u, 0x659371f9u,
+                0x22330b29u, 0x1f532299u, 0xad73fe89u, 0x9013d739u, 0xd7b3ade9u, 0xead38459u,
+                0x68831388u, 0x55e33a38u, 0x124340e8u, 0x2f236958u, 0x9d03b548u, 0xa0639cf8u,
+                0xe7c3e628u, 0xdaa3cf98u, 0x3813cfcbu, 0x0573e67bu, 0x42d39cabu, 0x7fb3b51bu,
+                0xcd93690bu, 0xf0f340bbu, 0xb7533a6bu, 0x8a3313dbu, 0x0863840au, 0x3503adbau,
+                0x72a3d76au, 0x4fc3fedau, 0xfde322cau, 0xc0830b7au, 0x872371aau, 0xba43581au,
+                0x9932774du, 0xa4525efdu, 0xe3f2242du, 0xde920d9du, 0x6cb2d18du, 0x51d2f83du,
+                0x167282edu, 0x2b12ab5du, 0xa9423c8cu, 0x9422153cu, 0xd3826fecu, 0xeee2465cu,
+                0x5cc29a4cu, 0x61a2b3fcu, 0x2602c92cu, 0x1b62e09cu, 0xf9d2e0cfu, 0xc4b2c97fu,
+                0x8312b3afu, 0xbe729a1fu, 0x0c52460fu, 0x31326fbfu, 0x7692156fu, 0x4bf23cdfu,
+                0xc9a2ab0eu, 0xf4c282beu, 0xb362f86eu, 0x8e02d1deu, 0x3c220dceu, 0x0142247eu,
+                0x46e25eaeu, 0x7b82771eu, 0xb1e6b092u, 0x8c869922u, 0xcb26e3f2u, 0xf646ca42u,
+                0x44661652u, 0x79063fe2u, 0x3ea64532u, 0x03c66c82u, 0x8196fb53u, 0xbcf6d2e3u,
+                0xfb56a833u, 0xc6368183u, 0x74165d93u, 0x49767423u, 0x0ed60ef3u, 0x33b62743u,
+                0xd1062710u, 0xec660ea0u, 0xabc67470u, 0x96a65dc0u, 0x248681d0u, 0x19e6a860u,
+                0x5e46d2b0u, 0x6326fb00u, 0xe1766cd1u, 0xdc164561u, 0x9bb63fb1u, 0xa6d61601u,
+                0x14f6ca11u, 0x2996e3a1u, 0x6e369971u, 0x5356b0c1u, 0x70279f96u, 0x4d47b626u,
+                0x0ae7ccf6u, 0x3787e546u, 0x85a73956u, 0xb8c710e6u, 0xff676a36u, 0xc2074386u,
+                0x4057d457u, 0x7d37fde7u, 0x3a978737u, 0x07f7ae87u, 0xb5d77297u, 0x88b75b27u,
+                0xcf1721f7u, 0xf2770847u, 0x10c70814u, 0x2da721a4u, 0x6a075b74u, 0x576772c4u,
+                0xe547aed4u, 0xd8278764u, 0x9f87fdb4u, 0xa2e7d404u, 0x20b743d5u, 0x1dd76a65u,
+                0x5a7710b5u, 0x67173905u, 0xd537e515u, 0xe857cca5u, 0xaff7b675u, 0x92979fc5u,
+                0xe915e8dbu, 0xd475c16bu, 0x93d5bbbbu, 0xaeb5920bu, 0x1c954e1bu, 0x21f567abu,
+                0x66551d7bu, 0x5b3534cbu, 0xd965a31au, 0xe4058aaau, 0xa3a5f07au, 0x9ec5d9cau,
+                0x2ce505dau, 0x11852c6au, 0x562556bau, 0x6b457f0au, 0x89f57f59u, 0xb49556e9u,
+                0xf3352c39u, 0xce550589u, 0x7c75d999u, 0x4115f029u, 0x06b58af9u, 0x3bd5a349u,
+                0xb9853498u, 0x84e51d28u, 0xc34567f8u, 0xfe254e48u, 0x4c059258u, 0x7165bbe8u,
+                0x36c5c138u, 0x0ba5e888u, 0x28d4c7dfu, 0x15b4ee6fu, 0x521494bfu, 0x6f74bd0fu,
+                0xdd54611fu, 0xe03448afu, 0xa794327fu, 0x9af41bcfu, 0x18a48c1eu, 0x25c4a5aeu,
+                0x6264df7eu, 0x5f04f6ceu, 0xed242adeu, 0xd044036eu, 0x97e479beu, 0xaa84500eu,
+                0x4834505du, 0x755479edu, 0x32f4033du, 0x0f942a8du, 0xbdb4f69du, 0x80d4df2du,
+                0xc774a5fdu, 0xfa148c4du, 0x78441b9cu, 0x4524322cu, 0x028448fcu, 0x3fe4614cu,
+                0x8dc4bd5cu, 0xb0a494ecu, 0xf704ee3cu, 0xca64c78cu
+        },
+        {
+                0x00000000u, 0xcb5cd3a5u, 0x4dc8a10bu, 0x869472aeu, 0x9b914216u, 0x50cd91b3u,
+                0xd659e31du, 0x1d0530b8u, 0xec53826du, 0x270f51c8u, 0xa19b2366u, 0x6ac7f0c3u,
+                0x77c2c07bu, 0xbc9e13deu, 0x3a0a6170u, 0xf156b2d5u, 0x03d6029bu, 0xc88ad13eu,
+                0x4e1ea390u, 0x85427035u, 0x9847408du, 0x531b9328u, 0xd58fe186u, 0x1ed33223u,
+                0xef8580f6u, 0x24d95353u, 0xa24d21fdu, 0x6911f258u, 0x7414c2e0u, 0xbf481145u,
+                0x39dc63ebu, 0xf280b04eu, 0x07ac0536u, 0xccf0d693u, 0x4a64a43du, 0x81387798u,
+                0x9c3d4720u, 0x57619485u, 0xd1f5e62bu, 0x1aa9358eu, 0xebff875bu, 0x20a354feu,
+                0xa6372650u, 0x6d6bf5f5u, 0x706ec54du, 0xbb3216e8u, 0x3da66446u, 0xf6fab7e3u,
+                0x047a07adu, 0xcf26d408u, 0x49b2a6a6u, 0x82ee7503u, 0x9feb45bbu, 0x54b7961eu,
+                0xd223e4b0u, 0x197f3715u, 0xe82985c0u, 0x23755665u, 0xa5e124cbu, 0x6ebdf76eu,
+                0x73b8c7d6u, 0xb8e41473u, 0x3e7066ddu, 0xf52cb578u, 0x0f580a6cu, 0xc404d9c9u,
+                0x4290ab67u, 0x89cc78c2u, 0x94c9487au, 0x5f959bdfu, 0xd901e971u, 0x125d3ad4u,
+                0xe30b8801u, 0x28575ba4u, 0xaec3290au, 0x659ffaafu, 0x789aca17u, 0xb3c619b2u,
+                0x35526b1cu, 0xfe0eb8b9u, 0x0c8e08f7u, 0xc7d2db52u, 0x4146a9fcu, 0x8a1a7a59u,
+                0x971f4ae1u, 0x5c439944u, 0xdad7ebeau, 0x118b384fu, 0xe0dd8a9au, 0x2b81593fu,
+                0xad152b91u, 0x6649f834u, 0x7b4cc88cu, 0xb0101b29u, 0x36846987u, 0xfdd8ba22u,
+                0x08f40f5au, 0xc3a8dcffu, 0x453cae51u, 0x8e607df4u, 0x93654d4cu, 0x58399ee9u,
+                0xdeadec47u, 0x15f13fe2u, 0xe4a78d37u, 0x2ffb5e92u, 0xa96f2c3cu, 0x6233ff99u,
+                0x7f36cf21u, 0xb46a1c84u, 0x32fe6e2au, 0xf9a2bd8fu, 0x0b220dc1u, 0xc07ede64u,
+                0x46eaaccau, 0x8db67f6fu, 0x90b34fd7u, 0x5bef9c72u, 0xdd7beedcu, 0x16273d79u,
+                0xe7718facu, 0x2c2d5c09u, 0xaab92ea7u, 0x61e5fd02u, 0x7ce0cdbau, 0xb7bc1e1fu,
+                0x31286cb1u, 0xfa74bf14u, 0x1eb014d8u, 0xd5ecc77du, 0x5378b5d3u, 0x98246676u,
+                0x852156ceu, 0x4e7d856bu, 0xc8e9f7c5u, 0x03b52460u, 0xf2e396b5u, 0x39bf4510u,
+                0xbf2b37beu, 0x7477e41bu, 0x6972d4a3u, 0xa22e0706u, 0x24ba75a8u, 0xefe6a60du,
+                0x1d661643u, 0xd63ac5e6u, 0x50aeb748u, 0x9bf264edu, 0x86f75455u, 0x4dab87f0u,
+                0xcb3ff55eu, 0x006326fbu, 0xf135942eu, 0x3a69478bu, 0xbcfd3525u, 0x77a1e680u,
+                0x6aa4d638u, 0xa1f8059du, 0x276c7733u, 0xec30a496u, 0x191c11eeu, 0xd240c24bu,
+                0x54d4b0e5u, 0x9f886340u, 0x828d53f8u, 0x49d1805du, 0xcf45f2f3u, 0x04192156u,
+                0xf54f9383u, 0x3e134026u, 0xb8873288u, 0x73dbe12du, 0x6eded195u, 0xa5820230u,
+                0x2316709eu, 0xe84aa33bu, 0x1aca1375u, 0xd196c0d0u, 0x5702b27eu, 0x9c5e61dbu,
+                0x815b5163u, 0x4a0782c6u, 0xcc93f068u, 0x07cf23cdu, 0xf6999118u, 0x3dc542bdu,
+                0xbb513013u, 0x700de3b6u, 0x6d08d30eu, 0xa65400abu, 0x20c07205u, 0xeb9ca1a0u,
+                0x11e81eb4u, 0xdab4cd11u, 0x5c20bfbfu, 0x977c6c1au, 0x8a795ca2u, 0x41258f07u,
+                0xc7b1fda9u, 0x0ced2e0cu, 0xfdbb9cd9u, 0x36e74f7cu, 0xb0733dd2u, 0x7b2fee77u,
+                0x662adecfu, 0xad760d6au, 0x2be27fc4u, 0xe0beac61u, 0x123e1c2fu, 0xd962cf8au,
+                0x5ff6bd24u, 0x94aa6e81u, 0x89af5e39u, 0x42f38d9cu, 0xc467ff32u, 0x0f3b2c97u,
+                0xfe6d9e42u, 0x35314de7u, 0xb3a53f49u, 0x78f9ececu, 0x65fcdc54u, 0xaea00ff1u,
+                0x28347d5fu, 0xe368aefau, 0x16441b82u, 0xdd18c827u, 0x5b8cba89u, 0x90d0692cu,
+                0x8dd55994u, 0x46898a31u, 0xc01df89fu, 0x0b412b3au, 0xfa1799efu, 0x314b4a4au,
+                0xb7df38e4u, 0x7c83eb41u, 0x6186dbf9u, 0xaada085cu, 0x2c4e7af2u, 0xe712a957u,
+                0x15921919u, 0xdececabcu, 0x585ab812u, 0x93066bb7u, 0x8e035b0fu, 0x455f88aau,
+                0xc3cbfa04u, 0x089729a1u, 0xf9c19b74u, 0x329d48d1u, 0xb4093a7fu, 0x7f55e9dau,
+                0x6250d962u, 0xa90c0ac7u, 0x2f987869u, 0xe4c4abccu
+        },
+        {
+                0x00000000u, 0xa6770bb4u, 0x979f1129u, 0x31e81a9du, 0xf44f2413u, 0x52382fa7u,
+                0x63d0353au, 0xc5a73e8eu, 0x33ef4e67u, 0x959845d3u, 0xa4705f4eu, 0x020754fau,
+                0xc7a06a74u, 0x61d761c0u, 0x503f7b5du, 0xf64870e9u, 0x67de9cceu, 0xc1a9977au,
+                0xf0418de7u, 0x56368653u, 0x9391b8ddu, 0x35e6b369u, 0x040ea9f4u, 0xa279a240u,
+                0x5431d2a9u, 0xf246d91du, 0xc3aec380u, 0x65d9c834u, 0xa07ef6bau, 0x0609fd0eu,
+                0x37e1e793u, 0x9196ec27u, 0xcfbd399cu, 0x69ca3228u, 0x582228b5u, 0xfe552301u,
+                0x3bf21d8fu, 0x9d85163bu, 0xac6d0ca6u, 0x0a1a0712u, 0xfc5277fbu, 0x5a257c4fu,
+                0x6bcd66d2u, 0xcdba6d66u, 0x081d53e8u, 0xae6a585cu, 0x9f8242c1u, 0x39f54975u,
+                0xa863a552u, 0x0e14aee6u, 0x3ffcb47bu, 0x998bbfcfu, 0x5c2c8141u, 0xfa5b8af5u,
+                0xcbb39068u, 0x6dc49bdcu, 0x9b8ceb35u, 0x3dfbe081u, 0x0c13fa1cu, 0xaa64f1a8u,
+                0x6fc3cf26u, 0xc9b4c492u, 0xf85cde0fu, 0x5e2bd5bbu, 0x440b7579u, 0xe27c7ecdu,
+                0xd3946450u, 0x75e36fe4u, 0xb044516au, 0x16335adeu, 0x27db4043u, 0x81ac4bf7u,
+                0x77e43b1eu, 0xd19330aau, 0xe07b2a37u, 0x460c2183u, 0x83ab1f0du, 0x25dc14b9u,
+                0x14340e24u, 0xb2430590u, 0x23d5e9b7u, 0x85a2e203u, 0xb44af89eu, 0x123df32au,
+                0xd79acda4u, 0x71edc610u, 0x4005dc8du, 0xe672d739u, 0x103aa7d0u, 0xb64dac64u,
+                0x87a5b6f9u, 0x21d2bd4du, 0xe47583c3u, 0x42028877u, 0x73ea92eau, 0xd59d995eu,
+                0x8bb64ce5u, 0x2dc14751u, 0x1c295dccu, 0xba5e5678u, 0x7ff968f6u, 0xd98e6342u,
+                0xe86679dfu, 0x4e11726bu, 0xb8590282u, 0x1e2e0936u, 0x2fc613abu, 0x89b1181fu,
+                0x4c162691u, 0xea612d25u, 0xdb8937b8u, 0x7dfe3c0cu, 0xec68d02bu, 0x4a1fdb9fu,
+                0x7bf7c102u, 0xdd80cab6u, 0x1827f438u, 0xbe50ff8cu, 0x8fb8e511u, 0x29cfeea5u,
+                0xdf879e4cu, 0x79f095f8u, 0x48188f65u, 0xee6f84d1u, 0x2bc8ba5fu, 0x8dbfb1ebu,
+                0xbc57ab76u, 0x1a20a0c2u, 0x8816eaf2u, 0x2e61e146u, 0x1f89fbdbu, 0xb9fef06fu,
+                0x7c59cee1u, 0xda2ec555u, 0xebc6dfc8u, 0x4db1d47cu, 0xbbf9a495u, 0x1d8eaf21u,
+                0x2c66b5bcu, 0x8a11be08u, 0x4fb68086u, 0xe9c18b32u, 0xd82991afu, 0x7e5e9a1bu,
+                0xefc8763cu, 0x49bf7d88u, 0x78576715u, 0xde206ca1u, 0x1b87522fu, 0xbdf0599bu,
+                0x8c184306u, 0x2a6f48b2u, 0xdc27385bu, 0x7a5033efu, 0x4bb82972u, 0xedcf22c6u,
+                0x28681c48u, 0x8e1f17fcu, 0xbff70d61u, 0x198006d5u, 0x47abd36eu, 0xe1dcd8dau,
+                0xd034c247u, 0x7643c9f3u, 0xb3e4f77du, 0x1593fcc9u, 0x247be654u, 0x820cede0u,
+                0x74449d09u, 0xd23396bdu, 0xe3db8c20u, 0x45ac8794u, 0x800bb91au, 0x267cb2aeu,
+                0x1794a833u, 0xb1e3a387u, 0x20754fa0u, 0x86024414u, 0xb7ea5e89u, 0x119d553du,
+                0xd43a6bb3u, 0x724d6007u, 0x43a57a9au, 0xe5d2712eu, 0x139a01c7u, 0xb5ed0a73u,
+                0x840510eeu, 0x22721b5au, 0xe7d525d4u, 0x41a22e60u, 0x704a34fdu, 0xd63d3f49u,
+                0xcc1d9f8bu, 0x6a6a943fu, 0x5b828ea2u, 0xfdf58516u, 0x3852bb98u, 0x9e25b02cu,
+                0xafcdaab1u, 0x09baa105u, 0xfff2d1ecu, 0x5985da58u, 0x686dc0c5u, 0xce1acb71u,
+                0x0bbdf5ffu, 0xadcafe4bu, 0x9c22e4d6u, 0x3a55ef62u, 0xabc30345u, 0x0db408f1u,
+                0x3c5c126cu, 0x9a2b19d8u, 0x5f8c2756u, 0xf9fb2ce2u, 0xc813367fu, 0x6e643dcbu,
+                0x982c4d22u, 0x3e5b4696u, 0x0fb35c0bu, 0xa9c457bfu, 0x6c636931u, 0xca146285u,
+                0xfbfc7818u, 0x5d8b73acu, 0x03a0a617u, 0xa5d7ada3u, 0x943fb73eu, 0x3248bc8au,
+                0xf7ef8204u, 0x519889b0u, 0x6070932du, 0xc6079899u, 0x304fe870u, 0x9638e3c4u,
+                0xa7d0f959u, 0x01a7f2edu, 0xc400cc63u, 0x6277c7d7u, 0x539fdd4au, 0xf5e8d6feu,
+                0x647e3ad9u, 0xc209316du, 0xf3e12bf0u, 0x55962044u, 0x90311ecau, 0x3646157eu,
+                0x07ae0fe3u, 0xa1d90457u, 0x579174beu, 0xf1e67f0au, 0xc00e6597u, 0x66796e23u,
+                0xa3de50adu, 0x05a95b19u, 0x34414184u, 0x92364a30u
+        },
+        {
+                0x00000000u, 0xccaa009eu, 0x4225077du, 0x8e8f07e3u, 0x844a0efau, 0x48e00e64u,
+                0xc66f0987u, 0x0ac50919u, 0xd3e51bb5u, 0x1f4f1b2bu, 0x91c01cc8u, 0x5d6a1c56u,
+                0x57af154fu, 0x9b0515d1u, 0x158a1232u, 0xd92012acu, 0x7cbb312bu, 0xb01131b5u,
+                0x3e9e3656u, 0xf23436c8u, 0xf8f13fd1u, 0x345b3f4fu, 0xbad438acu, 0x767e3832u,
+                0xaf5e2a9eu, 0x63f42a00u, 0xed7b2de3u, 0x21d12d7du, 0x2b142464u, 0xe7be24fau,
+                0x69312319u, 0xa59b2387u, 0xf9766256u, 0x35dc62c8u, 0xbb53652bu, 0x77f965b5u,
+                0x7d3c6cacu, 0xb1966c32u, 0x3f196bd1u, 0xf3b36b4fu, 0x2a9379e3u, 0xe639797du,
+                0x68b67e9eu, 0xa41c7e00u, 0xaed97719u, 0x62737787u, 0xecfc7064u, 0x205670fau,
+                0x85cd537du, 0x496753e3u, 0xc7e85400u, 0x0b42549eu, 0x01875d87u, 0xcd2d5d19u,
+                0x43a25afau, 0x8f085a64u, 0x562848c8u, 0x9a824856u, 0x140d4fb5u, 0xd8a74f2bu,
+                0xd2624632u, 0x1ec846acu, 0x9047414fu, 0x5ced41d1u, 0x299dc2edu, 0xe537c273u,
+                0x6bb8c590u, 0xa712c50eu, 0xadd7cc17u, 0x617dcc89u, 0xeff2cb6au, 0x2358cbf4u,
+                0xfa78d958u, 0x36d2d9c6u, 0xb85dde25u, 0x74f7debbu, 0x7e32d7a2u, 0xb298d73cu,
+                0x3c17d0dfu, 0xf0bdd041u, 0x5526f3c6u, 0x998cf358u, 0x1703f4bbu, 0xdba9f425u,
+                0xd16cfd3cu, 0x1dc6fda2u, 0x9349fa41u, 0x5fe3fadfu, 0x86c3e873u, 0x4a69e8edu,
+                0xc4e6ef0eu, 0x084cef90u, 0x0289e689u, 0xce23e617u, 0x40ace1f4u, 0x8c06e16au,
+                0xd0eba0bbu, 0x1c41a025u, 0x92cea7c6u, 0x5e64a758u, 0x54a1ae41u, 0x980baedfu,
+                0x1684a93cu, 0xda2ea9a2u, 0x030ebb0eu, 0xcfa4bb90u, 0x412bbc73u, 0x8d81bcedu,
+                0x8744b5f4u, 0x4beeb56au, 0xc561b289u, 0x09cbb217u, 0xac509190u, 0x60fa910eu,
+                0xee7596edu, 0x22df9673u, 0x281a9f6au, 0xe4b09ff4u, 0x6a3f9817u, 0xa6959889u,
+                0x7fb58a25u, 0xb31f8abbu, 0x3d908d58u, 0xf13a8dc6u, 0xfbff84dfu, 0x37558441u,
+                0xb9da83a2u, 0x7570833cu, 0x533b85dau, 0x9f918544u, 0x111e82a7u, 0xddb48239u,
+                0xd7718b20u, 0x1bdb8bbeu, 0x95548c5du, 0x59fe8cc3u, 0x80de9e6fu, 0x4c749ef1u,
+                0xc2fb9912u, 0x0e51998cu, 0x04949095u, 0xc83e900bu, 0x46b197e8u, 0x8a1b9776u,
+                0x2f80b4f1u, 0xe32ab46fu, 0x6da5b38cu, 0xa10fb312u, 0xabcaba0bu, 0x6760ba95u,
+                0xe9efbd76u, 0x2545bde8u, 0xfc65af44u, 0x30cfafdau, 0xbe40a839u, 0x72eaa8a7u,
+                0x782fa1beu, 0xb485a120u, 0x3a0aa6c3u, 0xf6a0a65du, 0xaa4de78cu, 0x66e7e712u,
+                0xe868e0f1u, 0x24c2e06fu, 0x2e07e976u, 0xe2ade9e8u, 0x6c22ee0bu, 0xa088ee95u,
+                0x79a8fc39u, 0xb502fca7u, 0x3b8dfb44u, 0xf727fbdau, 0xfde2f2c3u, 0x3148f25du,
+                0xbfc7f5beu, 0x736df520u, 0xd6f6d6a7u, 0x1a5cd639u, 0x94d3d1dau, 0x5879d144u,
+                0x52bcd85du, 0x9e16d8c3u, 0x1099df20u, 0xdc33dfbeu, 0x0513cd12u, 0xc9b9cd8cu,
+                0x4736ca6fu, 0x8b9ccaf1u, 0x8159c3e8u, 0x4df3c376u, 0xc37cc495u, 0x0fd6c40bu,
+                0x7aa64737u, 0xb60c47a9u, 0x3883404au, 0xf42940d4u, 0xfeec49cdu, 0x32464953u,
+                0xbcc94eb0u, 0x70634e2eu, 0xa9435c82u, 0x65e95c1cu, 0xeb665bffu, 0x27cc5b61u,
+                0x2d095278u, 0xe1a352e6u, 0x6f2c5505u, 0xa386559bu, 0x061d761cu, 0xcab77682u,
+                0x44387161u, 0x889271ffu, 0x825778e6u, 0x4efd7878u, 0xc0727f9bu, 0x0cd87f05u,
+                0xd5f86da9u, 0x19526d37u, 0x97dd6ad4u, 0x5b776a4au, 0x51b26353u, 0x9d1863cdu,
+                0x1397642eu, 0xdf3d64b0u, 0x83d02561u, 0x4f7a25ffu, 0xc1f5221cu, 0x0d5f2282u,
+                0x079a2b9bu, 0xcb302b05u, 0x45bf2ce6u, 0x89152c78u, 0x50353ed4u, 0x9c9f3e4au,
+                0x121039a9u, 0xdeba3937u, 0xd47f302eu, 0x18d530b0u, 0x965a3753u, 0x5af037cdu,
+                0xff6b144au, 0x33c114d4u, 0xbd4e1337u, 0x71e413a9u, 0x7b211ab0u, 0xb78b1a2eu,
+                0x39041dcdu, 0xf5ae1d53u, 0x2c8e0fffu, 0xe0240f61u, 0x6eab0882u, 0xa201081cu,
+                0xa8c40105u, 0x646e019bu, 0xeae10678u, 0x264b06e6u
+        },
+        {
+                0x00000000u, 0x177b1443u, 0x2ef62886u, 0x398d3cc5u, 0x5dec510cu, 0x4a97454fu,
+                0x731a798au, 0x64616dc9u, 0xbbd8a218u, 0xaca3b65bu, 0x952e8a9eu, 0x82559eddu,
+                0xe634f314u, 0xf14fe757u, 0xc8c2db92u, 0xdfb9cfd1u, 0xacc04271u, 0xbbbb5632u,
+                0x82366af7u, 0x954d7eb4u, 0xf12c137du, 0xe657073eu, 0xdfda3bfbu, 0xc8a12fb8u,
+                0x1718e069u, 0x0063f42au, 0x39eec8efu, 0x2e95dcacu, 0x4af4b165u, 0x5d8fa526u,
+                0x640299e3u, 0x73798da0u, 0x82f182a3u, 0x958a96e0u, 0xac07aa25u, 0xbb7cbe66u,
+                0xdf1dd3afu, 0xc866c7ecu, 0xf1ebfb29u, 0xe690ef6au, 0x392920bbu, 0x2e5234f8u,
+                0x17df083du, 0x00a41c7eu, 0x64c571b7u, 0x73be65f4u, 0x4a335931u, 0x5d484d72u,
+                0x2e31c0d2u, 0x394ad491u, 0x00c7e854u, 0x17bcfc17u, 0x73dd91deu, 0x64a6859du,
+                0x5d2bb958u, 0x4a50ad1bu, 0x95e962cau, 0x82927689u, 0xbb1f4a4cu, 0xac645e0fu,
+                0xc80533c6u, 0xdf7e2785u, 0xe6f31b40u, 0xf1880f03u, 0xde920307u, 0xc9e91744u,
+                0xf0642b81u, 0xe71f3fc2u, 0x837e520bu, 0x94054648u, 0xad887a8du, 0xbaf36eceu,
+                0x654aa11fu, 0x7231b55cu, 0x4bbc8999u, 0x5cc79ddau, 0x38a6f013u, 0x2fdde450u,
+                0x1650d895u, 0x012bccd6u, 0x72524176u, 0x65295535u, 0x5ca469f0u, 0x4bdf7db3u,
+                0x2fbe107au, 0x38c50439u, 0x014838fcu, 0x16332cbfu, 0xc98ae36eu, 0xdef1f72du,
+                0xe77ccbe8u, 0xf007dfabu, 0x9466b262u, 0x831da621u, 0xba909ae4u, 0xadeb8ea7u,
+                0x5c6381a4u, 0x4b1895e7u, 0x7295a922u, 0x65eebd61u, 0x018fd0a8u, 0x16f4c4ebu,
+                0x2f79f82eu, 0x3802ec6du, 0xe7bb23bcu, 0xf0c037ffu, 0xc94d0b3au, 0xde361f79u,
+                0xba5772b0u, 0xad2c66f3u, 0x94a15a36u, 0x83da4e75u, 0xf0a3c3d5u, 0xe7d8d796u,
+                0xde55eb53u, 0xc92eff10u, 0xad4f92d9u, 0xba34869au, 0x83b9ba5fu, 0x94c2ae1cu,
+                0x4b7b61cdu, 0x5c00758eu, 0x658d494bu, 0x72f65d08u, 0x169730c1u, 0x01ec2482u,
+                0x38611847u, 0x2f1a0c04u, 0x6655004fu, 0x712e140cu, 0x48a328c9u, 0x5fd83c8au,
+                0x3bb95143u, 0x2cc24500u, 0x154f79c5u, 0x02346d86u, 0xdd8da257u, 0xcaf6b614u,
+                0xf37b8ad1u, 0xe4009e92u, 0x8061f35bu, 0x971ae718u, 0xae97dbddu, 0xb9eccf9eu,
+                0xca95423eu, 0xddee567du, 0xe4636ab8u, 0xf3187efbu, 0x97791332u, 0x80020771u,
+                0xb98f3bb4u, 0xaef42ff7u, 0x714de026u, 0x6636f465u, 0x5fbbc8a0u, 0x48c0dce3u,
+                0x2ca1b12au, 0x3bdaa569u, 0x025799acu, 0x152c8defu, 0xe4a482ecu, 0xf3df96afu,
+                0xca52aa6au, 0xdd29be29u, 0xb948d3e0u, 0xae33c7a3u, 0x97befb66u, 0x80c5ef25u,
+                0x5f7c20f4u, 0x480734b7u, 0x718a0872u, 0x66f11c31u, 0x029071f8u, 0x15eb65bbu,
+                0x2c66597eu, 0x3b1d4d3du, 0x4864c09du, 0x5f1fd4deu, 0x6692e81bu, 0x71e9fc58u,
+                0x15889191u, 0x02f385d2u, 0x3b7eb917u, 0x2c05ad54u, 0xf3bc6285u, 0xe4c776c6u,
+                0xdd4a4a03u, 0xca315e40u, 0xae503389u, 0xb92b27cau, 0x80a61b0fu, 0x97dd0f4cu,
+                0xb8c70348u, 0xafbc170bu, 0x96312bceu, 0x814a3f8du, 0xe52b5244u, 0xf2504607u,
+                0xcbdd7ac2u, 0xdca66e81u, 0x031fa150u, 0x1464b513u, 0x2de989d6u, 0x3a929d95u,
+                0x5ef3f05cu, 0x4988e41fu, 0x7005d8dau, 0x677ecc99u, 0x14074139u, 0x037c557au,
+                0x3af169bfu, 0x2d8a7dfcu, 0x49eb1035u, 0x5e900476u, 0x671d38b3u, 0x70662cf0u,
+                0xafdfe321u, 0xb8a4f762u, 0x8129cba7u, 0x9652dfe4u, 0xf233b22du, 0xe548a66eu,
+                0xdcc59aabu, 0xcbbe8ee8u, 0x3a3681ebu, 0x2d4d95a8u, 0x14c0a96du, 0x03bbbd2eu,
+                0x67dad0e7u, 0x70a1c4a4u, 0x492cf861u, 0x5e57ec22u, 0x81ee23f3u, 0x969537b0u,
+                0xaf180b75u, 0xb8631f36u, 0xdc0272ffu, 0xcb7966bcu, 0xf2f45a79u, 0xe58f4e3au,
+                0x96f6c39au, 0x818dd7d9u, 0xb800eb1cu, 0xaf7bff5fu, 0xcb1a9296u, 0xdc6186d5u,
+                0xe5ecba10u, 0xf297ae53u, 0x2d2e6182u, 0x3a5575c1u, 0x03d84904u, 0x14a35d47u,
+                0x70c2308eu, 0x67b924cdu, 0x5e341808u, 0x494f0c4bu
+        },
+        {
+                0x00000000u, 0xefc26b3eu, 0x04f5d03du, 0xeb37bb03u, 0x09eba07au, 0xe629cb44u,
+                0x0d1e7047u, 0xe2dc1b79u, 0x13d740f4u, 0xfc152bcau, 0x172290c9u, 0xf8e0fbf7u,
+                0x1a3ce08eu, 0xf5fe8bb0u, 0x1ec930b3u, 0xf10b5b8du, 0x27ae81e8u, 0xc86cead6u,
+                0x235b51d5u, 0xcc993aebu, 0x2e452192u, 0xc1874aacu, 0x2ab0f1afu, 0xc5729a91u,
+                0x3479c11cu, 0xdbbbaa22u, 0x308c1121u, 0xdf4e7a1fu, 0x3d926166u, 0xd2500a58u,
+                0x3967b15bu, 0xd6a5da65u, 0x4f5d03d0u, 0xa09f68eeu, 0x4ba8d3edu, 0xa46ab8d3u,
+                0x46b6a3aau, 0xa974c894u, 0x42437397u, 0xad8118a9u, 0x5c8a4324u, 0xb348281au,
+                0x587f9319u, 0xb7bdf827u, 0x5561e35eu, 0xbaa38860u, 0x51943363u, 0xbe56585du,
+                0x68f38238u, 0x8731e906u, 0x6c065205u, 0x83c4393bu, 0x61182242u, 0x8eda497cu,
+                0x65edf27fu, 0x8a2f9941u, 0x7b24c2ccu, 0x94e6a9f2u, 0x7fd112f1u, 0x901379cfu,
+                0x72cf62b6u, 0x9d0d0988u, 0x763ab28bu, 0x99f8d9b5u, 0x9eba07a0u, 0x71786c9eu,
+                0x9a4fd79du, 0x758dbca3u, 0x9751a7dau, 0x7893cce4u, 0x93a477e7u, 0x7c661cd9u,
+                0x8d6d4754u, 0x62af2c6au, 0x89989769u, 0x665afc57u, 0x8486e72eu, 0x6b448c10u,
+                0x80733713u, 0x6fb15c2du, 0xb9148648u, 0x56d6ed76u, 0xbde15675u, 0x52233d4bu,
+                0xb0ff2632u, 0x5f3d4d0cu, 0xb40af60fu, 0x5bc89d31u, 0xaac3c6bcu, 0x4501ad82u,
+                0xae361681u, 0x41f47dbfu, 0xa32866c6u, 0x4cea0df8u, 0xa7ddb6fbu, 0x481fddc5u,
+                0xd1e70470u, 0x3e256f4eu, 0xd512d44du, 0x3ad0bf73u, 0xd80ca40au, 0x37cecf34u,
+                0xdcf97437u, 0x333b1f09u, 0xc2304484u, 0x2df22fbau, 0xc6c594b9u, 0x2907ff87u,
+                0xcbdbe4feu, 0x24198fc0u, 0xcf2e34c3u, 0x20ec5ffdu, 0xf6498598u, 0x198beea6u,
+                0xf2bc55a5u, 0x1d7e3e9bu, 0xffa225e2u, 0x10604edcu, 0xfb57f5dfu, 0x14959ee1u,
+                0xe59ec56cu, 0x0a5cae52u, 0xe16b1551u, 0x0ea97e6fu, 0xec756516u, 0x03b70e28u,
+                0xe880b52bu, 0x0742de15u, 0xe6050901u, 0x09c7623fu, 0xe2f0d93cu, 0x0d32b202u,
+                0xefeea97bu, 0x002cc245u, 0xeb1b7946u, 0x04d91278u, 0xf5d249f5u, 0x1a1022cbu,
+                0xf12799c8u, 0x1ee5f2f6u, 0xfc39e98fu, 0x13fb82b1u, 0xf8cc39b2u, 0x170e528cu,
+                0xc1ab88e9u, 0x2e69e3d7u, 0xc55e58d4u, 0x2a9c33eau, 0xc8402893u, 0x278243adu,
+                0xccb5f8aeu, 0x23779390u, 0xd27cc81du, 0x3dbea323u, 0xd6891820u, 0x394b731eu,
+                0xdb976867u, 0x34550359u, 0xdf62b85au, 0x30a0d364u, 0xa9580ad1u, 0x469a61efu,
+                0xadaddaecu, 0x426fb1d2u, 0xa0b3aaabu, 0x4f71c195u, 0xa4467a96u, 0x4b8411a8u,
+                0xba8f4a25u, 0x554d211bu, 0xbe7a9a18u, 0x51b8f126u, 0xb364ea5fu, 0x5ca68161u,
+                0xb7913a62u, 0x5853515cu, 0x8ef68b39u, 0x6134e007u, 0x8a035b04u, 0x65c1303au,
+                0x871d2b43u, 0x68df407du, 0x83e8fb7eu, 0x6c2a9040u, 0x9d21cbcdu, 0x72e3a0f3u,
+                0x99d41bf0u, 0x761670ceu, 0x94ca6bb7u, 0x7b080089u, 0x903fbb8au, 0x7ffdd0b4u,
+                0x78bf0ea1u, 0x977d659fu, 0x7c4ade9cu, 0x9388b5a2u, 0x7154aedbu, 0x9e96c5e5u,
+                0x75a17ee6u, 0x9a6315d8u, 0x6b684e55u, 0x84aa256bu, 0x6f9d9e68u, 0x805ff556u,
+                0x6283ee2fu, 0x8d418511u, 0x66763e12u, 0x89b4552cu, 0x5f118f49u, 0xb0d3e477u,
+                0x5be45f74u, 0xb426344au, 0x56fa2f33u, 0xb938440du, 0x520fff0eu, 0xbdcd9430u,
+                0x4cc6cfbdu, 0xa304a483u, 0x48331f80u, 0xa7f174beu, 0x452d6fc7u, 0xaaef04f9u,
+                0x41d8bffau, 0xae1ad4c4u, 0x37e20d71u, 0xd820664fu, 0x3317dd4cu, 0xdcd5b672u,
+                0x3e09ad0bu, 0xd1cbc635u, 0x3afc7d36u, 0xd53e1608u, 0x24354d85u, 0xcbf726bbu,
+                0x20c09db8u, 0xcf02f686u, 0x2ddeedffu, 0xc21c86c1u, 0x292b3dc2u, 0xc6e956fcu,
+                0x104c8c99u, 0xff8ee7a7u, 0x14b95ca4u, 0xfb7b379au, 0x19a72ce3u, 0xf66547ddu,
+                0x1d52fcdeu, 0xf29097e0u, 0x039bcc6du, 0xec59a753u, 0x076e1c50u, 0xe8ac776eu,
+                0x0a706c17u, 0xe5b20729u, 0x0e85bc2au, 0xe147d714u
+        },
+        {
+                0x00000000u, 0xc18edfc0u, 0x586cb9c1u, 0x99e26601u, 0xb0d97382u, 0x7157ac42u,
+                0xe8b5ca43u, 0x293b1583u, 0xbac3e145u, 0x7b4d3e85u, 0xe2af5884u, 0x23218744u,
+                0x0a1a92c7u, 0xcb944d07u, 0x52762b06u, 0x93f8f4c6u, 0xaef6c4cbu, 0x6f781b0bu,
+                0xf69a7d0au, 0x3714a2cau, 0x1e2fb749u, 0xdfa16889u, 0x46430e88u, 0x87cdd148u,
+                0x1435258eu, 0xd5bbfa4eu, 0x4c599c4fu, 0x8dd7438fu, 0xa4ec560cu, 0x656289ccu,
+                0xfc80efcdu, 0x3d0e300du, 0x869c8fd7u, 0x47125017u, 0xdef03616u, 0x1f7ee9d6u,
+                0x3645fc55u, 0xf7cb2395u, 0x6e294594u, 0xafa79a54u, 0x3c5f6e92u, 0xfdd1b152u,
+                0x6433d753u, 0xa5bd0893u, 0x8c861d10u, 0x4d08c2d0u, 0xd4eaa4d1u, 0x15647b11u,
+                0x286a4b1cu, 0xe9e494dcu, 0x7006f2ddu, 0xb1882d1du, 0x98b3389eu, 0x593de75eu,
+                0xc0df815fu, 0x01515e9fu, 0x92a9aa59u, 0x53277599u, 0xcac51398u, 0x0b4bcc58u,
+                0x2270d9dbu, 0xe3fe061bu, 0x7a1c601au, 0xbb92bfdau, 0xd64819efu, 0x17c6c62fu,
+                0x8e24a02eu, 0x4faa7feeu, 0x66916a6du, 0xa71fb5adu, 0x3efdd3acu, 0xff730c6cu,
+                0x6c8bf8aau, 0xad05276au, 0x34e7416bu, 0xf5699eabu, 0xdc528b28u, 0x1ddc54e8u,
+                0x843e32e9u, 0x45b0ed29u, 0x78bedd24u, 0xb93002e4u, 0x20d264e5u, 0xe15cbb25u,
+                0xc867aea6u, 0x09e97166u, 0x900b1767u, 0x5185c8a7u, 0xc27d3c61u, 0x03f3e3a1u,
+                0x9a1185a0u, 0x5b9f5a60u, 0x72a44fe3u, 0xb32a9023u, 0x2ac8f622u, 0xeb4629e2u,
+                0x50d49638u, 0x915a49f8u, 0x08b82ff9u, 0xc936f039u, 0xe00de5bau, 0x21833a7au,
+                0xb8615c7bu, 0x79ef83bbu, 0xea17777du, 0x2b99a8bdu, 0xb27bcebcu, 0x73f5117cu,
+                0x5ace04ffu, 0x9b40db3fu, 0x02a2bd3eu, 0xc32c62feu, 0xfe2252f3u, 0x3fac8d33u,
+                0xa64eeb32u, 0x67c034f2u, 0x4efb2171u, 0x8f75feb1u, 0x169798b0u, 0xd7194770u,
+                0x44e1b3b6u, 0x856f6c76u, 0x1c8d0a77u, 0xdd03d5b7u, 0xf438c034u, 0x35b61ff4u,
+                0xac5479f5u, 0x6ddaa635u, 0x77e1359fu, 0xb66fea5fu, 0x2f8d8c5eu, 0xee03539eu,
+                0xc738461du, 0x06b699ddu, 0x9f54ffdcu, 0x5eda201cu, 0xcd22d4dau, 0x0cac0b1au,
+                0x954e6d1bu, 0x54c0b2dbu, 0x7dfba758u, 0xbc757898u, 0x25971e99u, 0xe419c159u,
+                0xd917f154u, 0x18992e94u, 0x817b4895u, 0x40f59755u, 0x69ce82d6u, 0xa8405d16u,
+                0x31a23b17u, 0xf02ce4d7u, 0x63d41011u, 0xa25acfd1u, 0x3bb8a9d0u, 0xfa367610u,
+                0xd30d6393u, 0x1283bc53u, 0x8b61da52u, 0x4aef0592u, 0xf17dba48u, 0x30f36588u,
+                0xa9110389u, 0x689fdc49u, 0x41a4c9cau, 0x802a160au, 0x19c8700bu, 0xd846afcbu,
+                0x4bbe5b0du, 0x8a3084cdu, 0x13d2e2ccu, 0xd25c3d0cu, 0xfb67288fu, 0x3ae9f74fu,
+                0xa30b914eu, 0x62854e8eu, 0x5f8b7e83u, 0x9e05a143u, 0x07e7c742u, 0xc6691882u,
+                0xef520d01u, 0x2edcd2c1u, 0xb73eb4c0u, 0x76b06b00u, 0xe5489fc6u, 0x24c64006u,
+                0xbd242607u, 0x7caaf9c7u, 0x5591ec44u, 0x941f3384u, 0x0dfd5585u, 0xcc738a45u,
+                0xa1a92c70u, 0x6027f3b0u, 0xf9c595b1u, 0x384b4a71u, 0x11705ff2u, 0xd0fe8032u,
+                0x491ce633u, 0x889239f3u, 0x1b6acd35u, 0xdae412f5u, 0x430674f4u, 0x8288ab34u,
+                0xabb3beb7u, 0x6a3d6177u, 0xf3df0776u, 0x3251d8b6u, 0x0f5fe8bbu, 0xced1377bu,
+                0x5733517au, 0x96bd8ebau, 0xbf869b39u, 0x7e0844f9u, 0xe7ea22f8u, 0x2664fd38u,
+                0xb59c09feu, 0x7412d63eu, 0xedf0b03fu, 0x2c7e6fffu, 0x05457a7cu, 0xc4cba5bcu,
+                0x5d29c3bdu, 0x9ca71c7du, 0x2735a3a7u, 0xe6bb7c67u, 0x7f591a66u, 0xbed7c5a6u,
+                0x97ecd025u, 0x56620fe5u, 0xcf8069e4u, 0x0e0eb624u, 0x9df642e2u, 0x5c789d22u,
+                0xc59afb23u, 0x041424e3u, 0x2d2f3160u, 0xeca1eea0u, 0x754388a1u, 0xb4cd5761u,
+                0x89c3676cu, 0x484db8acu, 0xd1afdeadu, 0x1021016du, 0x391a14eeu, 0xf894cb2eu,
+                0x6176ad2fu, 0xa0f872efu, 0x33008629u, 0xf28e59e9u, 0x6b6c3fe8u, 0xaae2e028u,
+                0x83d9f5abu, 0x42572a6bu, 0xdbb54c6au, 0x1a3b93aau
+        },
+        {
+                0x00000000u, 0x9ba54c6fu, 0xec3b9e9fu, 0x779ed2f0u, 0x03063b7fu, 0x98a37710u,
+                0xef3da5e0u, 0x7498e98fu, 0x060c76feu, 0x9da93a91u, 0xea37e861u, 0x7192a40eu,
+                0x050a4d81u, 0x9eaf01eeu, 0xe931d31eu, 0x72949f71u, 0x0c18edfcu, 0x97bda193u,
+                0xe0237363u, 0x7b863f0cu, 0x0f1ed683u, 0x94bb9aecu, 0xe325481cu, 0x78800473u,
+                0x0a149b02u, 0x91b1d76du, 0xe62f059du, 0x7d8a49f2u, 0x0912a07du, 0x92b7ec12u,
+                0xe5293ee2u, 0x7e8c728du, 0x1831dbf8u, 0x83949797u, 0xf40a4567u, 0x6faf0908u,
+                0x1b37e087u, 0x8092ace8u, 0xf70c7e18u, 0x6ca93277u, 0x1e3dad06u, 0x8598e169u,
+                0xf2063399u, 0x69a37ff6u, 0x1d3b9679u, 0x869eda16u, 0xf10008e6u, 0x6aa54489u,
+                0x14293604u, 0x8f8c7a6bu, 0xf812a89bu, 0x63b7e4f4u, 0x172f0d7bu, 0x8c8a4114u,
+                0xfb1493e4u, 0x60b1df8bu, 0x122540fau, 0x89800c95u, 0xfe1ede65u, 0x65bb920au,
+                0x11237b85u, 0x8a8637eau, 0xfd18e51au, 0x66bda975u, 0x3063b7f0u, 0xabc6fb9fu,
+                0xdc58296fu, 0x47fd6500u, 0x33658c8fu, 0xa8c0c0e0u, 0xdf5e1210u, 0x44fb5e7fu,
+                0x366fc10eu, 0xadca8d61u, 0xda545f91u, 0x41f113feu, 0x3569fa71u, 0xaeccb61eu,
+                0xd95264eeu, 0x42f72881u, 0x3c7b5a0cu, 0xa7de1663u, 0xd040c493u, 0x4be588fcu,
+                0x3f7d6173u, 0xa4d82d1cu, 0xd346ffecu, 0x48e3b383u, 0x3a772cf2u, 0xa1d2609du,
+                0xd64cb26du, 0x4de9fe02u, 0x3971178du, 0xa2d45be2u, 0xd54a8912u, 0x4eefc57du,
+                0x28526c08u, 0xb3f72067u, 0xc469f297u, 0x5fccbef8u, 0x2b545777u, 0xb0f11b18u,
+                0xc76fc9e8u, 0x5cca8587u, 0x2e5e1af6u, 0xb5fb5699u, 0xc2658469u, 0x59c0c806u,
+                0x2d582189u, 0xb6fd6de6u, 0xc163bf16u, 0x5ac6f379u, 0x244a81f4u, 0xbfefcd9bu,
+                0xc8711f6bu, 0x53d45304u, 0x274cba8bu, 0xbce9f6e4u, 0xcb772414u, 0x50d2687bu,
+                0x2246f70au, 0xb9e3bb65u, 0xce7d6995u, 0x55d825fau, 0x2140cc75u, 0xbae5801au,
+                0xcd7b52eau, 0x56de1e85u, 0x60c76fe0u, 0xfb62238fu, 0x8cfcf17fu, 0x1759bd10u,
+                0x63c1549fu, 0xf86418f0u, 0x8ffaca00u, 0x145f866fu, 0x66cb191eu, 0xfd6e5571u,
+                0x8af08781u, 0x1155cbeeu, 0x65cd2261u, 0xfe686e0eu, 0x89f6bcfeu, 0x1253f091u,
+                0x6cdf821cu, 0xf77ace73u, 0x80e41c83u, 0x1b4150ecu, 0x6fd9b963u, 0xf47cf50cu,
+                0x83e227fcu, 0x18476b93u, 0x6ad3f4e2u, 0xf176b88du, 0x86e86a7du, 0x1d4d2612u,
+                0x69d5cf9du, 0xf27083f2u, 0x85ee5102u, 0x1e4b1d6du, 0x78f6b418u, 0xe353f877u,
+                0x94cd2a87u, 0x0f6866e8u, 0x7bf08f67u, 0xe055c308u, 0x97cb11f8u, 0x0c6e5d97u,
+                0x7efac2e6u, 0xe55f8e89u, 0x92c15c79u, 0x09641016u, 0x7dfcf999u, 0xe659b5f6u,
+                0x91c76706u, 0x0a622b69u, 0x74ee59e4u, 0xef4b158bu, 0x98d5c77bu, 0x03708b14u,
+                0x77e8629bu, 0xec4d2ef4u, 0x9bd3fc04u, 0x0076b06bu, 0x72e22f1au, 0xe9476375u,
+                0x9ed9b185u, 0x057cfdeau, 0x71e41465u, 0xea41580au, 0x9ddf8afau, 0x067ac695u,
+                0x50a4d810u, 0xcb01947fu, 0xbc9f468fu, 0x273a0ae0u, 0x53a2e36fu, 0xc807af00u,
+                0xbf997df0u, 0x243c319fu, 0x56a8aeeeu, 0xcd0de281u, 0xba933071u, 0x21367c1eu,
+                0x55ae9591u, 0xce0bd9feu, 0xb9950b0eu, 0x22304761u, 0x5cbc35ecu, 0xc7197983u,
+                0xb087ab73u, 0x2b22e71cu, 0x5fba0e93u, 0xc41f42fcu, 0xb381900cu, 0x2824dc63u,
+                0x5ab04312u, 0xc1150f7du, 0xb68bdd8du, 0x2d2e91e2u, 0x59b6786du, 0xc2133402u,
+                0xb58de6f2u, 0x2e28aa9du, 0x489503e8u, 0xd3304f87u, 0xa4ae9d77u, 0x3f0bd118u,
+                0x4b933897u, 0xd03674f8u, 0xa7a8a608u, 0x3c0dea67u, 0x4e997516u, 0xd53c3979u,
+                0xa2a2eb89u, 0x3907a7e6u, 0x4d9f4e69u, 0xd63a0206u, 0xa1a4d0f6u, 0x3a019c99u,
+                0x448dee14u, 0xdf28a27bu, 0xa8b6708bu, 0x33133ce4u, 0x478bd56bu, 0xdc2e9904u,
+                0xabb04bf4u, 0x3015079bu, 0x428198eau, 0xd924d485u, 0xaeba0675u, 0x351f4a1au,
+                0x4187a395u, 0xda22effau, 0xadbc3d0au, 0x36197165u
+        },
+        {
+                0x00000000u, 0xdd96d985u, 0x605cb54bu, 0xbdca6cceu, 0xc0b96a96u, 0x1d2fb313u,
+                0xa0e5dfddu, 0x7d730658u, 0x5a03d36du, 0x87950ae8u, 0x3a5f6626u, 0xe7c9bfa3u,
+                0x9abab9fbu, 0x472c607eu, 0xfae60cb0u, 0x2770d535u, 0xb407a6dau, 0x69917f5fu,
+                0xd45b1391u, 0x09cdca14u, 0x74becc4cu, 0xa92815c9u, 0x14e27907u, 0xc974a082u,
+                0xee0475b7u, 0x3392ac32u, 0x8e58c0fcu, 0x53ce1979u, 0x2ebd1f21u, 0xf32bc6a4u,
+                0x4ee1aa6au, 0x937773efu, 0xb37e4bf5u, 0x6ee89270u, 0xd322febeu, 0x0eb4273bu,
+                0x73c72163u, 0xae51f8e6u, 0x139b9428u, 0xce0d4dadu, 0xe97d9898u, 0x34eb411du,
+                0x89212dd3u, 0x54b7f456u, 0x29c4f20eu, 0xf4522b8bu, 0x49984745u, 0x940e9ec0u,
+                0x0779ed2fu, 0xdaef34aau, 0x67255864u, 0xbab381e1u, 0xc7c087b9u, 0x1a565e3cu,
+                0xa79c32f2u, 0x7a0aeb77u, 0x5d7a3e42u, 0x80ece7c7u, 0x3d268b09u, 0xe0b0528cu,
+                0x9dc354d4u, 0x40558d51u, 0xfd9fe19fu, 0x2009381au, 0xbd8d91abu, 0x601b482eu,
+                0xddd124e0u, 0x0047fd65u, 0x7d34fb3du, 0xa0a222b8u, 0x1d684e76u, 0xc0fe97f3u,
+                0xe78e42c6u, 0x3a189b43u, 0x87d2f78du, 0x5a442e08u, 0x27372850u, 0xfaa1f1d5u,
+                0x476b9d1bu, 0x9afd449eu, 0x098a3771u, 0xd41ceef4u, 0x69d6823au, 0xb4405bbfu,
+                0xc9335de7u, 0x14a58462u, 0xa96fe8acu, 0x74f93129u, 0x5389e41cu, 0x8e1f3d99u,
+                0x33d55157u, 0xee4388d2u, 0x93308e8au, 0x4ea6570fu, 0xf36c3bc1u, 0x2efae244u,
+                0x0ef3da5eu, 0xd36503dbu, 0x6eaf6f15u, 0xb339b690u, 0xce4ab0c8u, 0x13dc694du,
+                0xae160583u, 0x7380dc06u, 0x54f00933u, 0x8966d0b6u, 0x34acbc78u, 0xe93a65fdu,
+                0x944963a5u, 0x49dfba20u, 0xf415d6eeu, 0x29830f6bu, 0xbaf47c84u, 0x6762a501u,
+                0xdaa8c9cfu, 0x073e104au, 0x7a4d1612u, 0xa7dbcf97u, 0x1a11a359u, 0xc7877adcu,
+                0xe0f7afe9u, 0x3d61766cu, 0x80ab1aa2u, 0x5d3dc327u, 0x204ec57fu, 0xfdd81cfau,
+                0x40127034u, 0x9d84a9b1u, 0xa06a2517u, 0x7dfcfc92u, 0xc036905cu, 0x1da049d9u,
+                0x60d34f81u, 0xbd459604u, 0x008ffacau, 0xdd19234fu, 0xfa69f67au, 0x27ff2fffu,
+                0x9a354331u, 0x47a39ab4u, 0x3ad09cecu, 0xe7464569u, 0x5a8c29a7u, 0x871af022u,
+                0x146d83cdu, 0xc9fb5a48u, 0x74313686u, 0xa9a7ef03u, 0xd4d4e95bu, 0x094230deu,
+                0xb4885c10u, 0x691e8595u, 0x4e6e50a0u, 0x93f88925u, 0x2e32e5ebu, 0xf3a43c6eu,
+                0x8ed73a36u, 0x5341e3b3u, 0xee8b8f7du, 0x331d56f8u, 0x13146ee2u, 0xce82b767u,
+                0x7348dba9u, 0xaede022cu, 0xd3ad0474u, 0x0e3bddf1u, 0xb3f1b13fu, 0x6e6768bau,
+                0x4917bd8fu, 0x9481640au, 0x294b08c4u, 0xf4ddd141u, 0x89aed719u, 0x54380e9cu,
+                0xe9f26252u, 0x3464bbd7u, 0xa713c838u, 0x7a8511bdu, 0xc74f7d73u, 0x1ad9a4f6u,
+                0x67aaa2aeu, 0xba3c7b2bu, 0x07f617e5u, 0xda60ce60u, 0xfd101b55u, 0x2086c2d0u,
+                0x9d4cae1eu, 0x40da779bu, 0x3da971c3u, 0xe03fa846u, 0x5df5c488u, 0x80631d0du,
+                0x1de7b4bcu, 0xc0716d39u, 0x7dbb01f7u, 0xa02dd872u, 0xdd5ede2au, 0x00c807afu,
+                0xbd026b61u, 0x6094b2e4u, 0x47e467d1u, 0x9a72be54u, 0x27b8d29au, 0xfa2e0b1fu,
+                0x875d0d47u, 0x5acbd4c2u, 0xe701b80cu, 0x3a976189u, 0xa9e01266u, 0x7476cbe3u,
+                0xc9bca72du, 0x142a7ea8u, 0x695978f0u, 0xb4cfa175u, 0x0905cdbbu, 0xd493143eu,
+                0xf3e3c10bu, 0x2e75188eu, 0x93bf7440u, 0x4e29adc5u, 0x335aab9du, 0xeecc7218u,
+                0x53061ed6u, 0x8e90c753u, 0xae99ff49u, 0x730f26ccu, 0xcec54a02u, 0x13539387u,
+                0x6e2095dfu, 0xb3b64c5au, 0x0e7c2094u, 0xd3eaf911u, 0xf49a2c24u, 0x290cf5a1u,
+                0x94c6996fu, 0x495040eau, 0x342346b2u, 0xe9b59f37u, 0x547ff3f9u, 0x89e92a7cu,
+                0x1a9e5993u, 0xc7088016u, 0x7ac2ecd8u, 0xa754355du, 0xda273305u, 0x07b1ea80u,
+                0xba7b864eu, 0x67ed5fcbu, 0x409d8afeu, 0x9d0b537bu, 0x20c13fb5u, 0xfd57e630u,
+                0x8024e068u, 0x5db239edu, 0xe0785523u, 0x3dee8ca6u
+        },
+        {
+                0x00000000u, 0x9d0fe176u, 0xe16ec4adu, 0x7c6125dbu, 0x19ac8f1bu, 0x84a36e6du,
+                0xf8c24bb6u, 0x65cdaac0u, 0x33591e36u, 0xae56ff40u, 0xd237da9bu, 0x4f383bedu,
+                0x2af5912du, 0xb7fa705bu, 0xcb9b5580u, 0x5694b4f6u, 0x66b23c6cu, 0xfbbddd1au,
+                0x87dcf8c1u, 0x1ad319b7u, 0x7f1eb377u, 0xe2115201u, 0x9e7077dau, 0x037f96acu,
+                0x55eb225au, 0xc8e4c32cu, 0xb485e6f7u, 0x298a0781u, 0x4c47ad41u, 0xd1484c37u,
+                0xad2969ecu, 0x3026889au, 0xcd6478d8u, 0x506b99aeu, 0x2c0abc75u, 0xb1055d03u,
+                0xd4c8f7c3u, 0x49c716b5u, 0x35a6336eu, 0xa8a9d218u, 0xfe3d66eeu, 0x63328798u,
+                0x1f53a243u, 0x825c4335u, 0xe791e9f5u, 0x7a9e0883u, 0x06ff2d58u, 0x9bf0cc2eu,
+                0xabd644b4u, 0x36d9a5c2u, 0x4ab88019u, 0xd7b7616fu, 0xb27acbafu, 0x2f752ad9u,
+                0x53140f02u, 0xce1bee74u, 0x988f5a82u, 0x0580bbf4u, 0x79e19e2fu, 0xe4ee7f59u,
+                0x8123d599u, 0x1c2c34efu, 0x604d1134u, 0xfd42f042u, 0x41b9f7f1u, 0xdcb61687u,
+                0xa0d7335cu, 0x3dd8d22au, 0x581578eau, 0xc51a999cu, 0xb97bbc47u, 0x24745d31u,
+                0x72e0e9c7u, 0xefef08b1u, 0x938e2d6au, 0x0e81cc1cu, 0x6b4c66dcu, 0xf64387aau,
+                0x8a22a271u, 0x172d4307u, 0x270bcb9du, 0xba042aebu, 0xc6650f30u, 0x5b6aee46u,
+                0x3ea74486u, 0xa3a8a5f0u, 0xdfc9802bu, 0x42c6615du, 0x1452d5abu, 0x895d34ddu,
+                0xf53c1106u, 0x6833f070u, 0x0dfe5ab0u, 0x90f1bbc6u, 0xec909e1du, 0x719f7f6bu,
+                0x8cdd8f29u, 0x11d26e5fu, 0x6db34b84u, 0xf0bcaaf2u, 0x95710032u, 0x087ee144u,
+                0x741fc49fu, 0xe91025e9u, 0xbf84911fu, 0x228b7069u, 0x5eea55b2u, 0xc3e5b4c4u,
+                0xa6281e04u, 0x3b27ff72u, 0x4746daa9u, 0xda493bdfu, 0xea6fb345u, 0x77605233u,
+                0x0b0177e8u, 0x960e969eu, 0xf3c33c5eu, 0x6eccdd28u, 0x12adf8f3u, 0x8fa21985u,
+                0xd936ad73u, 0x44394c05u, 0x385869deu, 0xa55788a8u, 0xc09a2268u, 0x5d95c31eu,
+                0x21f4e6c5u, 0xbcfb07b3u, 0x8373efe2u, 0x1e7c0e94u, 0x621d2b4fu, 0xff12ca39u,
+                0x9adf60f9u, 0x07d0818fu, 0x7bb1a454u, 0xe6be4522u, 0xb02af1d4u, 0x2d2510a2u,
+                0x51443579u, 0xcc4bd40fu, 0xa9867ecfu, 0x34899fb9u, 0x48e8ba62u, 0xd5e75b14u,
+                0xe5c1d38eu, 0x78ce32f8u, 0x04af1723u, 0x99a0f655u, 0xfc6d5c95u, 0x6162bde3u,
+                0x1d039838u, 0x800c794eu, 0xd698cdb8u, 0x4b972cceu, 0x37f60915u, 0xaaf9e863u,
+                0xcf3442a3u, 0x523ba3d5u, 0x2e5a860eu, 0xb3556778u, 0x4e17973au, 0xd318764cu,
+                0xaf795397u, 0x3276b2e1u, 0x57bb1821u, 0xcab4f957u, 0xb6d5dc8cu, 0x2bda3dfau,
+                0x7d4e890cu, 0xe041687au, 0x9c204da1u, 0x012facd7u, 0x64e20617u, 0xf9ede761u,
+                0x858cc2bau, 0x188323ccu, 0x28a5ab56u, 0xb5aa4a20u, 0xc9cb6ffbu, 0x54c48e8du,
+                0x3109244du, 0xac06c53bu, 0xd067e0e0u, 0x4d680196u, 0x1bfcb560u, 0x86f35416u,
+                0xfa9271cdu, 0x679d90bbu, 0x02503a7bu, 0x9f5fdb0du, 0xe33efed6u, 0x7e311fa0u,
+                0xc2ca1813u, 0x5fc5f965u, 0x23a4dcbeu, 0xbeab3dc8u, 0xdb669708u, 0x4669767eu,
+                0x3a0853a5u, 0xa707b2d3u, 0xf1930625u, 0x6c9ce753u, 0x10fdc288u, 0x8df223feu,
+                0xe83f893eu, 0x75306848u, 0x09514d93u, 0x945eace5u, 0xa478247fu, 0x3977c509u,
+                0x4516e0d2u, 0xd81901a4u, 0xbdd4ab64u, 0x20db4a12u, 0x5cba6fc9u, 0xc1b58ebfu,
+                0x97213a49u, 0x0a2edb3fu, 0x764ffee4u, 0xeb401f92u, 0x8e8db552u, 0x13825424u,
+                0x6fe371ffu, 0xf2ec9089u, 0x0fae60cbu, 0x92a181bdu, 0xeec0a466u, 0x73cf4510u,
+                0x1602efd0u, 0x8b0d0ea6u, 0xf76c2b7du, 0x6a63ca0bu, 0x3cf77efdu, 0xa1f89f8bu,
+                0xdd99ba50u, 0x40965b26u, 0x255bf1e6u, 0xb8541090u, 0xc435354bu, 0x593ad43du,
+                0x691c5ca7u, 0xf413bdd1u, 0x8872980au, 0x157d797cu, 0x70b0d3bcu, 0xedbf32cau,
+                0x91de1711u, 0x0cd1f667u, 0x5a454291u, 0xc74aa3e7u, 0xbb2b863cu, 0x2624674au,
+                0x43e9cd8au, 0xdee62cfcu, 0xa2870927u, 0x3f88e851u
+        },
+        {
+                0x00000000u, 0xb9fbdbe8u, 0xa886b191u, 0x117d6a79u, 0x8a7c6563u, 0x3387be8bu,
+                0x22fad4f2u, 0x9b010f1au, 0xcf89cc87u, 0x7672176fu, 0x670f7d16u, 0xdef4a6feu,
+                0x45f5a9e4u, 0xfc0e720cu, 0xed731875u, 0x5488c39du, 0x44629f4fu, 0xfd9944a7u,
+                0xece42edeu, 0x551ff536u, 0xce1efa2cu, 0x77e521c4u, 0x66984bbdu, 0xdf639055u,
+                0x8beb53c8u, 0x32108820u, 0x236de259u, 0x9a9639b1u, 0x019736abu, 0xb86ced43u,
+                0xa911873au, 0x10ea5cd2u, 0x88c53e9eu, 0x313ee576u, 0x20438f0fu, 0x99b854e7u,
+                0x02b95bfdu, 0xbb428015u, 0xaa3fea6cu, 0x13c43184u, 0x474cf219u, 0xfeb729f1u,
+                0xefca4388u, 0x56319860u, 0xcd30977au, 0x74cb4c92u, 0x65b626ebu, 0xdc4dfd03u,
+                0xcca7a1d1u, 0x755c7a39u, 0x64211040u, 0xdddacba8u, 0x46dbc4b2u, 0xff201f5au,
+                0xee5d7523u, 0x57a6aecbu, 0x032e6d56u, 0xbad5b6beu, 0xaba8dcc7u, 0x1253072fu,
+                0x89520835u, 0x30a9d3ddu, 0x21d4b9a4u, 0x982f624cu, 0xcafb7b7du, 0x7300a095u,
+                0x627dcaecu, 0xdb861104u, 0x40871e1eu, 0xf97cc5f6u, 0xe801af8fu, 0x51fa7467u,
+                0x0572b7fau, 0xbc896c12u, 0xadf4066bu, 0x140fdd83u, 0x8f0ed299u, 0x36f50971u,
+                0x27886308u, 0x9e73b8e0u, 0x8e99e432u, 0x37623fdau, 0x261f55a3u, 0x9fe48e4bu,
+                0x04e58151u, 0xbd1e5ab9u, 0xac6330c0u, 0x1598eb28u, 0x411028b5u, 0xf8ebf35du,
+                0xe9969924u, 0x506d42ccu, 0xcb6c4dd6u, 0x7297963eu, 0x63eafc47u, 0xda1127afu,
+                0x423e45e3u, 0xfbc59e0bu, 0xeab8f472u, 0x53432f9au, 0xc8422080u, 0x71b9fb68u,
+                0x60c49111u, 0xd93f4af9u, 0x8db78964u, 0x344c528cu, 0x253138f5u, 0x9ccae31du,
+                0x07cbec07u, 0xbe3037efu, 0xaf4d5d96u, 0x16b6867eu, 0x065cdaacu, 0xbfa70144u,
+                0xaeda6b3du, 0x1721b0d5u, 0x8c20bfcfu, 0x35db6427u, 0x24a60e5eu, 0x9d5dd5b6u,
+                0xc9d5162bu, 0x702ecdc3u, 0x6153a7bau, 0xd8a87c52u, 0x43a97348u, 0xfa52a8a0u,
+                0xeb2fc2d9u, 0x52d41931u, 0x4e87f0bbu, 0xf77c2b53u, 0xe601412au, 0x5ffa9ac2u,
+                0xc4fb95d8u, 0x7d004e30u, 0x6c7d2449u, 0xd586ffa1u, 0x810e3c3cu, 0x38f5e7d4u,
+                0x29888dadu, 0x90735645u, 0x0b72595fu, 0xb28982b7u, 0xa3f4e8ceu, 0x1a0f3326u,
+                0x0ae56ff4u, 0xb31eb41cu, 0xa263de65u, 0x1b98058du, 0x80990a97u, 0x3962d17fu,
+                0x281fbb06u, 0x91e460eeu, 0xc56ca373u, 0x7c97789bu, 0x6dea12e2u, 0xd411c90au,
+                0x4f10c610u, 0xf6eb1df8u, 0xe7967781u, 0x5e6dac69u, 0xc642ce25u, 0x7fb915cdu,
+                0x6ec47fb4u, 0xd73fa45cu, 0x4c3eab46u, 0xf5c570aeu, 0xe4b81ad7u, 0x5d43c13fu,
+                0x09cb02a2u, 0xb030d94au, 0xa14db333u, 0x18b668dbu, 0x83b767c1u, 0x3a4cbc29u,
+                0x2b31d650u, 0x92ca0db8u, 0x8220516au, 0x3bdb8a82u, 0x2aa6e0fbu, 0x935d3b13u,
+                0x085c3409u, 0xb1a7efe1u, 0xa0da8598u, 0x19215e70u, 0x4da99dedu, 0xf4524605u,
+                0xe52f2c7cu, 0x5cd4f794u, 0xc7d5f88eu, 0x7e2e2366u, 0x6f53491fu, 0xd6a892f7u,
+                0x847c8bc6u, 0x3d87502eu, 0x2cfa3a57u, 0x9501e1bfu, 0x0e00eea5u, 0xb7fb354du,
+                0xa6865f34u, 0x1f7d84dcu, 0x4bf54741u, 0xf20e9ca9u, 0xe373f6d0u, 0x5a882d38u,
+                0xc1892222u, 0x7872f9cau, 0x690f93b3u, 0xd0f4485bu, 0xc01e1489u, 0x79e5cf61u,
+                0x6898a518u, 0xd1637ef0u, 0x4a6271eau, 0xf399aa02u, 0xe2e4c07bu, 0x5b1f1b93u,
+                0x0f97d80eu, 0xb66c03e6u, 0xa711699fu, 0x1eeab277u, 0x85ebbd6du, 0x3c106685u,
+                0x2d6d0cfcu, 0x9496d714u, 0x0cb9b558u, 0xb5426eb0u, 0xa43f04c9u, 0x1dc4df21u,
+                0x86c5d03bu, 0x3f3e0bd3u, 0x2e4361aau, 0x97b8ba42u, 0xc33079dfu, 0x7acba237u,
+                0x6bb6c84eu, 0xd24d13a6u, 0x494c1cbcu, 0xf0b7c754u, 0xe1caad2du, 0x583176c5u,
+                0x48db2a17u, 0xf120f1ffu, 0xe05d9b86u, 0x59a6406eu, 0xc2a74f74u, 0x7b5c949cu,
+                0x6a21fee5u, 0xd3da250du, 0x8752e690u, 0x3ea93d78u, 0x2fd45701u, 0x962f8ce9u,
+                0x0d2e83f3u, 0xb4d5581bu, 0xa5a83262u, 0x1c53e98au
+        },
+        {
+                0x00000000u, 0xae689191u, 0x87a02563u, 0x29c8b4f2u, 0xd4314c87u, 0x7a59dd16u,
+                0x539169e4u, 0xfdf9f875u, 0x73139f4fu, 0xdd7b0edeu, 0xf4b3ba2cu, 0x5adb2bbdu,
+                0xa722d3c8u, 0x094a4259u, 0x2082f6abu, 0x8eea673au, 0xe6273e9eu, 0x484faf0fu,
+                0x61871bfdu, 0xcfef8a6cu, 0x32167219u, 0x9c7ee388u, 0xb5b6577au, 0x1bdec6ebu,
+                0x9534a1d1u, 0x3b5c3040u, 0x129484b2u, 0xbcfc1523u, 0x4105ed56u, 0xef6d7cc7u,
+                0xc6a5c835u, 0x68cd59a4u, 0x173f7b7du, 0xb957eaecu, 0x909f5e1eu, 0x3ef7cf8fu,
+                0xc30e37fau, 0x6d66a66bu, 0x44ae1299u, 0xeac68308u, 0x642ce432u, 0xca4475a3u,
+                0xe38cc151u, 0x4de450c0u, 0xb01da8b5u, 0x1e753924u, 0x37bd8dd6u, 0x99d51c47u,
+                0xf11845e3u, 0x5f70d472u, 0x76b86080u, 0xd8d0f111u, 0x25290964u, 0x8b4198f5u,
+                0xa2892c07u, 0x0ce1bd96u, 0x820bdaacu, 0x2c634b3du, 0x05abffcfu, 0xabc36e5eu,
+                0x563a962bu, 0xf85207bau, 0xd19ab348u, 0x7ff222d9u, 0x2e7ef6fau, 0x8016676bu,
+                0xa9ded399u, 0x07b64208u, 0xfa4fba7du, 0x54272becu, 0x7def9f1eu, 0xd3870e8fu,
+                0x5d6d69b5u, 0xf305f824u, 0xdacd4cd6u, 0x74a5dd47u, 0x895c2532u, 0x2734b4a3u,
+                0x0efc0051u, 0xa09491c0u, 0xc859c864u, 0x663159f5u, 0x4ff9ed07u, 0xe1917c96u,
+                0x1c6884e3u, 0xb2001572u, 0x9bc8a180u, 0x35a03011u, 0xbb4a572bu, 0x1522c6bau,
+                0x3cea7248u, 0x9282e3d9u, 0x6f7b1bacu, 0xc1138a3du, 0xe8db3ecfu, 0x46b3af5eu,
+                0x39418d87u, 0x97291c16u, 0xbee1a8e4u, 0x10893975u, 0xed70c100u, 0x43185091u,
+                0x6ad0e463u, 0xc4b875f2u, 0x4a5212c8u, 0xe43a8359u, 0xcdf237abu, 0x639aa63au,
+                0x9e635e4fu, 0x300bcfdeu, 0x19c37b2cu, 0xb7abeabdu, 0xdf66b319u, 0x710e2288u,
+                0x58c6967au, 0xf6ae07ebu, 0x0b57ff9eu, 0xa53f6e0fu, 0x8cf7dafdu, 0x229f4b6cu,
+                0xac752c56u, 0x021dbdc7u, 0x2bd50935u, 0x85bd98a4u, 0x784460d1u, 0xd62cf140u,
+                0xffe445b2u, 0x518cd423u, 0x5cfdedf4u, 0xf2957c65u, 0xdb5dc897u, 0x75355906u,
+                0x88cca173u, 0x26a430e2u, 0x0f6c8410u, 0xa1041581u, 0x2fee72bbu, 0x8186e32au,
+                0xa84e57d8u, 0x0626c649u, 0xfbdf3e3cu, 0x55b7afadu, 0x7c7f1b5fu, 0xd2178aceu,
+                0xbadad36au, 0x14b242fbu, 0x3d7af609u, 0x93126798u, 0x6eeb9fedu, 0xc0830e7cu,
+                0xe94bba8eu, 0x47232b1fu, 0xc9c94c25u, 0x67a1ddb4u, 0x4e696946u, 0xe001f8d7u,
+                0x1df800a2u, 0xb3909133u, 0x9a5825c1u, 0x3430b450u, 0x4bc29689u, 0xe5aa0718u,
+                0xcc62b3eau, 0x620a227bu, 0x9ff3da0eu, 0x319b4b9fu, 0x1853ff6du, 0xb63b6efcu,
+                0x38d109c6u, 0x96b99857u, 0xbf712ca5u, 0x1119bd34u, 0xece04541u, 0x4288d4d0u,
+                0x6b406022u, 0xc528f1b3u, 0xade5a817u, 0x038d3986u, 0x2a458d74u, 0x842d1ce5u,
+                0x79d4e490u, 0xd7bc7501u, 0xfe74c1f3u, 0x501c5062u, 0xdef63758u, 0x709ea6c9u,
+                0x5956123bu, 0xf73e83aau, 0x0ac77bdfu, 0xa4afea4eu, 0x8d675ebcu, 0x230fcf2du,
+                0x72831b0eu, 0xdceb8a9fu, 0xf5233e6du, 0x5b4baffcu, 0xa6b25789u, 0x08dac618u,
+                0x211272eau, 0x8f7ae37bu, 0x01908441u, 0xaff815d0u, 0x8630a122u, 0x285830b3u,
+                0xd5a1c8c6u, 0x7bc95957u, 0x5201eda5u, 0xfc697c34u, 0x94a42590u, 0x3accb401u,
+                0x130400f3u, 0xbd6c9162u, 0x40956917u, 0xeefdf886u, 0xc7354c74u, 0x695ddde5u,
+                0xe7b7badfu, 0x49df2b4eu, 0x60179fbcu, 0xce7f0e2du, 0x3386f658u, 0x9dee67c9u,
+                0xb426d33bu, 0x1a4e42aau, 0x65bc6073u, 0xcbd4f1e2u, 0xe21c4510u, 0x4c74d481u,
+                0xb18d2cf4u, 0x1fe5bd65u, 0x362d0997u, 0x98459806u, 0x16afff3cu, 0xb8c76eadu,
+                0x910fda5fu, 0x3f674bceu, 0xc29eb3bbu, 0x6cf6222au, 0x453e96d8u, 0xeb560749u,
+                0x839b5eedu, 0x2df3cf7cu, 0x043b7b8eu, 0xaa53ea1fu, 0x57aa126au, 0xf9c283fbu,
+                0xd00a3709u, 0x7e62a698u, 0xf088c1a2u, 0x5ee05033u, 0x7728e4c1u, 0xd9407550u,
+                0x24b98d25u, 0x8ad11cb4u, 0xa319a846u, 0x0d7139d7u
+        }
+};
+
+#endif
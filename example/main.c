@@ -1,4 +1,3 @@
-#include "CRC32.h"
 #include "PNGParser.h"
 
 #include <stdio.h>
@@ -37,8 +37,11 @@
 Includes
 ***********************************************************************************************************************/
 #include "PNGParser.h"
+#include "PNGParserAllocator.h"
+#include "PNGParserCRCWorker.h"
 #include "PNGParserDefs.h"
-#include "vector.h"
+#include "PNGParserFilter.h"
+#include "PNGParserPixel.h"
 #include <zlib.h>
 
 /***********************************************************************************************************************
@@ -55,10 +58,22 @@ PNGParserStateType sPNGParserStateTransitionTable[] = {
         /*PNGParser_State_Done                    -->*/ PNGParser_State_Done,
         /*PNGParser_State_Error                   -->*/ PNGParser_State_Error,
 };
+const PNGParserPassType sPNGParserAdam7Passes[ PNGPARSER_ADAM7_PASS_COUNT ] = {
+        /*Pass 1 -->*/ { 0, 0, 8, 8 },
+        /*Pass 2 -->*/ { 4, 0, 8, 8 },
+        /*Pass 3 -->*/ { 0, 4, 4, 8 },
+        /*Pass 4 -->*/ { 2, 0, 4, 4 },
+        /*Pass 5 -->*/ { 0, 2, 2, 4 },
+        /*Pass 6 -->*/ { 1, 0, 2, 2 },
+        /*Pass 7 -->*/ { 0, 1, 1, 2 },
+};
+const PNGParserPassType sPNGParserFullPass = { 0, 0, 1, 1 };
 PNGParserReadingChunkStateType sPNGParserReadingChunkStateTransitionTable[] = {
         /*PNGParser_Reading_Chunk_State_None         -->*/ PNGParser_Reading_Chunk_State_Get_Metadata,
-        /*PNGParser_Reading_Chunk_State_Get_Metadata -->*/ PNGParser_Reading_Chunk_State_Check_CRC32,
-        /*PNGParser_Reading_Chunk_State_Check_CRC32  -->*/ PNGParser_Reading_Chunk_State_None,
+        /*PNGParser_Reading_Chunk_State_Get_Metadata -->*/ PNGParser_Reading_Chunk_State_Read_Data,
+        /*PNGParser_Reading_Chunk_State_Read_Data    -->*/ PNGParser_Reading_Chunk_State_Check_CRC32,
+        /*PNGParser_Reading_Chunk_State_Check_CRC32  -->*/ PNGParser_Reading_Chunk_State_Process,
+        /*PNGParser_Reading_Chunk_State_Process      -->*/ PNGParser_Reading_Chunk_State_None,
         /*PNGParser_Reading_Chunk_State_Error        -->*/ PNGParser_Reading_Chunk_State_Error,
         /*PNGParser_Reading_Chunk_State_Done         -->*/ PNGParser_Reading_Chunk_State_Done,
 };
@@ -67,8 +82,16 @@ PNGParserReadingChunkStateType sPNGParserReadingChunkStateTransitionTable[] = {
 Static function Prototypes
 ***********************************************************************************************************************/
 
-void PNGParserInit( PNGParser* parser );
+void PNGParserResolveOptions( PNGParserOptionsType* pResolved, const PNGParserOptionsType* pOptions );
+void PNGParserInit( PNGParser* parser, const PNGParserOptionsType* pOptions );
+void PNGParserReset( PNGParser* parser );
+void PNGParserReleaseResources( PNGParser* parser );
+PNGParserResultType PNGParserReserve( PNGParser* parser, uint8_t** ppBuffer, uint32_t* pCapacity, uint32_t size );
+PNGParserResultType PNGParserComplete( PNGParser* parser, PNGImage* pImage );
 PNGParserResultType PNGParserUpdate( PNGParser* parser );
+PNGParserResultType PNGParserRequireBytes( PNGParser* parser, PNGParserStagingBufferType* staging, uint32_t size,
+                                           const uint8_t** ppData );
+void PNGParserReleaseStaging( PNGParser* parser, PNGParserStagingBufferType* staging );
 void PNGParserUpdateState( PNGParser* parser );
 void PNGParserReadingChunkUpdateState( PNGParser* parser );
 void PNGParserStateInit( PNGParser* parser );
@@ -77,24 +100,66 @@ PNGParserResultType PNGParserStateReadingChunk( PNGParser* parser );
 PNGParserChunkType PNGParserGetChunkType( const uint8_t* buffer );
 uint32_t PNGParserGetChunkLength( const uint8_t* buffer );
 uint32_t PNGParserGetReceivedCRC( const uint8_t* buffer );
-void PNGParserGetChunkMetadata( PNGParser* parser );
+PNGParserResultType PNGParserGetChunkMetadata( PNGParser* parser );
+PNGParserResultType PNGParserReadingChunkReadData( PNGParser* parser );
+PNGParserResultType PNGParserReadingChunkStreamData( PNGParser* parser );
 PNGParserResultType PNGParserReadingChunkCheckCRC32( PNGParser* parser );
-PNGParserResultType PNGParserParseIHDRChunk( PNGParser* parser, const uint8_t* buffer );
-PNGParserResultType PNGParserParseIDATChunk( PNGParser* parser, uint32_t chunkID );
+PNGParserResultType PNGParserParseIHDRChunk( PNGParser* parser, const uint8_t* buffer, uint32_t length );
+PNGParserResultType PNGParserReadIHDR( const uint8_t* buffer, uint32_t length, PNGMetadataDataType* pSpec );
+PNGParserResultType PNGParserCheckMemory( const PNGMetadataDataType* pSpec, const PNGParserOptionsType* pOptions,
+                                          const PNGParser* parser );
+BOOL PNGParserRowsNeedImage( const PNGMetadataDataType* pSpec, const PNGParserOptionsType* pOptions );
+PNGParserResultType PNGParserCheckLayout( const PNGParserOptionsType* pOptions );
+uint32_t PNGParserGetChunkMaxLength( PNGParserChunkType type );
+uint64_t PNGParserGetRowBytes( const PNGMetadataDataType* pSpec, const PNGParserOptionsType* pOptions,
+                               BOOL transparency );
+uint64_t PNGParserGetOutputBytes( const PNGMetadataDataType* pSpec, const PNGParserOptionsType* pOptions,
+                                  BOOL transparency );
+uint32_t PNGParserGetOutputChannels( const PNGMetadataDataType* pSpec, const PNGParserOptionsType* pOptions,
+                                     BOOL transparency );
+uint32_t PNGParserGetOutputSampleBytes( const PNGMetadataDataType* pSpec, const PNGParserOptionsType* pOptions );
+BOOL PNGParserIsTensor( const PNGParserOptionsType* pOptions );
+uint32_t PNGParserGetElementBytes( const PNGMetadataDataType* pSpec, const PNGParserOptionsType* pOptions );
+uint32_t PNGParserGetScaledLength( uint32_t length, const PNGParserOptionsType* pOptions );
+BOOL PNGParserGetRegion( const PNGMetadataDataType* pSpec, const PNGParserOptionsType* pOptions,
+                         PNGParserRectType* pRegion );
+PNGParserPaletteModeType PNGParserGetPaletteMode( const PNGParserOptionsType* pOptions );
+uint64_t PNGParserGetScanLineBytes( const PNGMetadataDataType* pSpec, uint32_t width );
+uint32_t PNGParserGetPassLength( uint32_t length, uint32_t start, uint32_t step );
+void PNGParserStartPass( PNGParser* parser );
+BOOL PNGParserIsLastPass( const PNGParser* parser );
+BOOL PNGParserIsRegionDone( const PNGParser* parser );
+void PNGParserOutputRow( PNGParser* parser, const uint8_t* scanLine );
+void PNGParserScaleRow( PNGParser* parser, uint32_t x, uint32_t y, const uint8_t* pixels, uint32_t lead );
+void PNGParserAverageRegion( PNGParser* parser );
+void PNGParserEmitRow( PNGParser* parser, uint32_t y );
+void PNGParserTileRow( PNGParser* parser, uint32_t y, const uint8_t* row );
+void PNGParserClearTilePadding( PNGParser* parser );
+void PNGParserTensorRow( PNGParser* parser, uint32_t y, const uint8_t* row );
+void PNGParserSetupTensor( PNGParser* parser );
+void PNGParserReportProgress( PNGParser* parser );
+void PNGParserFillPreview( PNGParser* parser );
+void PNGParserSetupRowConversion( PNGParser* parser );
+void PNGParserSetupPaletteLookup( PNGParser* parser );
+void PNGParserConvertRow( PNGParser* parser, uint8_t* output, const uint8_t* row, uint32_t count );
+void PNGParserGetMemoryRequirements( const PNGMetadataDataType* pSpec, const PNGParserOptionsType* pOptions,
+                                     uint64_t* pScratchBytes, uint64_t* pOutputBytes );
+PNGParserResultType PNGParserParseIDATChunk( PNGParser* parser, const uint8_t* data, uint32_t length );
+PNGParserResultType PNGParserParsePLTEChunk( PNGParser* parser, const uint8_t* buffer, uint32_t length );
+PNGParserResultType PNGParserParseTRNSChunk( PNGParser* parser, const uint8_t* buffer, uint32_t length );
 void PNGParserParseGAMMAChunk( PNGParser* parser, const uint8_t* buffer );
 void PNGParserParseSRGBChunk( PNGParser* parser, const uint8_t* buffer );
 PNGParserResultType PNGParserProcessPNG( PNGParser* parser );
-PNGParserResultType PNGParserDecompressBuffer( PNGParser* parser );
-uint16_t PNGParserPaethPredictor( int16_t a, int16_t b, int16_t c );
-void PNGParserFilterCurrentByte( PNGParserFilteringType filter, uint8_t* currentByte, uint8_t up, uint8_t left,
-                                 uint8_t upleft );
-void PNGParserGetNeighbourBytes( const uint8_t* data, uint32_t index, uint32_t offset, uint32_t row, uint32_t rowStride,
-                                 uint32_t channels, uint8_t* up, uint8_t* left, uint8_t* upleft );
-void PNGParserFilterRow( PNGParser* parser, uint32_t imageDataOffset, uint32_t scanLineOffset, uint32_t rowStride,
-                         uint32_t row );
-PNGParserResultType PNGParserFilterBuffer( PNGParser* parser );
-PNGParserResultType PNGParserCheckCRC( uint8_t* buffer, uint32_t length, uint32_t receivedCRC );
-PNGParserResultType PNGParserProcessChunks( PNGParser* parser );
+PNGParserResultType PNGParserInflateInit( PNGParser* parser );
+PNGParserResultType PNGParserInflateChunk( PNGParser* parser, const uint8_t* chunkData, uint32_t length );
+PNGParserResultType PNGParserReadZlibHeader( PNGParser* parser, const uint8_t** pChunkData, uint32_t* pLength );
+void PNGParserInflateEnd( PNGParser* parser );
+PNGParserResultType PNGParserFilterRow( PNGParser* parser, uint8_t* scanLine, const uint8_t* previousScanLine );
+PNGParserResultType PNGParserProcessScanLine( PNGParser* parser );
+PNGParserResultType PNGParserCheckCRC( uint32_t calculatedCRC, uint32_t receivedCRC );
+BOOL PNGParserDeferCRC( PNGParser* parser );
+PNGParserResultType PNGParserWaitCRC( PNGParser* parser );
+PNGParserResultType PNGParserProcessChunk( PNGParser* parser );
 
 /***********************************************************************************************************************
 Implementation
@@ -102,46 +167,390 @@ Implementation
 PNGParserStateType PNGParserGetState( PNGParser* parser ) { return parser->state; }
 
 PNGParserResultType PNGParse( uint8_t* data, uint32_t length, PNGImageDataType* pImage )
+{
+    return PNGParseWithOptions( data, length, pImage, NULL );
+}
+
+PNGParserResultType PNGParseWithOptions( uint8_t* data, uint32_t length, PNGImage* pImage,
+                                         const PNGParserOptionsType* pOptions )
+{
+    PNGParser parser;
+    PNGParserInit( &parser, pOptions );
+    PNGParserFeed( &parser, data, length );
+
+    return PNGParserComplete( &parser, pImage );
+}
+
+PNGParserResultType PNGParseInto( uint8_t* data, uint32_t length, PNGImage* pImage, uint8_t* destination,
+                                  uint32_t capacity, uint32_t rowStride, const PNGParserOptionsType* pOptions )
+{
+    PNGParser parser;
+    PNGParserInit( &parser, pOptions );
+    PNGParserSetOutput( &parser, destination, capacity, rowStride );
+    PNGParserFeed( &parser, data, length );
+
+    return PNGParserComplete( &parser, pImage );
+}
+
+PNGParserResultType PNGParseRows( uint8_t* data, uint32_t length, PNGImage* pImage, PNGParserRowFunction rowOutput,
+                                  void* context, const PNGParserOptionsType* pOptions )
 {
     PNGParser parser;
-    parser.parameters.raw_data = data;
-    parser.parameters.length = length;
+    PNGParserInit( &parser, pOptions );
+    PNGParserSetRowOutput( &parser, rowOutput, context );
+    PNGParserFeed( &parser, data, length );
 
-    PNGParserInit( &parser );
+    return PNGParserComplete( &parser, pImage );
+}
 
+PNGParserResultType PNGParseHeader( const uint8_t* data, uint32_t length, PNGProbe* pProbe,
+                                    const PNGParserOptionsType* pOptions )
+{
+    const uint8_t signature[] = PNG_SIGNATURE_ARR_DATA;
+    const uint8_t* chunk = &data[ PNG_SIGNATURE_LENGTH ];
+    const uint8_t* chunkData = &chunk[ PNGPARSER_CHUNK_DATA_OFFSET ];
     PNGParserResultType result = PNGParser_Result_OK;
-    while ( ( PNGParserGetState( &parser ) != PNGParser_State_Done ) && ( PNGParser_Result_OK == result ) )
+
+    PNGPARSER_MEMSET( pProbe, 0, sizeof( *pProbe ) );
+    if ( length < PNG_SIGNATURE_LENGTH + PNGPARSER_CHUNK_METADATA_LENGTH + PNGPARSER_IHDR_LENGTH )
+    {
+        result = PNGParser_Error_Buffer_Length;
+    }
+    for ( uint8_t i = 0; PNGParser_Result_OK == result && i < PNG_SIGNATURE_LENGTH; ++i )
+    {
+        if ( signature[ i ] != data[ i ] ) { result = PNGParser_Error_Wrong_Signature; }
+    }
+
+    /* IHDR has to be the first chunk, and its length is checked before it is used to find the CRC. */
+    uint32_t chunkLength = 0;
+    if ( PNGParser_Result_OK == result )
+    {
+        chunkLength = PNGParserGetChunkLength( chunk );
+        if ( PNGParserGetChunkType( &chunk[ PNGPARSER_CHUNK_TYPE_OFFSET ] ) != PNGParser_Chunk_IHDR ||
+             PNGPARSER_IHDR_LENGTH != chunkLength )
+        {
+            result = PNGParser_Error_Corrupted_Data;
+        }
+    }
+    if ( PNGParser_Result_OK == result && ( NULL == pOptions || PNGParser_CRC_Mode_Skip != pOptions->crcMode ) )
+    {
+        uint32_t calculatedCRC = CRC32Update( 0, ( uint8_t* ) &chunk[ PNGPARSER_CHUNK_TYPE_OFFSET ],
+                                              PNGPARSER_CHUNK_TYPE_LENGTH + chunkLength );
+        result = PNGParserCheckCRC( calculatedCRC, PNGParserGetReceivedCRC( &chunkData[ chunkLength ] ) );
+    }
+    if ( PNGParser_Result_OK == result ) { result = PNGParserReadIHDR( chunkData, chunkLength, &pProbe->imageSpec ); }
+    if ( PNGParser_Result_OK == result )
+    {
+        PNGParserRectType region;
+        BOOL inside = PNGParserGetRegion( &pProbe->imageSpec, pOptions, &region );
+        pProbe->width = PNGParserGetScaledLength( region.width, pOptions );
+        pProbe->height = PNGParserGetScaledLength( region.height, pOptions );
+        PNGParserGetMemoryRequirements( &pProbe->imageSpec, pOptions, &pProbe->scratchBytes, &pProbe->outputBytes );
+        result = PNGParserCheckLayout( pOptions );
+        if ( PNGParser_Result_OK == result && !inside ) { result = PNGParser_Error_Region_Outside_Image; }
+        if ( PNGParser_Result_OK == result ) { result = PNGParserCheckMemory( &pProbe->imageSpec, pOptions, NULL ); }
+    }
+    return result;
+}
+
+void PNGParserGetDefaultOptions( PNGParserOptionsType* pOptions )
+{
+    PNGPARSER_MEMSET( pOptions, 0, sizeof( *pOptions ) );
+    pOptions->crcMode = PNGParser_CRC_Mode_Full;
+    pOptions->checkAdler32 = TRUE;
+    pOptions->tileSize = PNGPARSER_TILE_DEFAULT_SIZE;
+    for ( uint32_t c = 0; c < 4u; c++ ) { pOptions->sampleScale[ c ] = 1.0f; }
+    PNGParserGetDefaultAllocator( &pOptions->allocator );
+}
+
+void PNGParserResolveOptions( PNGParserOptionsType* pResolved, const PNGParserOptionsType* pOptions )
+{
+    if ( NULL != pOptions ) { *pResolved = *pOptions; }
+    else { PNGParserGetDefaultOptions( pResolved ); }
+    if ( NULL == pResolved->allocator.allocate || NULL == pResolved->allocator.free )
+    {
+        PNGParserGetDefaultAllocator( &pResolved->allocator );
+    }
+}
+
+PNGParser* PNGParserCreate( void ) { return PNGParserCreateWithOptions( NULL ); }
+
+PNGParser* PNGParserCreateWithOptions( const PNGParserOptionsType* pOptions )
+{
+    PNGParserOptionsType options;
+    PNGParserResolveOptions( &options, pOptions );
+
+    PNGParser* parser = ( PNGParser* ) PNGParserAllocate( &options.allocator, sizeof( PNGParser ) );
+    if ( NULL != parser ) { PNGParserInit( parser, &options ); }
+    return parser;
+}
+
+void PNGParserSetOutput( PNGParser* parser, uint8_t* destination, uint32_t capacity, uint32_t rowStride )
+{
+    parser->destination = destination;
+    parser->destinationCapacity = capacity;
+    parser->destinationRowStride = rowStride;
+    parser->rowOutput = NULL;
+    parser->rowOutputContext = NULL;
+}
+
+void PNGParserSetRowOutput( PNGParser* parser, PNGParserRowFunction rowOutput, void* context )
+{
+    parser->rowOutput = rowOutput;
+    parser->rowOutputContext = context;
+    parser->destination = NULL;
+    parser->destinationCapacity = 0;
+    parser->destinationRowStride = 0;
+}
+
+PNGParserResultType PNGParserFeed( PNGParser* parser, uint8_t* data, uint32_t length )
+{
+    parser->parameters.raw_data = data;
+    parser->parameters.length = length;
+    parser->seekOffset = 0;
+    parser->inputExhausted = FALSE;
+
+    while ( ( PNGParserGetState( parser ) != PNGParser_State_Done ) && ( PNGParser_Result_OK == parser->result ) &&
+            !parser->inputExhausted )
+    {
+        parser->result = PNGParserUpdate( parser );
+    }
+
+    /* Deferred CRCs read the input in place, so they have to be through before it is handed back. */
+    PNGParserResultType crcResult = PNGParserWaitCRC( parser );
+    if ( PNGParser_Result_OK == parser->result ) { parser->result = crcResult; }
+
+    /* The caller owns the bytes, nothing may point into them once this call returns. */
+    parser->parameters.raw_data = NULL;
+    parser->parameters.length = 0;
+    return parser->result;
+}
+
+PNGParserResultType PNGParserFinish( PNGParser* parser, PNGImage* pImage )
+{
+    PNGParserAllocatorType allocator = parser->options.allocator;
+    PNGParserResultType result = PNGParserComplete( parser, pImage );
+    PNGParserFree( &allocator, parser, sizeof( PNGParser ) );
+    return result;
+}
+
+PNGDecoder* PNGDecoderCreate( const PNGParserOptionsType* pOptions )
+{
+    PNGParserOptionsType options;
+    PNGParserResolveOptions( &options, pOptions );
+
+    PNGDecoder* decoder = ( PNGDecoder* ) PNGParserAllocate( &options.allocator, sizeof( PNGDecoder ) );
+    if ( NULL != decoder )
     {
-        result = PNGParserUpdate( &parser );
+        PNGParserInit( &decoder->parser, &options );
+        decoder->parser.retainResources = TRUE;
     }
+    return decoder;
+}
+
+PNGParserResultType PNGDecoderDecode( PNGDecoder* decoder, uint8_t* data, uint32_t length, PNGImage* pImage )
+{
+    PNGParserReset( &decoder->parser );
+    PNGParserFeed( &decoder->parser, data, length );
+
+    return PNGParserComplete( &decoder->parser, pImage );
+}
+
+PNGParserResultType PNGDecoderDecodeInto( PNGDecoder* decoder, uint8_t* data, uint32_t length, PNGImage* pImage,
+                                          uint8_t* destination, uint32_t capacity, uint32_t rowStride )
+{
+    PNGParserReset( &decoder->parser );
+    PNGParserSetOutput( &decoder->parser, destination, capacity, rowStride );
+    PNGParserFeed( &decoder->parser, data, length );
+
+    return PNGParserComplete( &decoder->parser, pImage );
+}
+
+PNGParserResultType PNGDecoderDecodeRows( PNGDecoder* decoder, uint8_t* data, uint32_t length, PNGImage* pImage,
+                                          PNGParserRowFunction rowOutput, void* context )
+{
+    PNGParserReset( &decoder->parser );
+    PNGParserSetRowOutput( &decoder->parser, rowOutput, context );
+    PNGParserFeed( &decoder->parser, data, length );
 
-    vec_deinit( &parser.chunks );
+    return PNGParserComplete( &decoder->parser, pImage );
+}
+
+void PNGDecoderDestroy( PNGDecoder* decoder )
+{
+    PNGParserAllocatorType allocator = decoder->parser.options.allocator;
+    PNGParserReleaseResources( &decoder->parser );
+    PNGParserFree( &allocator, decoder, sizeof( PNGDecoder ) );
+}
+
+PNGParserResultType PNGParserComplete( PNGParser* parser, PNGImage* pImage )
+{
+    PNGParserResultType result = parser->result;
+    if ( PNGParser_Result_OK == result && PNGParserGetState( parser ) != PNGParser_State_Done )
+    {
+        result = PNGParser_Error_Buffer_Length;
+    }
 
-    pImage->data = parser.imageData;
-    pImage->length = parser.imageDataLength;
-    pImage->imageSpec = parser.imageSpec;
+    pImage->data = NULL;
+    pImage->length = 0;
+    pImage->imageSpec = parser->imageSpec;
+    pImage->width = parser->outputWidth;
+    pImage->height = parser->outputHeight;
+    pImage->channels = parser->outputChannels;
+    pImage->bytesPerSample = parser->outputSampleBytes;
+    pImage->sampleType = PNGParser_Sample_Integer;
+    pImage->planar = FALSE;
+    if ( NULL == parser->rowOutput && PNGParserIsTensor( &parser->options ) )
+    {
+        pImage->bytesPerSample = PNGParserGetElementBytes( &parser->imageSpec, &parser->options );
+        pImage->sampleType = parser->options.sampleType;
+        pImage->planar = parser->options.planar;
+    }
+    pImage->paletteLength = parser->paletteLength;
+    PNGPARSER_MEMCPY( pImage->palette, parser->palette, sizeof( pImage->palette ) );
+    if ( PNGParser_Result_OK == result && NULL == parser->rowOutput )
+    {
+        pImage->data = ( NULL != parser->layoutData ) ? parser->layoutData : parser->outputData;
+        pImage->length = parser->imageDataLength;
+    }
 
+    if ( !parser->retainResources )
+    {
+        /* The image belongs to the caller from here on. */
+        if ( PNGParser_Result_OK == result && NULL == parser->destination && NULL == parser->rowOutput )
+        {
+            parser->imageData = NULL;
+            parser->imageDataCapacity = 0;
+        }
+        PNGParserReleaseResources( parser );
+    }
     return result;
 }
 
-void PNGImageFree( uint8_t* imageData, uint32_t length ) { PNGPARSER_FREE( imageData, length ); }
+void PNGImageFree( uint8_t* imageData, uint32_t length )
+{
+    ( void ) length;
+    PNGPARSER_FREE( imageData, length );
+}
+
+void PNGImageFreeWithAllocator( const PNGParserAllocatorType* pAllocator, uint8_t* imageData, uint32_t length )
+{
+    PNGParserAllocatorType allocator;
+    if ( NULL == pAllocator )
+    {
+        PNGParserGetDefaultAllocator( &allocator );
+        pAllocator = &allocator;
+    }
+    PNGParserFree( pAllocator, imageData, length );
+}
+
+void PNGParserInit( PNGParser* parser, const PNGParserOptionsType* pOptions )
+{
+    PNGParserResolveOptions( &parser->options, pOptions );
+    parser->crcWorker = NULL;
+    PNGPARSER_MEMSET( &parser->headerStaging, 0, sizeof( parser->headerStaging ) );
+    PNGPARSER_MEMSET( &parser->chunkStaging, 0, sizeof( parser->chunkStaging ) );
+    parser->scanLineBuffer = NULL;
+    parser->scanLineBufferCapacity = 0;
+    parser->imageData = NULL;
+    parser->imageDataCapacity = 0;
+    parser->inflateStreamInitialized = FALSE;
+    parser->retainResources = FALSE;
+    PNGParserReset( parser );
+}
 
-void PNGParserInit( PNGParser* parser )
+void PNGParserReset( PNGParser* parser )
 {
     parser->state = PNGParser_State_None;
+    parser->result = PNGParser_Result_OK;
+    parser->parameters.raw_data = NULL;
+    parser->parameters.length = 0;
     parser->seekOffset = 0;
+    parser->inputExhausted = FALSE;
+    parser->chunkBytesRead = 0;
+    parser->calculatedCRC = 0;
+    parser->headerStaging.length = 0;
+    parser->chunkStaging.length = 0;
     parser->chunkCount = 0;
-    parser->compressedData = NULL;
-    parser->compressedLength = 0;
-    parser->decompressionBuffer = NULL;
-    vec_init( &parser->chunks );
+    PNGPARSER_MEMSET( &parser->imageSpec, 0, sizeof( parser->imageSpec ) );
+    PNGPARSER_MEMSET( &parser->currentChunk, 0, sizeof( parser->currentChunk ) );
+    parser->scanLineLength = 0;
+    parser->scanLineSlotLength = 0;
+    parser->scanLineFilled = 0;
+    parser->currentRow = 0;
+    parser->passes = NULL;
+    parser->passCount = 0;
+    parser->passIndex = 0;
+    parser->passWidth = 0;
+    parser->passHeight = 0;
+    parser->progressRow = 0;
+    PNGPARSER_MEMSET( &parser->region, 0, sizeof( parser->region ) );
+    parser->regionDone = FALSE;
+    parser->regionStopped = FALSE;
+    parser->decompressedLength = 0;
+    parser->maxDecompressionLength = 0;
+    parser->inflateStreamStarted = FALSE;
+    parser->inflateStreamEnded = FALSE;
+    parser->zlibHeaderLength = 0;
+    parser->paletteLength = 0;
+    parser->paletteTransparency = FALSE;
+    PNGPARSER_MEMSET( parser->palette, 0, sizeof( parser->palette ) );
+    parser->outputChannels = 0;
+    parser->outputSampleBytes = 0;
+    parser->outputWidth = 0;
+    parser->outputHeight = 0;
     parser->imageDataLength = 0;
-    parser->imageData = NULL;
+    parser->outputData = NULL;
+    parser->outputRowStride = 0;
+    parser->destination = NULL;
+    parser->destinationCapacity = 0;
+    parser->destinationRowStride = 0;
+    parser->rowOutput = NULL;
+    parser->rowOutputContext = NULL;
+    parser->layoutData = NULL;
+    parser->emitRows = FALSE;
     parser->readingChunkState = PNGParser_Reading_Chunk_State_None;
     parser->state = PNGParser_State_None;
     PNGParserUpdateState( parser );
 }
 
+void PNGParserReleaseResources( PNGParser* parser )
+{
+    PNGParserInflateEnd( parser );
+    if ( NULL != parser->crcWorker )
+    {
+        PNGParserCRCWorkerDestroy( parser->crcWorker );
+        parser->crcWorker = NULL;
+    }
+    PNGParserReleaseStaging( parser, &parser->headerStaging );
+    PNGParserReleaseStaging( parser, &parser->chunkStaging );
+    PNGParserFree( &parser->options.allocator, parser->scanLineBuffer, parser->scanLineBufferCapacity );
+    parser->scanLineBuffer = NULL;
+    parser->scanLineBufferCapacity = 0;
+    PNGParserFree( &parser->options.allocator, parser->imageData, parser->imageDataCapacity );
+    parser->imageData = NULL;
+    parser->imageDataCapacity = 0;
+}
+
+PNGParserResultType PNGParserReserve( PNGParser* parser, uint8_t** ppBuffer, uint32_t* pCapacity, uint32_t size )
+{
+    PNGParserResultType result = PNGParser_Result_OK;
+
+    /* The old contents are never needed, so a short buffer is replaced rather than reallocated. */
+    if ( NULL == *ppBuffer || *pCapacity < size )
+    {
+        PNGParserFree( &parser->options.allocator, *ppBuffer, *pCapacity );
+        *ppBuffer = ( uint8_t* ) PNGParserAllocate( &parser->options.allocator, size );
+        *pCapacity = size;
+        if ( NULL == *ppBuffer )
+        {
+            *pCapacity = 0;
+            result = PNGParser_Error_Allocating_Memory;
+        }
+    }
+    return result;
+}
+
 PNGParserResultType PNGParserUpdate( PNGParser* parser )
 {
     PNGParserResultType result = PNGParser_Result_OK;
@@ -157,7 +566,9 @@ PNGParserResultType PNGParserUpdate( PNGParser* parser )
             result = PNGParserStateReadingChunk( parser );
             break;
         case PNGParser_State_Reading_Chunks_Done:
-            result = PNGParserProcessChunks( parser );
+            result = PNGParserProcessPNG( parser );
+            if ( PNGParser_Result_OK == result ) { PNGParserUpdateState( parser ); }
+            break;
         default:
             PNGParserUpdateState( parser );
             break;
@@ -174,23 +585,72 @@ void PNGParserReadingChunkUpdateState( PNGParser* parser )
 
 void PNGParserStateInit( PNGParser* parser ) { PNGParserUpdateState( parser ); }
 
-PNGParserResultType PNGParserStateCheckingSignature( PNGParser* parser )
+PNGParserResultType PNGParserRequireBytes( PNGParser* parser, PNGParserStagingBufferType* staging, uint32_t size,
+                                           const uint8_t** ppData )
 {
     PNGParserResultType result = PNGParser_Result_OK;
-    uint32_t length = parser->parameters.length;
-    uint8_t* buffer = parser->parameters.raw_data;
+    uint32_t available = parser->parameters.length - parser->seekOffset;
+    uint8_t* input = &parser->parameters.raw_data[ parser->seekOffset ];
 
-    if ( length < PNG_SIGNATURE_LENGTH ) { result = PNGParser_Error_Buffer_Length; }
+    *ppData = NULL;
+    if ( 0u == staging->length && available >= size )
+    {
+        /* Everything is in the current input, hand it out without copying. */
+        *ppData = input;
+        parser->seekOffset += size;
+    }
     else
+    {
+        if ( staging->capacity < size )
+        {
+            uint8_t* checkBuffPtr = ( uint8_t* ) PNGParserReallocate( &parser->options.allocator, staging->data,
+                                                                      staging->capacity, size );
+            if ( NULL == checkBuffPtr ) { result = PNGParser_Error_Allocating_Memory; }
+            else
+            {
+                staging->data = checkBuffPtr;
+                staging->capacity = size;
+            }
+        }
+        if ( PNGParser_Result_OK == result )
+        {
+            uint32_t copyLength = size - staging->length;
+            if ( copyLength > available ) { copyLength = available; }
+            PNGPARSER_MEMCPY( &staging->data[ staging->length ], input, copyLength );
+            staging->length += copyLength;
+            parser->seekOffset += copyLength;
+
+            if ( staging->length == size )
+            {
+                *ppData = staging->data;
+                staging->length = 0;
+            }
+        }
+    }
+    if ( NULL == *ppData ) { parser->inputExhausted = TRUE; }
+    return result;
+}
+
+void PNGParserReleaseStaging( PNGParser* parser, PNGParserStagingBufferType* staging )
+{
+    PNGParserFree( &parser->options.allocator, staging->data, staging->capacity );
+    PNGPARSER_MEMSET( staging, 0, sizeof( *staging ) );
+}
+
+PNGParserResultType PNGParserStateCheckingSignature( PNGParser* parser )
+{
+    const uint8_t* buffer;
+    PNGParserResultType result = PNGParserRequireBytes( parser, &parser->headerStaging, PNG_SIGNATURE_LENGTH, &buffer );
+
+    if ( PNGParser_Result_OK == result && NULL != buffer )
     {
         const uint8_t signature[] = PNG_SIGNATURE_ARR_DATA;
         for ( uint8_t i = 0; ( ( i < PNG_SIGNATURE_LENGTH ) && ( result != PNGParser_Error_Wrong_Signature ) ); ++i )
         {
             if ( signature[ i ] != buffer[ i ] ) { result = PNGParser_Error_Wrong_Signature; }
         }
+        if ( PNGParser_Result_OK == result ) { PNGParserUpdateState( parser ); }
     }
-    parser->seekOffset += PNG_SIGNATURE_LENGTH;
-    if ( PNGParser_Result_OK == result ) { PNGParserUpdateState( parser ); }
     return result;
 }
 
@@ -203,10 +663,16 @@ PNGParserResultType PNGParserStateReadingChunk( PNGParser* parser )
             PNGParserReadingChunkUpdateState( parser );
             break;
         case PNGParser_Reading_Chunk_State_Get_Metadata:
-            PNGParserGetChunkMetadata( parser );
+            result = PNGParserGetChunkMetadata( parser );
+            break;
+        case PNGParser_Reading_Chunk_State_Read_Data:
+            result = PNGParserReadingChunkReadData( parser );
             break;
         case PNGParser_Reading_Chunk_State_Check_CRC32:
             result = PNGParserReadingChunkCheckCRC32( parser );
+            break;
+        case PNGParser_Reading_Chunk_State_Process:
+            result = PNGParserProcessChunk( parser );
             if ( PNGParser_Result_OK == result ) { PNGParserReadingChunkUpdateState( parser ); }
             break;
         default:
@@ -229,6 +695,7 @@ PNGParserChunkType PNGParserGetChunkType( const uint8_t* buffer )
         case GAMMA_WORD:
         case IDAT_WORD:
         case IEND_WORD:
+        case TRNS_WORD:
             result = upperCaseType;
             break;
         default:
@@ -237,6 +704,53 @@ PNGParserChunkType PNGParserGetChunkType( const uint8_t* buffer )
     return result;
 }
 
+PNGParserResultType PNGParserCheckLayout( const PNGParserOptionsType* pOptions )
+{
+    PNGParserResultType result = PNGParser_Result_OK;
+    if ( NULL != pOptions && PNGParser_Layout_Linear != pOptions->layout && !PNGParserIsTensor( pOptions ) )
+    {
+        uint32_t size = pOptions->tileSize;
+        if ( 0u == size || size > PNGPARSER_TILE_MAX_SIZE ||
+             ( PNGParser_Layout_Morton == pOptions->layout && 0u != ( size & ( size - 1u ) ) ) )
+        {
+            result = PNGParser_Error_Tile_Size;
+        }
+    }
+    return result;
+}
+
+BOOL PNGParserRowsNeedImage( const PNGMetadataDataType* pSpec, const PNGParserOptionsType* pOptions )
+{
+    /* A downscaled interlaced image keeps its sums instead, and averages them into the rows at the end. */
+    return PNGPARSER_INTERLACE_ADAM7 == pSpec->interlaceMethod && PNGParser_Scale_Full == pOptions->scale;
+}
+
+uint32_t PNGParserGetChunkMaxLength( PNGParserChunkType type )
+{
+    uint32_t maxLength = PNGPARSER_CHUNK_MAX_LENGTH;
+    switch ( type )
+    {
+        case PNGParser_Chunk_IHDR:
+            maxLength = PNGPARSER_IHDR_LENGTH;
+            break;
+        case PNGParser_Chunk_PLTE:
+            maxLength = PNGPARSER_PLTE_MAX_LENGTH;
+            break;
+        case PNGParser_Chunk_GAMMA:
+            maxLength = PNGPARSER_GAMMA_LENGTH;
+            break;
+        case PNGParser_Chunk_SRGB:
+            maxLength = PNGPARSER_SRGB_LENGTH;
+            break;
+        case PNGParser_Chunk_TRNS:
+            maxLength = PNGPARSER_TRNS_MAX_LENGTH;
+            break;
+        default:
+            break;
+    }
+    return maxLength;
+}
+
 uint32_t PNGParserGetChunkLength( const uint8_t* buffer )
 {
     return UINT8_TO_UINT32( buffer[ 0 ], buffer[ 1 ], buffer[ 2 ], buffer[ 3 ] );
@@ -247,287 +761,1275 @@ uint32_t PNGParserGetReceivedCRC( const uint8_t* buffer )
     return UINT8_TO_UINT32( buffer[ 0 ], buffer[ 1 ], buffer[ 2 ], buffer[ 3 ] );
 }
 
-void PNGParserGetChunkMetadata( PNGParser* parser )
+PNGParserResultType PNGParserGetChunkMetadata( PNGParser* parser )
+{
+    const uint8_t* buffer;
+    PNGParserResultType result =
+            PNGParserRequireBytes( parser, &parser->headerStaging, PNGPARSER_CHUNK_DATA_OFFSET, &buffer );
+
+    if ( PNGParser_Result_OK == result && NULL != buffer )
+    {
+        PNGChunk* chunk = &parser->currentChunk;
+
+        chunk->length = PNGParserGetChunkLength( buffer );
+        chunk->type = PNGParserGetChunkType( &buffer[ PNGPARSER_CHUNK_TYPE_OFFSET ] );
+        chunk->chunkData = NULL;
+        chunk->CRC = 0;
+        chunk->flags = PNGPARSER_CHUNK_FLAG_NONE;
+        parser->chunkBytesRead = 0;
+        parser->calculatedCRC = 0;
+        if ( PNGParser_CRC_Mode_Skip != parser->options.crcMode )
+        {
+            parser->calculatedCRC = CRC32Update( 0, ( uint8_t* ) &buffer[ PNGPARSER_CHUNK_TYPE_OFFSET ],
+                                                 PNGPARSER_CHUNK_TYPE_LENGTH );
+        }
+        parser->chunkCount += 1;
+
+        /* Only the small ancillary chunks the parser reads are collected whole, image data and unknown chunks
+         * are passed through piece by piece as the input arrives. */
+        if ( chunk->type != PNGParser_Chunk_IDAT && chunk->type != PNGParser_Chunk_None )
+        {
+            chunk->flags |= PNGPARSER_CHUNK_FLAG_BUFFERED;
+        }
+
+        /* IHDR comes first and only once, every later chunk is read against the image it describes. A chunk the
+         * parser collects is never larger than its type allows, so a forged length cannot make it allocate. */
+        if ( ( 1u == parser->chunkCount ) != ( PNGParser_Chunk_IHDR == chunk->type ) )
+        {
+            result = PNGParser_Error_Corrupted_Data;
+        }
+        else if ( chunk->length > PNGParserGetChunkMaxLength( chunk->type ) )
+        {
+            result = PNGParser_Error_Corrupted_Data;
+        }
+        else if ( chunk->type == PNGParser_Chunk_IEND )
+        {
+            parser->readingChunkState = PNGParser_Reading_Chunk_State_None;
+            parser->state = PNGParser_State_Reading_Chunks_Done;
+        }
+        else
+        {
+            if ( PNGParserDeferCRC( parser ) ) { PNGParserCRCWorkerBegin( parser->crcWorker, parser->calculatedCRC ); }
+            PNGParserReadingChunkUpdateState( parser );
+        }
+    }
+    return result;
+}
+
+PNGParserResultType PNGParserReadingChunkReadData( PNGParser* parser )
+{
+    PNGParserResultType result = PNGParser_Result_OK;
+    PNGChunk* chunk = &parser->currentChunk;
+
+    if ( chunk->flags & PNGPARSER_CHUNK_FLAG_BUFFERED )
+    {
+        /* The CRC is gathered together with the data so the chunk can be checked and processed before the input
+         * that holds it is handed back to the caller. */
+        const uint8_t* buffer;
+        result = PNGParserRequireBytes( parser, &parser->chunkStaging, chunk->length + PNGPARSER_CHUNK_CRC_LENGTH,
+                                        &buffer );
+        if ( PNGParser_Result_OK == result && NULL != buffer )
+        {
+            chunk->chunkData = ( uint8_t* ) buffer;
+            chunk->CRC = PNGParserGetReceivedCRC( &buffer[ chunk->length ] );
+            chunk->flags |= PNGPARSER_CHUNK_FLAG_CRC_RECEIVED;
+            if ( PNGParser_CRC_Mode_Skip != parser->options.crcMode )
+            {
+                parser->calculatedCRC = CRC32Update( parser->calculatedCRC, chunk->chunkData, chunk->length );
+            }
+            parser->chunkBytesRead = chunk->length;
+            PNGParserReadingChunkUpdateState( parser );
+        }
+    }
+    else { result = PNGParserReadingChunkStreamData( parser ); }
+
+    return result;
+}
+
+PNGParserResultType PNGParserReadingChunkStreamData( PNGParser* parser )
 {
-    uint32_t length = parser->parameters.length;
+    PNGParserResultType result = PNGParser_Result_OK;
+    PNGChunk* chunk = &parser->currentChunk;
+
+    uint32_t available = parser->parameters.length - parser->seekOffset;
+    uint32_t length = chunk->length - parser->chunkBytesRead;
+    if ( length > available ) { length = available; }
+
     uint8_t* buffer = &parser->parameters.raw_data[ parser->seekOffset ];
+    if ( chunk->type == PNGParser_Chunk_IDAT && length > 0u )
+    {
+        if ( PNGParserDeferCRC( parser ) ) { PNGParserCRCWorkerUpdate( parser->crcWorker, buffer, length ); }
+        else if ( PNGParser_CRC_Mode_Skip != parser->options.crcMode )
+        {
+            parser->calculatedCRC = CRC32Update( parser->calculatedCRC, buffer, length );
+        }
+        if ( !parser->regionStopped ) { result = PNGParserParseIDATChunk( parser, buffer, length ); }
+    }
+    parser->seekOffset += length;
+    parser->chunkBytesRead += length;
 
-    PNGChunk chunk;
+    if ( parser->chunkBytesRead == chunk->length ) { PNGParserReadingChunkUpdateState( parser ); }
+    else { parser->inputExhausted = TRUE; }
 
-    if ( length == 0u ) { chunk.chunkData == NULL; }
-    else { chunk.chunkData = &buffer[ PNGPARSER_CHUNK_DATA_OFFSET ]; }
+    return result;
+}
 
-    chunk.length = PNGParserGetChunkLength( buffer );
-    buffer = &buffer[ 4 ];
-    chunk.type = PNGParserGetChunkType( buffer );
-    chunk.CRC = PNGParserGetReceivedCRC( &buffer[ chunk.length + 4 ] );
-    vec_push( &parser->chunks, chunk );
-    parser->chunkCount += 1;
+PNGParserResultType PNGParserReadingChunkCheckCRC32( PNGParser* parser )
+{
+    PNGParserResultType result = PNGParser_Result_OK;
+    PNGChunk* chunk = &parser->currentChunk;
 
-    if ( chunk.type != PNGParser_Chunk_IEND && chunk.type != PNGParser_Chunk_None )
+    if ( !( chunk->flags & PNGPARSER_CHUNK_FLAG_CRC_RECEIVED ) )
     {
-        PNGParserReadingChunkUpdateState( parser );
+        const uint8_t* buffer;
+        result = PNGParserRequireBytes( parser, &parser->headerStaging, PNGPARSER_CHUNK_CRC_LENGTH, &buffer );
+        if ( PNGParser_Result_OK == result && NULL != buffer )
+        {
+            chunk->CRC = PNGParserGetReceivedCRC( buffer );
+            chunk->flags |= PNGPARSER_CHUNK_FLAG_CRC_RECEIVED;
+        }
     }
-    else if ( chunk.type == PNGParser_Chunk_IEND )
+
+    if ( PNGParser_Result_OK == result && ( chunk->flags & PNGPARSER_CHUNK_FLAG_CRC_RECEIVED ) )
     {
-        parser->readingChunkState = PNGParser_Reading_Chunk_State_None;
-        parser->state = PNGParser_State_Reading_Chunks_Done;
+        if ( PNGParserDeferCRC( parser ) ) { PNGParserCRCWorkerCheck( parser->crcWorker, chunk->CRC ); }
+        else if ( chunk->type != PNGParser_Chunk_None && PNGParser_CRC_Mode_Skip != parser->options.crcMode )
+        {
+            result = PNGParserCheckCRC( parser->calculatedCRC, chunk->CRC );
+        }
+        if ( PNGParser_Result_OK == result ) { PNGParserReadingChunkUpdateState( parser ); }
+        if ( PNGParser_Result_OK == result && parser->regionStopped ) { parser->state = PNGParser_State_Done; }
     }
-    else
+    return result;
+}
+
+PNGParserResultType PNGParserParseIHDRChunk( PNGParser* parser, const uint8_t* buffer, uint32_t length )
+{
+    PNGParserResultType result = PNGParserReadIHDR( buffer, length, &parser->imageSpec );
+    if ( PNGParser_Result_OK == result ) { result = PNGParserCheckLayout( &parser->options ); }
+    if ( PNGParser_Result_OK == result &&
+         !PNGParserGetRegion( &parser->imageSpec, &parser->options, &parser->region ) )
+    {
+        result = PNGParser_Error_Region_Outside_Image;
+    }
+    if ( PNGParser_Result_OK == result )
     {
-        parser->readingChunkState = PNGParser_Reading_Chunk_State_None;
-        parser->seekOffset += PNGPARSER_CHUNK_METADATA_LENGTH + chunk.length;
+        result = PNGParserCheckMemory( &parser->imageSpec, &parser->options, parser );
     }
+    return result;
 }
 
-PNGParserResultType PNGParserReadingChunkCheckCRC32( PNGParser* parser )
+PNGParserResultType PNGParserCheckMemory( const PNGMetadataDataType* pSpec, const PNGParserOptionsType* pOptions,
+                                          const PNGParser* parser )
 {
     PNGParserResultType result = PNGParser_Result_OK;
+    uint64_t scratchBytes, outputBytes;
+    PNGParserGetMemoryRequirements( pSpec, pOptions, &scratchBytes, &outputBytes );
 
-    uint8_t* buffer = &parser->parameters.raw_data[ parser->seekOffset ];
-
-    PNGChunk* chunk = &vec_last( &parser->chunks );
-    if ( chunk->type != PNGParser_Chunk_IEND && chunk->type != PNGParser_Chunk_None )
+    /* Rows handed to a callback one at a time only ever need one of them. */
+    if ( NULL != parser && NULL != parser->rowOutput && !PNGParserRowsNeedImage( pSpec, pOptions ) )
     {
-        result = PNGParserCheckCRC( &buffer[ PNGPARSER_CHUNK_TYPE_OFFSET ], chunk->length + PNGPARSER_CHUNK_TYPE_LENGTH,
-                                    chunk->CRC );
+        outputBytes = PNGParserGetRowBytes( pSpec, pOptions, TRUE );
     }
-    parser->seekOffset += PNGPARSER_CHUNK_METADATA_LENGTH + chunk->length;
 
+    /* Buffer sizes are 32 bit, an image that needs more can never be decoded. */
+    if ( scratchBytes > PNGPARSER_MEMORY_MAX_LENGTH || outputBytes > PNGPARSER_MEMORY_MAX_LENGTH )
+    {
+        result = PNGParser_Error_Allocating_Memory;
+    }
+    else if ( NULL != pOptions && 0u != pOptions->memoryBudget )
+    {
+        if ( NULL != parser && NULL != parser->destination ) { outputBytes = 0; }
+        if ( scratchBytes + outputBytes > pOptions->memoryBudget ) { result = PNGParser_Error_Memory_Budget; }
+    }
     return result;
 }
 
-PNGParserResultType PNGParserParseIHDRChunk( PNGParser* parser, const uint8_t* buffer )
+PNGParserResultType PNGParserReadIHDR( const uint8_t* buffer, uint32_t length, PNGMetadataDataType* pSpec )
 {
     PNGParserResultType result = PNGParser_Result_OK;
+    if ( length != PNGPARSER_IHDR_LENGTH ) { return PNGParser_Error_Corrupted_Data; }
+
     PNGChunk_IHDRType* ihdr = ( PNGChunk_IHDRType* ) buffer;
-    parser->imageSpec.width = SWAP_ENDIAN( ihdr->width );
-    parser->imageSpec.height = SWAP_ENDIAN( ihdr->height );
-    parser->imageSpec.bitDepth = ihdr->bitDepth;
-    parser->imageSpec.colorType = ihdr->colorType;
-    parser->imageSpec.compressionMethod = ihdr->compressionMethod;
-    parser->imageSpec.filterMethod = ihdr->filterMethod;
-    parser->imageSpec.interlaceMethod = ihdr->interlaceMethod;
+    pSpec->width = SWAP_ENDIAN( ihdr->width );
+    pSpec->height = SWAP_ENDIAN( ihdr->height );
+    if ( 0u == pSpec->width || 0u == pSpec->height || pSpec->width > PNGPARSER_IMAGE_MAX_DIMENSION ||
+         pSpec->height > PNGPARSER_IMAGE_MAX_DIMENSION )
+    {
+        return PNGParser_Error_Corrupted_Data;
+    }
+    pSpec->bitDepth = ihdr->bitDepth;
+    pSpec->colorType = ihdr->colorType;
+    pSpec->compressionMethod = ihdr->compressionMethod;
+    pSpec->filterMethod = ihdr->filterMethod;
+    pSpec->interlaceMethod = ihdr->interlaceMethod;
+    if ( pSpec->filterMethod != 0u || pSpec->interlaceMethod > PNGPARSER_INTERLACE_ADAM7 )
+    {
+        return PNGParser_Error_Corrupted_Data;
+    }
 
-    switch ( parser->imageSpec.colorType )
+    uint32_t bitDepths = 0;
+    switch ( pSpec->colorType )
     {
         case 0:
-            parser->imageSpec.channels = 1;
+            pSpec->channels = 1;
+            bitDepths = PNGPARSER_BIT_DEPTHS_GRAY;
             break;
         case 2:
-            parser->imageSpec.channels = 3;
+            pSpec->channels = 3;
+            bitDepths = PNGPARSER_BIT_DEPTHS_COLOR;
             break;
         case 3:
-            result = PNGParser_Error_Not_Supported_Interlaced_Image;
+            pSpec->channels = 1;
+            bitDepths = PNGPARSER_BIT_DEPTHS_PALETTE;
+            break;
         case 4:
-            parser->imageSpec.channels = 2;
+            pSpec->channels = 2;
+            bitDepths = PNGPARSER_BIT_DEPTHS_COLOR;
             break;
         case 6:
-            parser->imageSpec.channels = 4;
+            pSpec->channels = 4;
+            bitDepths = PNGPARSER_BIT_DEPTHS_COLOR;
+            break;
+        default:
             break;
     }
+    if ( pSpec->bitDepth > 16u || 0u == ( bitDepths & ( 1u << pSpec->bitDepth ) ) )
+    {
+        result = PNGParser_Error_Corrupted_Data;
+    }
     if ( PNGParser_Result_OK == result )
     {
-        parser->imageSpec.pixelStride = parser->imageSpec.channels * parser->imageSpec.bitDepth;
+        pSpec->pixelStride = pSpec->channels * pSpec->bitDepth;
 
-        if ( parser->imageSpec.compressionMethod != PNGPARSER_COMPRESSION_INFLATION_INDEX )
+        if ( pSpec->compressionMethod != PNGPARSER_COMPRESSION_INFLATION_INDEX )
         {
             result = PNGParser_Error_Wrong_Compression;
         }
-        else { parser->readingChunkState = PNGParser_Reading_Chunk_State_None; }
     }
     return result;
 }
 
-PNGParserResultType PNGParserParseIDATChunk( PNGParser* parser, uint32_t chunkID )
+uint32_t PNGParserGetOutputChannels( const PNGMetadataDataType* pSpec, const PNGParserOptionsType* pOptions,
+                                     BOOL transparency )
 {
-    PNGParserResultType result = PNGParser_Result_OK;
-
-    PNGChunk* chunk = &vec_get( &parser->chunks, chunkID );
-
-    uint8_t* checkBuffPtr = NULL;
-    if ( NULL == parser->compressedData ) { checkBuffPtr = ( uint8_t* ) PNGPARSER_MALLOC( chunk->length ); }
-    else { checkBuffPtr = PNGPARSER_REALLOC( parser->compressedData, parser->compressedLength + chunk->length ); }
-    if ( NULL != checkBuffPtr )
+    uint32_t channels = pSpec->channels;
+    if ( NULL != pOptions && PNGParser_Format_Native != pOptions->outputFormat )
     {
-        parser->compressedData = checkBuffPtr;
-        PNGPARSER_MEMCPY( &parser->compressedData[ parser->compressedLength ], chunk->chunkData, chunk->length );
-        parser->compressedLength += chunk->length;
+        channels = PNGParserGetFormatChannels( pOptions->outputFormat );
     }
-    else { result = PNGParser_Error_Allocating_Memory; }
-
-    return result;
+    else if ( PNGPARSER_COLOR_TYPE_PALETTE == pSpec->colorType )
+    {
+        PNGParserPaletteModeType mode = PNGParserGetPaletteMode( pOptions );
+        if ( PNGParser_Palette_Expand_RGBA == mode || ( PNGParser_Palette_Expand == mode && transparency ) )
+        {
+            channels = 4u;
+        }
+        else if ( PNGParser_Palette_Expand == mode ) { channels = 3u; }
+    }
+    return channels;
 }
 
-void PNGParserParseGAMMAChunk( PNGParser* parser, const uint8_t* buffer )
+uint32_t PNGParserGetOutputSampleBytes( const PNGMetadataDataType* pSpec, const PNGParserOptionsType* pOptions )
+{
+    uint32_t sampleBytes = 1u;
+    if ( 16u == pSpec->bitDepth && ( NULL == pOptions || ( PNGParser_Sixteen_Bit_Native == pOptions->sixteenBitMode &&
+                                                           PNGParser_Format_Native == pOptions->outputFormat ) ) )
+    {
+        sampleBytes = 2u;
+    }
+    return sampleBytes;
+}
+
+BOOL PNGParserIsTensor( const PNGParserOptionsType* pOptions )
+{
+    return NULL != pOptions && ( pOptions->planar || PNGParser_Sample_Integer != pOptions->sampleType );
+}
+
+uint32_t PNGParserGetElementBytes( const PNGMetadataDataType* pSpec, const PNGParserOptionsType* pOptions )
+{
+    uint32_t elementBytes = PNGParserGetOutputSampleBytes( pSpec, pOptions );
+    if ( NULL != pOptions && PNGParser_Sample_Float32 == pOptions->sampleType ) { elementBytes = 4u; }
+    if ( NULL != pOptions && PNGParser_Sample_Float16 == pOptions->sampleType ) { elementBytes = 2u; }
+    return elementBytes;
+}
+
+uint32_t PNGParserGetScaledLength( uint32_t length, const PNGParserOptionsType* pOptions )
+{
+    uint32_t shift = ( NULL != pOptions ) ? ( uint32_t ) pOptions->scale : 0u;
+    return ( uint32_t ) ( ( ( uint64_t ) length + ( 1u << shift ) - 1u ) >> shift );
+}
+
+BOOL PNGParserGetRegion( const PNGMetadataDataType* pSpec, const PNGParserOptionsType* pOptions,
+                         PNGParserRectType* pRegion )
+{
+    pRegion->x = 0;
+    pRegion->y = 0;
+    pRegion->width = pSpec->width;
+    pRegion->height = pSpec->height;
+    if ( NULL != pOptions && 0u != pOptions->region.width && 0u != pOptions->region.height )
+    {
+        /* Cut to the image, a region that starts past its edge is left empty. */
+        const PNGParserRectType* requested = &pOptions->region;
+        pRegion->x = ( requested->x < pSpec->width ) ? requested->x : pSpec->width;
+        pRegion->y = ( requested->y < pSpec->height ) ? requested->y : pSpec->height;
+        if ( requested->width < pSpec->width - pRegion->x ) { pRegion->width = requested->width; }
+        else { pRegion->width = pSpec->width - pRegion->x; }
+        if ( requested->height < pSpec->height - pRegion->y ) { pRegion->height = requested->height; }
+        else { pRegion->height = pSpec->height - pRegion->y; }
+    }
+    return 0u != pRegion->width && 0u != pRegion->height;
+}
+
+PNGParserPaletteModeType PNGParserGetPaletteMode( const PNGParserOptionsType* pOptions )
+{
+    PNGParserPaletteModeType mode = ( NULL != pOptions ) ? pOptions->paletteMode : PNGParser_Palette_Expand;
+    if ( PNGParser_Palette_Indices == mode && PNGParser_Scale_Full != pOptions->scale )
+    {
+        mode = PNGParser_Palette_Expand;
+    }
+    return mode;
+}
+
+uint64_t PNGParserGetRowBytes( const PNGMetadataDataType* pSpec, const PNGParserOptionsType* pOptions,
+                               BOOL transparency )
+{
+    PNGParserRectType region;
+    PNGParserGetRegion( pSpec, pOptions, &region );
+    return ( uint64_t ) PNGParserGetScaledLength( region.width, pOptions ) *
+           PNGParserGetOutputChannels( pSpec, pOptions, transparency ) *
+           PNGParserGetOutputSampleBytes( pSpec, pOptions );
+}
+
+uint64_t PNGParserGetOutputBytes( const PNGMetadataDataType* pSpec, const PNGParserOptionsType* pOptions,
+                                  BOOL transparency )
+{
+    PNGParserRectType region;
+    PNGParserGetRegion( pSpec, pOptions, &region );
+    uint64_t width = PNGParserGetScaledLength( region.width, pOptions );
+    uint64_t height = PNGParserGetScaledLength( region.height, pOptions );
+    if ( NULL != pOptions && PNGParser_Layout_Linear != pOptions->layout && 0u != pOptions->tileSize &&
+         !PNGParserIsTensor( pOptions ) )
+    {
+        width = ( width + pOptions->tileSize - 1u ) / pOptions->tileSize * pOptions->tileSize;
+        height = ( height + pOptions->tileSize - 1u ) / pOptions->tileSize * pOptions->tileSize;
+    }
+    return width * height * PNGParserGetOutputChannels( pSpec, pOptions, transparency ) *
+           PNGParserGetElementBytes( pSpec, pOptions );
+}
+
+uint64_t PNGParserGetScanLineBytes( const PNGMetadataDataType* pSpec, uint32_t width )
+{
+    return ( ( uint64_t ) width * pSpec->pixelStride + 7u ) / 8u;
+}
+
+uint32_t PNGParserGetPassLength( uint32_t length, uint32_t start, uint32_t step )
+{
+    return ( length > start ) ? ( length - start + step - 1u ) / step : 0u;
+}
+
+void PNGParserGetMemoryRequirements( const PNGMetadataDataType* pSpec, const PNGParserOptionsType* pOptions,
+                                     uint64_t* pScratchBytes, uint64_t* pOutputBytes )
+{
+    /* Before the chunks after IHDR are read a palette image is assumed to have a tRNS chunk, the larger case. */
+    uint64_t rowBytes = PNGParserGetRowBytes( pSpec, pOptions, TRUE );
+    uint64_t pixelBytes = ( uint64_t ) PNGParserGetOutputChannels( pSpec, pOptions, TRUE ) *
+                          PNGParserGetOutputSampleBytes( pSpec, pOptions );
+    PNGParserRectType region;
+    PNGParserGetRegion( pSpec, pOptions, &region );
+    uint32_t height = PNGParserGetScaledLength( region.height, pOptions );
+    BOOL scaled = ( NULL != pOptions && PNGParser_Scale_Full != pOptions->scale );
+
+    /* The scanline ring, the row an interlaced pass, a downscaled row or packed pixels off a byte boundary are
+     * converted in, the sums of a downscale, the rows of tiles or a tensor, the inflate state and window, and the CRC
+     * worker when it is used. */
+    *pScratchBytes = 2u * ( 1u + PNGParserGetScanLineBytes( pSpec, pSpec->width ) );
+    if ( PNGPARSER_INTERLACE_ADAM7 == pSpec->interlaceMethod || scaled ||
+         ( pSpec->pixelStride < 8u && 0u != region.x ) )
+    {
+        *pScratchBytes += pSpec->width * pixelBytes;
+    }
+    if ( scaled )
+    {
+        uint64_t sumRows = ( PNGPARSER_INTERLACE_ADAM7 == pSpec->interlaceMethod ) ? height : 1u;
+        *pScratchBytes = ( ( *pScratchBytes + 3u ) & ~( uint64_t ) 3u ) +
+                         rowBytes / PNGParserGetOutputSampleBytes( pSpec, pOptions ) * sumRows * sizeof( uint32_t );
+    }
+    if ( NULL != pOptions && ( PNGParser_Layout_Linear != pOptions->layout || PNGParserIsTensor( pOptions ) ) )
+    {
+        *pScratchBytes += PNGParserRowsNeedImage( pSpec, pOptions ) ? rowBytes * height : rowBytes;
+    }
+    *pScratchBytes += PNGParserInflateScratchBytes();
+    if ( NULL != pOptions && PNGParser_CRC_Mode_Parallel == pOptions->crcMode )
+    {
+        *pScratchBytes += PNGParserCRCWorkerSize();
+    }
+    *pOutputBytes = PNGParserGetOutputBytes( pSpec, pOptions, TRUE );
+}
+
+PNGParserResultType PNGParserParseIDATChunk( PNGParser* parser, const uint8_t* data, uint32_t length )
+{
+    PNGParserResultType result = PNGParser_Result_OK;
+
+    if ( 0u == parser->imageSpec.width ) { result = PNGParser_Error_Corrupted_Data; }
+    else if ( PNGPARSER_COLOR_TYPE_PALETTE == parser->imageSpec.colorType && 0u == parser->paletteLength )
+    {
+        result = PNGParser_Error_Corrupted_Data;
+    }
+    else if ( !parser->inflateStreamStarted ) { result = PNGParserInflateInit( parser ); }
+    if ( PNGParser_Result_OK == result ) { result = PNGParserInflateChunk( parser, data, length ); }
+
+    return result;
+}
+
+PNGParserResultType PNGParserParsePLTEChunk( PNGParser* parser, const uint8_t* buffer, uint32_t length )
+{
+    PNGParserResultType result = PNGParser_Result_OK;
+    uint32_t entries = length / PNGPARSER_PALETTE_ENTRY_LENGTH;
+
+    /* Gray images cannot have a palette, and an index can only reach 2^bitDepth entries. */
+    if ( 0u == entries || 0u != length % PNGPARSER_PALETTE_ENTRY_LENGTH || 0u != parser->paletteLength ||
+         parser->inflateStreamStarted || 0u == ( parser->imageSpec.colorType & 2u ) )
+    {
+        result = PNGParser_Error_Corrupted_Data;
+    }
+    else if ( PNGPARSER_COLOR_TYPE_PALETTE == parser->imageSpec.colorType &&
+              entries > ( 1u << parser->imageSpec.bitDepth ) )
+    {
+        result = PNGParser_Error_Corrupted_Data;
+    }
+    else
+    {
+        for ( uint32_t i = 0; i < PNGPARSER_PALETTE_MAX_ENTRIES; i++ )
+        {
+            parser->palette[ i ][ 0 ] = 0;
+            parser->palette[ i ][ 1 ] = 0;
+            parser->palette[ i ][ 2 ] = 0;
+            parser->palette[ i ][ 3 ] = 0xFF;
+        }
+        for ( uint32_t i = 0; i < entries; i++ )
+        {
+            PNGPARSER_MEMCPY( parser->palette[ i ], &buffer[ i * PNGPARSER_PALETTE_ENTRY_LENGTH ],
+                              PNGPARSER_PALETTE_ENTRY_LENGTH );
+        }
+        parser->paletteLength = entries;
+    }
+    return result;
+}
+
+PNGParserResultType PNGParserParseTRNSChunk( PNGParser* parser, const uint8_t* buffer, uint32_t length )
+{
+    PNGParserResultType result = PNGParser_Result_OK;
+
+    /* Only palette transparency is applied, the single transparent color of the other types is skipped. */
+    if ( PNGPARSER_COLOR_TYPE_PALETTE == parser->imageSpec.colorType )
+    {
+        if ( 0u == parser->paletteLength || length > parser->paletteLength || parser->paletteTransparency ||
+             parser->inflateStreamStarted )
+        {
+            result = PNGParser_Error_Corrupted_Data;
+        }
+        else
+        {
+            for ( uint32_t i = 0; i < length; i++ ) { parser->palette[ i ][ 3 ] = buffer[ i ]; }
+            parser->paletteTransparency = TRUE;
+        }
+    }
+    return result;
+}
+
+void PNGParserParseGAMMAChunk( PNGParser* parser, const uint8_t* buffer )
 {
     parser->imageSpec.gamma = SWAP_ENDIAN( UINT8_TO_UINT32( buffer[ 0 ], buffer[ 1 ], buffer[ 2 ], buffer[ 3 ] ) );
-    parser->readingChunkState = PNGParser_Reading_Chunk_State_None;
 }
 
 void PNGParserParseSRGBChunk( PNGParser* parser, const uint8_t* buffer )
 {
     parser->imageSpec.renderingIntent = buffer[ 0 ];
-    parser->readingChunkState = PNGParser_Reading_Chunk_State_None;
 }
 
 PNGParserResultType PNGParserProcessPNG( PNGParser* parser )
 {
-    PNGParserResultType result;
+    PNGParserResultType result = PNGParser_Result_OK;
 
-    result = PNGParserDecompressBuffer( parser );
-    if ( result == PNGParser_Result_OK ) { result = PNGParserFilterBuffer( parser ); }
+    if ( !parser->inflateStreamEnded || parser->passIndex != parser->passCount )
+    {
+        result = PNGParser_Error_During_Decompression;
+    }
 
     return result;
 }
 
-PNGParserResultType PNGParserDecompressBuffer( PNGParser* parser )
+PNGParserResultType PNGParserInflateInit( PNGParser* parser )
 {
+    PNGParserResultType result = PNGParser_Result_OK;
+    uint32_t imageRowStride =
+            ( uint32_t ) PNGParserGetRowBytes( &parser->imageSpec, &parser->options, parser->paletteTransparency );
+    BOOL scaled = ( PNGParser_Scale_Full != parser->options.scale );
+    BOOL tensor = ( PNGParserIsTensor( &parser->options ) && NULL == parser->rowOutput );
+    BOOL tiled = ( PNGParser_Layout_Linear != parser->options.layout && NULL == parser->rowOutput && !tensor );
+    BOOL staged = ( tiled || tensor );
+    BOOL keepRows = PNGParserRowsNeedImage( &parser->imageSpec, &parser->options );
+
+    PNGParserSetupRowConversion( parser );
+    uint32_t passRowLength = 0;
+    uint32_t stagingOffset = 0;
+    uint32_t sumsOffset = 0;
+    uint32_t sumsLength = 0;
+    parser->outputWidth = PNGParserGetScaledLength( parser->region.width, &parser->options );
+    parser->outputHeight = PNGParserGetScaledLength( parser->region.height, &parser->options );
+
+    parser->passes = &sPNGParserFullPass;
+    parser->passCount = 1;
+    if ( PNGPARSER_INTERLACE_ADAM7 == parser->imageSpec.interlaceMethod )
+    {
+        /* Passes narrower than the image are converted into a row of their own and scattered from there. */
+        parser->passes = sPNGParserAdam7Passes;
+        parser->passCount = PNGPARSER_ADAM7_PASS_COUNT;
+    }
+    if ( PNGPARSER_INTERLACE_ADAM7 == parser->imageSpec.interlaceMethod || scaled ||
+         ( parser->imageSpec.pixelStride < 8u && 0u != parser->region.x ) )
+    {
+        passRowLength = parser->imageSpec.width * parser->outputChannels * parser->outputSampleBytes;
+    }
+    parser->scanLineSlotLength =
+            1 + ( uint32_t ) PNGParserGetScanLineBytes( &parser->imageSpec, parser->imageSpec.width );
+    uint32_t scratchLength = 2u * parser->scanLineSlotLength + passRowLength;
+    if ( scaled )
+    {
+        /* The sums follow the rows, 4 byte aligned. An interlaced image revisits every output row in each pass. */
+        sumsOffset = ( scratchLength + 3u ) & ~3u;
+        sumsLength = parser->outputWidth * parser->outputChannels * ( uint32_t ) sizeof( uint32_t );
+        if ( 1u != parser->passCount ) { sumsLength *= parser->outputHeight; }
+        scratchLength = sumsOffset + sumsLength;
+    }
+    if ( staged )
+    {
+        /* The rows are formed at the end of the scratch and copied into their tiles or planes from there. */
+        stagingOffset = scratchLength;
+        scratchLength += keepRows ? imageRowStride * parser->outputHeight : imageRowStride;
+    }
+    parser->maxDecompressionLength = 0;
+    for ( uint32_t i = 0; i < parser->passCount; i++ )
+    {
+        const PNGParserPassType* pass = &parser->passes[ i ];
+        uint32_t width = PNGParserGetPassLength( parser->imageSpec.width, pass->x, pass->xStep );
+        uint32_t height = PNGParserGetPassLength( parser->imageSpec.height, pass->y, pass->yStep );
+        if ( 0u != width )
+        {
+            parser->maxDecompressionLength +=
+                    ( 1u + ( uint32_t ) PNGParserGetScanLineBytes( &parser->imageSpec, width ) ) * height;
+        }
+    }
+    parser->scanLineFilled = 0;
+    parser->currentRow = 0;
+    parser->regionDone = FALSE;
+    parser->regionStopped = FALSE;
+    parser->imageDataLength = imageRowStride * parser->outputHeight;
+    parser->outputRowStride = imageRowStride;
+    parser->layoutData = NULL;
+    parser->emitRows = ( NULL != parser->rowOutput || staged );
+    if ( staged )
+    {
+        parser->imageDataLength = ( uint32_t ) PNGParserGetOutputBytes( &parser->imageSpec, &parser->options,
+                                                                        parser->paletteTransparency );
+    }
+    if ( parser->emitRows && !keepRows )
+    {
+        /* With no distance between rows each one is written over the last, which has been handed over by then. */
+        if ( !staged ) { parser->imageDataLength = imageRowStride; }
+        parser->outputRowStride = 0;
+    }
+
+    if ( NULL != parser->destination && staged )
+    {
+        /* Tiles and tensors have no row pitch, the destination only has to hold all of them. */
+        if ( parser->imageDataLength > parser->destinationCapacity ) { result = PNGParser_Error_Output_Too_Small; }
+        else { parser->layoutData = parser->destination; }
+    }
+    else if ( NULL != parser->destination )
+    {
+        /* The last row needs no padding after it, so a tightly sized buffer with a padded pitch still fits. */
+        uint32_t rowStride = parser->destinationRowStride;
+        if ( 0u == rowStride ) { rowStride = imageRowStride; }
+        uint64_t span = ( uint64_t ) rowStride * ( parser->outputHeight - 1u ) + imageRowStride;
+        if ( rowStride < imageRowStride || span > parser->destinationCapacity )
+        {
+            result = PNGParser_Error_Output_Too_Small;
+        }
+        else
+        {
+            parser->outputData = parser->destination;
+            parser->outputRowStride = rowStride;
+            parser->imageDataLength = ( uint32_t ) span;
+        }
+    }
+
+    /* Two scanlines are enough to unfilter: the one being inflated and the one above it. */
+    if ( PNGParser_Result_OK == result )
+    {
+        result = PNGParserReserve( parser, &parser->scanLineBuffer, &parser->scanLineBufferCapacity, scratchLength );
+    }
+    if ( PNGParser_Result_OK == result && NULL == parser->destination )
+    {
+        result = PNGParserReserve( parser, &parser->imageData, &parser->imageDataCapacity, parser->imageDataLength );
+        if ( staged ) { parser->layoutData = parser->imageData; }
+        else { parser->outputData = parser->imageData; }
+    }
+    if ( PNGParser_Result_OK == result && staged )
+    {
+        parser->outputData = &parser->scanLineBuffer[ stagingOffset ];
+        if ( tiled ) { PNGParserClearTilePadding( parser ); }
+        else { PNGParserSetupTensor( parser ); }
+    }
+    if ( PNGParser_Result_OK == result )
+    {
+        PNGPARSER_MEMSET( parser->scanLineBuffer, 0, 2u * parser->scanLineSlotLength );
+        parser->scaleSums = NULL;
+        if ( scaled )
+        {
+            parser->scaleSums = ( uint32_t* ) &parser->scanLineBuffer[ sumsOffset ];
+            PNGPARSER_MEMSET( parser->scaleSums, 0, sumsLength );
+        }
+        parser->passIndex = 0;
+        PNGParserStartPass( parser );
+
+        int32_t initResult;
+        if ( parser->inflateStreamInitialized )
+        {
+            /* A kept stream only needs its state rewound, the window and tables stay allocated. */
+            initResult = inflateReset( &parser->inflateStream );
+        }
+        else
+        {
+            parser->inflateStream.zalloc = PNGParserZAlloc;
+            parser->inflateStream.zfree = PNGParserZFree;
+            parser->inflateStream.opaque = &parser->options.allocator;
+            parser->inflateStream.next_in = Z_NULL;
+            parser->inflateStream.avail_in = 0;
+
+            if ( parser->options.checkAdler32 ) { initResult = inflateInit( &parser->inflateStream ); }
+            else { initResult = inflateInit2( &parser->inflateStream, -PNGPARSER_ZLIB_MAX_WINDOW_BITS ); }
+            parser->inflateStreamInitialized = ( Z_OK == initResult );
+        }
+        if ( parser->options.checkAdler32 ) { parser->zlibHeaderLength = PNGPARSER_ZLIB_HEADER_LENGTH; }
 
+        if ( Z_MEM_ERROR == initResult ) { result = PNGParser_Error_Allocating_Memory; }
+        else if ( Z_OK != initResult ) { result = PNGParser_Error_During_Decompression; }
+        else { parser->inflateStreamStarted = TRUE; }
+    }
+    return result;
+}
+
+PNGParserResultType PNGParserInflateChunk( PNGParser* parser, const uint8_t* chunkData, uint32_t length )
+{
     PNGParserResultType result = PNGParser_Result_OK;
-    parser->maxDecompressionLength =
-            ( 1 + parser->imageSpec.width ) * parser->imageSpec.height * parser->imageSpec.channels;
-    parser->decompressedLength = parser->maxDecompressionLength;
-    if ( parser->decompressionBuffer == NULL )
+
+    if ( parser->zlibHeaderLength < PNGPARSER_ZLIB_HEADER_LENGTH )
     {
-        parser->decompressionBuffer = ( uint8_t* ) PNGPARSER_MALLOC( parser->decompressedLength );
+        result = PNGParserReadZlibHeader( parser, &chunkData, &length );
     }
-    int32_t decompressResult =
-            uncompress( ( Bytef* ) parser->decompressionBuffer, ( uLongf* ) &parser->decompressedLength,
-                        ( Bytef* ) parser->compressedData, parser->compressedLength );
 
-    if ( Z_OK != decompressResult ) { result = PNGParser_Error_During_Decompression; }
+    /* Data after the end of the zlib stream is ignored, like uncompress() did with the concatenated buffer. With a raw
+     * stream that includes the Adler-32 trailer. */
+    parser->inflateStream.next_in = ( Bytef* ) chunkData;
+    parser->inflateStream.avail_in = length;
+
+    while ( PNGParser_Result_OK == result && !parser->inflateStreamEnded && parser->inflateStream.avail_in != 0 &&
+            !parser->regionStopped )
+    {
+        /* Inflate never writes more than the rest of the current scanline. Once every row is out there is no
+         * room left, so a stream longer than the image stops with Z_BUF_ERROR instead of overrunning. */
+        uint8_t* scanLine = &parser->scanLineBuffer[ ( parser->currentRow & 1u ) * parser->scanLineSlotLength ];
+        uint32_t rowSpace = 0;
+        if ( parser->passIndex < parser->passCount )
+        {
+            rowSpace = parser->scanLineLength - parser->scanLineFilled;
+        }
+        parser->inflateStream.next_out = ( Bytef* ) &scanLine[ parser->scanLineFilled ];
+        parser->inflateStream.avail_out = rowSpace;
+
+        int32_t inflateResult = inflate( &parser->inflateStream, Z_NO_FLUSH );
+        parser->decompressedLength = parser->inflateStream.total_out;
+        parser->scanLineFilled += rowSpace - parser->inflateStream.avail_out;
+
+        if ( Z_STREAM_END == inflateResult ) { parser->inflateStreamEnded = TRUE; }
+        else if ( Z_MEM_ERROR == inflateResult ) { result = PNGParser_Error_Allocating_Memory; }
+        else if ( Z_OK != inflateResult ) { result = PNGParser_Error_During_Decompression; }
+
+        if ( PNGParser_Result_OK == result && parser->scanLineFilled == parser->scanLineLength )
+        {
+            result = PNGParserProcessScanLine( parser );
+        }
+    }
     return result;
 }
 
-uint16_t PNGParserPaethPredictor( int16_t a, int16_t b, int16_t c )
+PNGParserResultType PNGParserReadZlibHeader( PNGParser* parser, const uint8_t** pChunkData, uint32_t* pLength )
 {
-    int thresh = c * 3 - ( a + b );
-    int lo = a < b ? a : b;
-    int hi = a < b ? b : a;
-    int t0 = ( hi <= thresh ) ? lo : c;
-    int t1 = ( thresh <= lo ) ? hi : t0;
+    PNGParserResultType result = PNGParser_Result_OK;
 
-    return ( uint8_t ) t1;
+    /* The two header bytes may arrive in different IDAT chunks. */
+    while ( *pLength > 0u && parser->zlibHeaderLength < PNGPARSER_ZLIB_HEADER_LENGTH )
+    {
+        parser->zlibHeader[ parser->zlibHeaderLength ] = **pChunkData;
+        parser->zlibHeaderLength += 1u;
+        *pChunkData += 1;
+        *pLength -= 1u;
+    }
+
+    if ( parser->zlibHeaderLength == PNGPARSER_ZLIB_HEADER_LENGTH )
+    {
+        uint32_t method = parser->zlibHeader[ 0 ];
+        uint32_t flags = parser->zlibHeader[ 1 ];
+        if ( ( method & 0x0Fu ) != PNGPARSER_ZLIB_METHOD_DEFLATE ||
+             ( method >> 4 ) + 8u > ( uint32_t ) PNGPARSER_ZLIB_MAX_WINDOW_BITS || ( ( method << 8 ) | flags ) % 31u ||
+             ( flags & PNGPARSER_ZLIB_FLAG_DICTIONARY ) )
+        {
+            result = PNGParser_Error_During_Decompression;
+        }
+    }
+    return result;
+}
+
+void PNGParserInflateEnd( PNGParser* parser )
+{
+    if ( parser->inflateStreamInitialized )
+    {
+        inflateEnd( &parser->inflateStream );
+        parser->inflateStreamInitialized = FALSE;
+    }
+}
+
+PNGParserResultType PNGParserFilterRow( PNGParser* parser, uint8_t* scanLine, const uint8_t* previousScanLine )
+{
+    PNGParserResultType result = PNGParser_Result_OK;
+    uint8_t filterType = scanLine[ 0 ];
+    uint8_t* current = &scanLine[ 1 ];
+    const uint8_t* previous = &previousScanLine[ 1 ];
+    uint32_t rowStride = parser->scanLineLength - 1;
+    /* Filters work on whole bytes, pixels smaller than a byte use the byte to the left. */
+    uint32_t bytesPerPixel = ( parser->imageSpec.pixelStride + 7u ) / 8u;
+
+    PNGParserUnfilterRowFunction unfilter = NULL;
+    if ( filterType <= PNGParser_Filtering_Paeth )
+    {
+        unfilter = PNGParserGetUnfilterKernel( filterType, bytesPerPixel );
+    }
+
+    if ( NULL == unfilter ) { result = PNGParser_Error_Corrupted_Data; }
+    else { unfilter( current, previous, rowStride ); }
+    return result;
 }
 
-void PNGParserFilterCurrentByte( PNGParserFilteringType filter, uint8_t* currentByte, uint8_t up, uint8_t left,
-                                 uint8_t upleft )
+void PNGParserSetupRowConversion( PNGParser* parser )
 {
-    switch ( filter )
+    const PNGMetadataDataType* spec = &parser->imageSpec;
+    PNGParserOutputFormatType format = parser->options.outputFormat;
+    parser->rowConversion = PNGParser_Row_Copy;
+    parser->outputChannels = PNGParserGetOutputChannels( spec, &parser->options, parser->paletteTransparency );
+    parser->outputSampleBytes = PNGParserGetOutputSampleBytes( spec, &parser->options );
+
+    if ( PNGPARSER_COLOR_TYPE_PALETTE == spec->colorType )
     {
-        case PNGParser_Filtering_Sub: {
-            *currentByte += left;
+        /* Indices are never scaled. */
+        for ( uint32_t i = 0; i < PNGPARSER_SAMPLE_MAP_LENGTH; i++ ) { parser->sampleMap[ i ] = ( uint8_t ) i; }
+        if ( PNGParser_Palette_Indices != PNGParserGetPaletteMode( &parser->options ) ||
+             PNGParser_Format_Native != format )
+        {
+            parser->rowConversion = PNGParser_Row_Palette;
         }
-        break;
-        case PNGParser_Filtering_Up: {
-            *currentByte += ( uint8_t ) ( up );
+        else if ( spec->bitDepth < 8u ) { parser->rowConversion = PNGParser_Row_Unpack; }
+    }
+    else if ( spec->bitDepth < 8u )
+    {
+        /* Gray levels are scaled to the full byte range, 1 bit black and white becomes 0 and 255. */
+        uint32_t maxValue = ( 1u << spec->bitDepth ) - 1u;
+        for ( uint32_t i = 0; i < PNGPARSER_SAMPLE_MAP_LENGTH; i++ )
+        {
+            parser->sampleMap[ i ] = ( uint8_t ) ( ( i & maxValue ) * 255u / maxValue );
         }
-        break;
-        case PNGParser_Filtering_Average: {
-            *currentByte += ( uint8_t ) FLOOR( ( left + up ) / 2 );
+        /* Widened to color, the few gray levels are a palette, so the row is expanded in one pass. */
+        parser->rowConversion = ( PNGParser_Format_Native != format ) ? PNGParser_Row_Palette : PNGParser_Row_Unpack;
+    }
+    else if ( 16u == spec->bitDepth ) { parser->rowConversion = PNGParser_Row_Sixteen_Bit; }
+
+    /* Rows already in the format only need their samples narrowed or copied. */
+    if ( PNGParser_Format_Native != format && PNGParser_Row_Palette != parser->rowConversion &&
+         !( parser->outputChannels == spec->channels &&
+            ( PNGParser_Format_RGBA8 == format || PNGParser_Format_RGB8 == format ) ) )
+    {
+        parser->rowConversion = PNGParser_Row_Format;
+    }
+    if ( PNGParser_Row_Palette == parser->rowConversion ) { PNGParserSetupPaletteLookup( parser ); }
+}
+
+void PNGParserSetupPaletteLookup( PNGParser* parser )
+{
+    PNGParserOutputFormatType format = parser->options.outputFormat;
+    BOOL swap = ( PNGParser_Format_BGRA8 == format || PNGParser_Format_BGR8 == format );
+
+    for ( uint32_t i = 0; i < PNGPARSER_PALETTE_MAX_ENTRIES; i++ )
+    {
+        uint8_t entry[ 4 ];
+        if ( PNGPARSER_COLOR_TYPE_PALETTE == parser->imageSpec.colorType )
+        {
+            PNGPARSER_MEMCPY( entry, parser->palette[ i ], 4u );
         }
-        break;
-        case PNGParser_Filtering_Paeth: {
-            *currentByte += ( uint8_t ) PNGParserPaethPredictor( left, up, upleft );
+        else
+        {
+            uint8_t level = parser->sampleMap[ i % PNGPARSER_SAMPLE_MAP_LENGTH ];
+            entry[ 0 ] = level;
+            entry[ 1 ] = level;
+            entry[ 2 ] = level;
+            entry[ 3 ] = 0xFFu;
         }
-        break;
+        parser->paletteLookup[ i ][ 0 ] = entry[ swap ? 2 : 0 ];
+        parser->paletteLookup[ i ][ 1 ] = entry[ 1 ];
+        parser->paletteLookup[ i ][ 2 ] = entry[ swap ? 0 : 2 ];
+        parser->paletteLookup[ i ][ 3 ] = entry[ 3 ];
+    }
+}
+
+void PNGParserConvertRow( PNGParser* parser, uint8_t* output, const uint8_t* row, uint32_t count )
+{
+    uint32_t samples = count * parser->imageSpec.channels;
+    switch ( parser->rowConversion )
+    {
+        case PNGParser_Row_Unpack:
+            PNGParserGetUnpackKernel( parser->imageSpec.bitDepth )( output, row, samples, parser->sampleMap );
+            break;
+        case PNGParser_Row_Sixteen_Bit:
+            PNGParserGetSixteenBitKernel( ( 1u == parser->outputSampleBytes ) ? PNGParser_Sixteen_Bit_Narrow
+                                                                              : PNGParser_Sixteen_Bit_Native )(
+                    output, row, samples );
+            break;
+        case PNGParser_Row_Palette:
+            if ( parser->imageSpec.bitDepth < 8u )
+            {
+                /* Packed indices are unpacked into the end of the output row and expanded forward from there, which
+                 * needs no extra row buffer. */
+                uint8_t* indices = &output[ ( parser->outputChannels - 1u ) * count ];
+                PNGParserGetUnpackKernel( parser->imageSpec.bitDepth )( indices, row, count, parser->sampleMap );
+                row = indices;
+            }
+            PNGParserGetPaletteKernel( parser->outputChannels )( output, row, count,
+                                                                 &parser->paletteLookup[ 0 ][ 0 ] );
+            break;
+        case PNGParser_Row_Format:
+            PNGParserGetFormatKernel( parser->imageSpec.bitDepth / 8u, parser->imageSpec.channels,
+                                      parser->options.outputFormat )( output, row, count );
+            break;
         default:
+            PNGPARSER_MEMCPY( output, row, samples );
             break;
     }
 }
 
-void PNGParserGetNeighbourBytes( const uint8_t* data, uint32_t index, uint32_t offset, uint32_t row, uint32_t rowStride,
-                                 uint32_t channels, uint8_t* up, uint8_t* left, uint8_t* upleft )
+PNGParserResultType PNGParserProcessScanLine( PNGParser* parser )
+{
+    uint32_t row = parser->currentRow;
+    uint8_t* scanLine = &parser->scanLineBuffer[ ( row & 1u ) * parser->scanLineSlotLength ];
+    const uint8_t* previousScanLine = &parser->scanLineBuffer[ ( ( row + 1u ) & 1u ) * parser->scanLineSlotLength ];
+
+    /* The row is unfiltered in place, so it becomes the reference row for the next one. */
+    PNGParserResultType result = PNGParserFilterRow( parser, scanLine, previousScanLine );
+    if ( PNGParser_Result_OK == result )
+    {
+        if ( row >= parser->regionRow && row < parser->regionRowEnd && 0u != parser->regionColumns )
+        {
+            PNGParserOutputRow( parser, &scanLine[ 1 ] );
+        }
+
+        parser->currentRow += 1;
+        parser->scanLineFilled = 0;
+        parser->regionDone = PNGParserIsRegionDone( parser );
+        if ( parser->regionDone && 1u != parser->passCount )
+        {
+            if ( PNGParser_Scale_Full != parser->options.scale ) { PNGParserAverageRegion( parser ); }
+            else if ( parser->emitRows )
+            {
+                for ( uint32_t y = 0; y < parser->outputHeight; y++ ) { PNGParserEmitRow( parser, y ); }
+            }
+        }
+        if ( NULL != parser->options.progress ) { PNGParserReportProgress( parser ); }
+
+        if ( parser->regionDone && !( parser->currentRow == parser->passHeight && PNGParserIsLastPass( parser ) ) )
+        {
+            /* Nothing after the region is needed, so the stream is dropped here instead of being inflated to its
+             * end. The rest of the current chunk is still run through its CRC, which also covers the bytes the
+             * pixels came from, and the decode is done once that is checked. Later chunks are not read. */
+            parser->passIndex = parser->passCount;
+            parser->regionStopped = TRUE;
+            if ( PNGParser_CRC_Mode_Skip == parser->options.crcMode ) { parser->state = PNGParser_State_Done; }
+        }
+        else if ( parser->currentRow == parser->passHeight )
+        {
+            parser->passIndex += 1;
+            PNGParserStartPass( parser );
+        }
+    }
+    return result;
+}
+
+void PNGParserOutputRow( PNGParser* parser, const uint8_t* scanLine )
+{
+    const PNGParserPassType* pass = &parser->passes[ parser->passIndex ];
+    uint32_t pixelBytes = parser->outputChannels * parser->outputSampleBytes;
+    uint8_t* passRow = &parser->scanLineBuffer[ 2u * parser->scanLineSlotLength ];
+    uint32_t x = pass->x + parser->regionColumn * pass->xStep - parser->region.x;
+    uint32_t y = pass->y + parser->currentRow * pass->yStep - parser->region.y;
+
+    /* Packed pixels are converted from the start of the byte holding the first one, the lead pixels before it are
+     * dropped afterwards. */
+    uint32_t lead = 0;
+    if ( parser->imageSpec.pixelStride < 8u )
+    {
+        lead = parser->regionColumn & ( 8u / parser->imageSpec.pixelStride - 1u );
+    }
+    const uint8_t* pixels =
+            &scanLine[ ( size_t ) ( parser->regionColumn - lead ) * parser->imageSpec.pixelStride / 8u ];
+
+    if ( PNGParser_Scale_Full != parser->options.scale ) { PNGParserScaleRow( parser, x, y, pixels, lead ); }
+    else
+    {
+        uint8_t* output = &parser->outputData[ ( size_t ) y * parser->outputRowStride + ( size_t ) x * pixelBytes ];
+
+        /* A pass row lands in a single image row, so the scatter walks the image in memory order instead of
+         * keeping the reduced images around. */
+        if ( 1u == pass->xStep && 0u == lead ) { PNGParserConvertRow( parser, output, pixels, parser->regionColumns ); }
+        else
+        {
+            PNGParserConvertRow( parser, passRow, pixels, lead + parser->regionColumns );
+            PNGParserScatterPixels( output, &passRow[ lead * pixelBytes ], parser->regionColumns, pixelBytes,
+                                    pass->xStep );
+        }
+        if ( parser->emitRows && 1u == parser->passCount ) { PNGParserEmitRow( parser, y ); }
+    }
+}
+
+void PNGParserReportProgress( PNGParser* parser )
+{
+    PNGParserProgressType progress;
+    uint32_t bandRows = ( 0u != parser->options.progressRows ) ? parser->options.progressRows : 1u;
+    BOOL passDone = ( parser->currentRow == parser->passHeight );
+    BOOL scaled = ( PNGParser_Scale_Full != parser->options.scale );
+
+    if ( 1u == parser->passCount )
+    {
+        /* Downscaled rows are done once their whole block of rows is in. */
+        uint32_t doneRows = 0;
+        if ( parser->regionDone ) { doneRows = parser->outputHeight; }
+        else if ( parser->currentRow > parser->region.y )
+        {
+            doneRows = ( parser->currentRow - parser->region.y ) >> parser->options.scale;
+        }
+        if ( !parser->regionDone && doneRows - parser->progressRow < bandRows ) { return; }
+        progress.pass = 0;
+        progress.firstRow = parser->progressRow;
+        progress.rowCount = doneRows - parser->progressRow;
+        parser->progressRow = doneRows;
+    }
+    else
+    {
+        /* A downscaled interlaced image is only averaged once the last pass reaching into the region is in. */
+        if ( scaled ? !parser->regionDone : !( passDone || parser->regionDone ) ) { return; }
+        /* Pass 1 is never empty, it holds the top left pixel. Its blocks line up with a region on the 8 pixel
+         * grid, any other region gets no preview. */
+        if ( 0u == parser->passIndex && !scaled && 0u == ( ( parser->region.x | parser->region.y ) & 7u ) )
+        {
+            PNGParserFillPreview( parser );
+        }
+        progress.pass = parser->passIndex + 1u;
+        progress.firstRow = 0;
+        progress.rowCount = parser->outputHeight;
+    }
+    progress.data = NULL;
+    progress.rowStride = 0;
+    if ( !parser->emitRows )
+    {
+        progress.data = &parser->outputData[ ( size_t ) progress.firstRow * parser->outputRowStride ];
+        progress.rowStride = parser->outputRowStride;
+    }
+    parser->options.progress( parser->options.progressContext, &progress );
+}
+
+void PNGParserFillPreview( PNGParser* parser )
 {
-    offset += index;
-    if ( index >= channels )
+    /* Every pixel of pass 1 is copied over its 8x8 block. The later passes overwrite the copies with their own
+     * pixels, so nothing has to be undone. */
+    const PNGParserPassType* pass = &parser->passes[ 0 ];
+    uint32_t pixelBytes = parser->outputChannels * parser->outputSampleBytes;
+    uint32_t width = parser->outputWidth;
+    uint32_t height = parser->outputHeight;
+    uint32_t rowBytes = width * pixelBytes;
+
+    for ( uint32_t y = 0; y < height; y += pass->yStep )
     {
-        *left = data[ offset - channels ];
-        if ( row != 0 ) { *upleft = data[ ( offset - rowStride ) - channels ]; }
+        uint8_t* row = &parser->outputData[ ( size_t ) y * parser->outputRowStride ];
+        for ( uint32_t x = 0; x < width; x += pass->xStep )
+        {
+            /* The filled part doubles with every copy. */
+            for ( uint32_t filled = 1; filled < pass->xStep && x + filled < width; filled *= 2u )
+            {
+                uint32_t count = filled;
+                if ( count > width - x - filled ) { count = width - x - filled; }
+                PNGPARSER_MEMCPY( &row[ ( x + filled ) * pixelBytes ], &row[ x * pixelBytes ], count * pixelBytes );
+            }
+        }
+        for ( uint32_t i = 1; i < pass->yStep && y + i < height; i++ )
+        {
+            PNGPARSER_MEMCPY( &row[ ( size_t ) i * parser->outputRowStride ], row, rowBytes );
+        }
     }
-    if ( row != 0 ) { *up = data[ ( offset - rowStride ) ]; }
 }
 
-void PNGParserFilterRow( PNGParser* parser, uint32_t imageDataOffset, uint32_t scanLineOffset, uint32_t rowStride,
-                         uint32_t row )
+void PNGParserScaleRow( PNGParser* parser, uint32_t x, uint32_t y, const uint8_t* pixels, uint32_t lead )
 {
-    uint8_t filterType = parser->decompressionBuffer[ scanLineOffset ];
-    PNGPARSER_MEMCPY( &parser->imageData[ imageDataOffset ], &parser->decompressionBuffer[ scanLineOffset + 1 ],
-                      rowStride );
-    uint8_t left = 0, up = 0, upleft = 0;
+    const PNGParserPassType* pass = &parser->passes[ parser->passIndex ];
+    uint8_t* passRow = &parser->scanLineBuffer[ 2u * parser->scanLineSlotLength ];
+    uint32_t pixelBytes = parser->outputChannels * parser->outputSampleBytes;
+    uint32_t shift = ( uint32_t ) parser->options.scale;
+    uint32_t sumsLength = parser->outputWidth * parser->outputChannels;
+    uint32_t* sums = parser->scaleSums;
+
+    /* A plain image sums one band of rows at a time and writes it out when the band is complete. */
+    if ( 1u != parser->passCount ) { sums = &sums[ ( size_t ) ( y >> shift ) * sumsLength ]; }
+    PNGParserConvertRow( parser, passRow, pixels, lead + parser->regionColumns );
+    PNGParserAccumulatePixels( sums, &passRow[ lead * pixelBytes ], parser->regionColumns, parser->outputChannels,
+                               parser->outputSampleBytes, x, pass->xStep, shift );
+
+    if ( 1u == parser->passCount &&
+         ( 0u == ( ( y + 1u ) & ( ( 1u << shift ) - 1u ) ) || y + 1u == parser->region.height ) )
+    {
+        PNGParserAveragePixels( &parser->outputData[ ( size_t ) ( y >> shift ) * parser->outputRowStride ], sums,
+                                parser->outputWidth, parser->outputChannels, parser->outputSampleBytes,
+                                parser->region.width, shift, ( y & ( ( 1u << shift ) - 1u ) ) + 1u );
+        if ( parser->emitRows ) { PNGParserEmitRow( parser, y >> shift ); }
+    }
+}
 
-    for ( uint32_t i = 0; i < rowStride; i++ )
+void PNGParserAverageRegion( PNGParser* parser )
+{
+    /* An interlaced image revisits every output row in each pass, so its sums are averaged all at once at the end. */
+    uint32_t shift = ( uint32_t ) parser->options.scale;
+    uint32_t sumsLength = parser->outputWidth * parser->outputChannels;
+    for ( uint32_t i = 0; i < parser->outputHeight; i++ )
     {
-        PNGParserGetNeighbourBytes( parser->imageData, i, imageDataOffset, row, rowStride, parser->imageSpec.channels,
-                                    &up, &left, &upleft );
+        uint32_t rows = parser->region.height - ( i << shift );
+        if ( rows > ( 1u << shift ) ) { rows = 1u << shift; }
+        PNGParserAveragePixels( &parser->outputData[ ( size_t ) i * parser->outputRowStride ],
+                                &parser->scaleSums[ ( size_t ) i * sumsLength ], parser->outputWidth,
+                                parser->outputChannels, parser->outputSampleBytes, parser->region.width, shift, rows );
+        if ( parser->emitRows ) { PNGParserEmitRow( parser, i ); }
+    }
+}
+
+void PNGParserEmitRow( PNGParser* parser, uint32_t y )
+{
+    PNGParserRowType row;
+    row.data = &parser->outputData[ ( size_t ) y * parser->outputRowStride ];
+    row.row = y;
+    row.width = parser->outputWidth;
+    row.channels = parser->outputChannels;
+    row.bytesPerSample = parser->outputSampleBytes;
+    if ( NULL == parser->layoutData ) { parser->rowOutput( parser->rowOutputContext, &row ); }
+    else if ( PNGParserIsTensor( &parser->options ) ) { PNGParserTensorRow( parser, y, row.data ); }
+    else { PNGParserTileRow( parser, y, row.data ); }
+}
+
+void PNGParserTileRow( PNGParser* parser, uint32_t y, const uint8_t* row )
+{
+    uint32_t size = parser->options.tileSize;
+    uint32_t pixelBytes = parser->outputChannels * parser->outputSampleBytes;
+    size_t tileBytes = ( size_t ) size * size * pixelBytes;
+    size_t tileRowBytes = ( size_t ) ( ( parser->outputWidth + size - 1u ) / size ) * tileBytes;
+    uint8_t* tile = &parser->layoutData[ ( y / size ) * tileRowBytes ];
+
+    /* The row crosses one row of tiles, each gets the part of the row inside it. */
+    for ( uint32_t x = 0; x < parser->outputWidth; x += size, tile += tileBytes )
+    {
+        uint32_t count = parser->outputWidth - x;
+        if ( count > size ) { count = size; }
+        if ( PNGParser_Layout_Morton == parser->options.layout )
+        {
+            PNGParserSwizzlePixels( tile, &row[ ( size_t ) x * pixelBytes ], count, pixelBytes, y % size );
+        }
+        else
+        {
+            PNGPARSER_MEMCPY( &tile[ ( size_t ) ( y % size ) * size * pixelBytes ], &row[ ( size_t ) x * pixelBytes ],
+                              ( size_t ) count * pixelBytes );
+        }
+    }
+}
+
+void PNGParserClearTilePadding( PNGParser* parser )
+{
+    /* Only the last row and column of tiles can reach past the output, everything else is written by the rows. */
+    uint32_t size = parser->options.tileSize;
+    size_t tileBytes = ( size_t ) size * size * parser->outputChannels * parser->outputSampleBytes;
+    uint32_t tilesX = ( parser->outputWidth + size - 1u ) / size;
+    uint32_t tilesY = ( parser->outputHeight + size - 1u ) / size;
+    if ( 0u != parser->outputHeight % size )
+    {
+        PNGPARSER_MEMSET( &parser->layoutData[ ( size_t ) ( tilesY - 1u ) * tilesX * tileBytes ], 0,
+                          tilesX * tileBytes );
+    }
+    if ( 0u != parser->outputWidth % size )
+    {
+        for ( uint32_t i = 0; i < tilesY; i++ )
+        {
+            PNGPARSER_MEMSET( &parser->layoutData[ ( ( size_t ) i * tilesX + tilesX - 1u ) * tileBytes ], 0,
+                              tileBytes );
+        }
+    }
+}
 
-        PNGParserFilterCurrentByte( filterType, &parser->imageData[ imageDataOffset + i ], up, left, upleft );
+void PNGParserTensorRow( PNGParser* parser, uint32_t y, const uint8_t* row )
+{
+    /* Planes hold one sample of every pixel, interleaved rows all of them. */
+    uint32_t elementBytes = PNGParserGetElementBytes( &parser->imageSpec, &parser->options );
+    size_t rowBytes = ( size_t ) parser->outputWidth * elementBytes;
+    if ( !parser->options.planar ) { rowBytes *= parser->outputChannels; }
+    size_t planeBytes = ( size_t ) parser->outputWidth * parser->outputHeight * elementBytes;
+    PNGParserTensorRowFunction kernel = PNGParserGetTensorKernel( parser->outputSampleBytes, parser->outputChannels,
+                                                                  parser->options.planar, parser->options.sampleType );
+    kernel( &parser->layoutData[ y * rowBytes ], planeBytes, row, parser->outputWidth, parser->tensorScale,
+            parser->tensorBias );
+}
+
+void PNGParserSetupTensor( PNGParser* parser )
+{
+    /* The maximum sample is folded into the scale, so the kernels only multiply and add. */
+    float maximum = ( 2u == parser->outputSampleBytes ) ? 65535.0f : 255.0f;
+    for ( uint32_t k = 0; k < PNGPARSER_TENSOR_PATTERN_LENGTH; k++ )
+    {
+        uint32_t c = k % parser->outputChannels;
+        parser->tensorScale[ k ] = parser->options.sampleScale[ c ] / maximum;
+        parser->tensorBias[ k ] = parser->options.sampleBias[ c ];
     }
 }
 
-PNGParserResultType PNGParserFilterBuffer( PNGParser* parser )
+BOOL PNGParserIsLastPass( const PNGParser* parser )
 {
+    /* The later passes of a small image can all be empty. */
+    for ( uint32_t i = parser->passIndex + 1u; i < parser->passCount; i++ )
+    {
+        const PNGParserPassType* pass = &parser->passes[ i ];
+        if ( 0u != PNGParserGetPassLength( parser->imageSpec.width, pass->x, pass->xStep ) &&
+             0u != PNGParserGetPassLength( parser->imageSpec.height, pass->y, pass->yStep ) )
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
 
-    parser->imageDataLength = parser->imageSpec.channels * parser->imageSpec.width * parser->imageSpec.height;
-    if ( NULL == parser->imageData ) { parser->imageData = ( uint8_t* ) PNGPARSER_MALLOC( parser->imageDataLength ); }
-    PNGPARSER_MEMSET( parser->imageData, 0, parser->imageDataLength );
+BOOL PNGParserIsRegionDone( const PNGParser* parser )
+{
+    /* The pixels of a pass inside the region are those before its end minus those before its start. */
+    const PNGParserRectType* region = &parser->region;
+    uint32_t nextRow = ( parser->currentRow > parser->regionRow ) ? parser->currentRow : parser->regionRow;
+    if ( nextRow < parser->regionRowEnd && 0u != parser->regionColumns ) { return FALSE; }
 
-    uint32_t imageRowStride = parser->imageSpec.width * parser->imageSpec.channels;
-    uint32_t scanLineWidth = imageRowStride + 1;
-    uint32_t offset = 0, scanLineOffset = 0;
+    for ( uint32_t i = parser->passIndex + 1u; i < parser->passCount; i++ )
+    {
+        const PNGParserPassType* pass = &parser->passes[ i ];
+        if ( PNGParserGetPassLength( region->x + region->width, pass->x, pass->xStep ) !=
+                     PNGParserGetPassLength( region->x, pass->x, pass->xStep ) &&
+             PNGParserGetPassLength( region->y + region->height, pass->y, pass->yStep ) !=
+                     PNGParserGetPassLength( region->y, pass->y, pass->yStep ) )
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
 
-    for ( uint32_t row = 0; row < parser->imageSpec.height; row++ )
+void PNGParserStartPass( PNGParser* parser )
+{
+    /* Passes without pixels have no scanlines in the stream at all, not even filter bytes. */
+    while ( parser->passIndex < parser->passCount )
     {
-        PNGParserFilterRow( parser, offset, scanLineOffset, imageRowStride, row );
+        const PNGParserPassType* pass = &parser->passes[ parser->passIndex ];
+        parser->passWidth = PNGParserGetPassLength( parser->imageSpec.width, pass->x, pass->xStep );
+        parser->passHeight = PNGParserGetPassLength( parser->imageSpec.height, pass->y, pass->yStep );
+        if ( 0u != parser->passWidth && 0u != parser->passHeight ) { break; }
+        parser->passIndex += 1;
+    }
 
-        offset += imageRowStride;
-        scanLineOffset += scanLineWidth;
+    if ( parser->passIndex < parser->passCount )
+    {
+        const PNGParserPassType* pass = &parser->passes[ parser->passIndex ];
+        const PNGParserRectType* region = &parser->region;
+        parser->scanLineLength = 1u + ( uint32_t ) PNGParserGetScanLineBytes( &parser->imageSpec, parser->passWidth );
+        parser->regionColumn = PNGParserGetPassLength( region->x, pass->x, pass->xStep );
+        parser->regionColumns =
+                PNGParserGetPassLength( region->x + region->width, pass->x, pass->xStep ) - parser->regionColumn;
+        parser->regionRow = PNGParserGetPassLength( region->y, pass->y, pass->yStep );
+        parser->regionRowEnd = PNGParserGetPassLength( region->y + region->height, pass->y, pass->yStep );
+        parser->currentRow = 0;
+        parser->scanLineFilled = 0;
+
+        /* The first row of every pass is unfiltered against zeros. */
+        PNGPARSER_MEMSET( &parser->scanLineBuffer[ parser->scanLineSlotLength ], 0, parser->scanLineLength );
     }
-    PNGPARSER_FREE( parser->compressedData, parser->compressedLength );
-    PNGPARSER_FREE( parser->decompressionBuffer, parser->decompressedLength );
-    return PNGParser_Result_OK;
 }
 
-PNGParserResultType PNGParserCheckCRC( uint8_t* buffer, uint32_t length, uint32_t receivedCRC )
+PNGParserResultType PNGParserCheckCRC( uint32_t calculatedCRC, uint32_t receivedCRC )
 {
-    uint32_t calculatedCRC = CRC32( buffer, length );
     if ( calculatedCRC != receivedCRC ) { return PNGParser_Error_Corrupted_Data; }
     else { return PNGParser_Result_OK; }
 }
 
-PNGParserResultType PNGParserProcessChunks( PNGParser* parser )
+BOOL PNGParserDeferCRC( PNGParser* parser )
+{
+    /* Only image data is worth a round trip to the worker, the small chunks are checked before they are used. */
+    if ( PNGParser_CRC_Mode_Parallel != parser->options.crcMode ||
+         parser->currentChunk.type != PNGParser_Chunk_IDAT )
+    {
+        return FALSE;
+    }
+    if ( NULL == parser->crcWorker )
+    {
+        parser->crcWorker = PNGParserCRCWorkerCreate( &parser->options.allocator );
+        if ( NULL == parser->crcWorker ) { parser->options.crcMode = PNGParser_CRC_Mode_Full; }
+    }
+    return NULL != parser->crcWorker;
+}
+
+PNGParserResultType PNGParserWaitCRC( PNGParser* parser )
+{
+    if ( NULL == parser->crcWorker ) { return PNGParser_Result_OK; }
+    else { return PNGParserCRCWorkerWait( parser->crcWorker ); }
+}
+
+PNGParserResultType PNGParserProcessChunk( PNGParser* parser )
 {
     PNGParserResultType result = PNGParser_Result_OK;
+    PNGChunk* chunk = &parser->currentChunk;
 
-    for ( uint32_t i = 0; i < parser->chunkCount && result == PNGParser_Result_OK; i++ )
-    {
-        PNGChunk* chunk = &vec_get( &parser->chunks, i );
-
-        switch ( chunk->type )
-        {
-            case PNGParser_Chunk_IHDR:
-                result = PNGParserParseIHDRChunk( parser, chunk->chunkData );
-                break;
-            case PNGParser_Chunk_IDAT:
-                result = PNGParserParseIDATChunk( parser, i );
-                break;
-            case PNGParser_Chunk_PLTE:
-                result = PNGParser_Error_General;
-                break;
-            case PNGParser_Chunk_GAMMA:
-                PNGParserParseGAMMAChunk( parser, chunk->chunkData );
-                break;
-            case PNGParser_Chunk_SRGB:
-                PNGParserParseSRGBChunk( parser, chunk->chunkData );
-                break;
-            case PNGParser_Chunk_IEND:
-                result = PNGParserProcessPNG( parser );
-                break;
-            default:
-                break;
-        }
-    }
-    if ( PNGParser_Result_OK == result ) { PNGParserUpdateState( parser ); }
+    switch ( chunk->type )
+    {
+        case PNGParser_Chunk_IHDR:
+            result = PNGParserParseIHDRChunk( parser, chunk->chunkData, chunk->length );
+            break;
+        case PNGParser_Chunk_PLTE:
+            result = PNGParserParsePLTEChunk( parser, chunk->chunkData, chunk->length );
+            break;
+        case PNGParser_Chunk_TRNS:
+            result = PNGParserParseTRNSChunk( parser, chunk->chunkData, chunk->length );
+            break;
+        case PNGParser_Chunk_GAMMA:
+            if ( chunk->length != PNGPARSER_GAMMA_LENGTH ) { result = PNGParser_Error_Corrupted_Data; }
+            else { PNGParserParseGAMMAChunk( parser, chunk->chunkData ); }
+            break;
+        case PNGParser_Chunk_SRGB:
+            if ( chunk->length != PNGPARSER_SRGB_LENGTH ) { result = PNGParser_Error_Corrupted_Data; }
+            else { PNGParserParseSRGBChunk( parser, chunk->chunkData ); }
+            break;
+        default:
+            break;
+    }
     return result;
 }
\ No newline at end of file
@@ -50,18 +50,226 @@ Includes
  */
 extern PNGParserResultType PNGParse( uint8_t* data, uint32_t length, PNGImage* pImage );
 /**
- * @brief Frees the pImage memory that is allocated.
+ * @brief Same as PNGParse, with the decoding options.
+ * @param data 
+ * @param length 
+ * @param pImage 
+ * @param pOptions Options, NULL for the defaults
+ * @return Parse result code, PNGParser_Error_Memory_Budget before anything is allocated for an image that would need
+ *         more than pOptions->memoryBudget
+ */
+extern PNGParserResultType PNGParseWithOptions( uint8_t* data, uint32_t length, PNGImage* pImage,
+                                                const PNGParserOptionsType* pOptions );
+/**
+ * @brief Parses the image buffer and writes the pixels straight into the caller's buffer, nothing is allocated for
+ *        the image. pImage->data points at destination once the decode succeeds.
+ * @param data 
+ * @param length 
+ * @param pImage 
+ * @param destination 
+ * @param capacity Bytes available at destination
+ * @param rowStride Distance between the starts of two rows, 0 for rows packed back to back, unused by tiles and
+ *                  tensors
+ * @param pOptions Options, NULL for the defaults
+ * @return Parse result code, PNGParser_Error_Output_Too_Small if a row or the image does not fit
+ */
+extern PNGParserResultType PNGParseInto( uint8_t* data, uint32_t length, PNGImage* pImage, uint8_t* destination,
+                                         uint32_t capacity, uint32_t rowStride, const PNGParserOptionsType* pOptions );
+/**
+ * @brief Parses the image buffer and hands every finished output row to rowOutput instead of keeping the image. Only
+ *        one output row is allocated, except for an interlaced image at full scale, which is kept until its last
+ *        pass. pImage describes the output, its data is NULL.
+ * @param data 
+ * @param length 
+ * @param pImage 
+ * @param rowOutput Called with each row in order
+ * @param context Passed to rowOutput
+ * @param pOptions Options, NULL for the defaults
+ * @return Parse result code, rows handed over before an error stay handed over
+ */
+extern PNGParserResultType PNGParseRows( uint8_t* data, uint32_t length, PNGImage* pImage,
+                                         PNGParserRowFunction rowOutput, void* context,
+                                         const PNGParserOptionsType* pOptions );
+/**
+ * @brief Reads only the signature and IHDR, without allocating. The chunk CRC is checked unless the options skip
+ *        CRCs. pProbe->outputBytes is the size of the packed image and pProbe->scratchBytes what PNGParse, PNGParseInto
+ *        and a decoder allocate besides it at their peak, the push API adds the parts of chunks split between pieces.
+ *        An expanded palette image is counted as RGBA, it comes out as RGB when it turns out to have no tRNS chunk.
+ * @param data Start of the file, at least the first 33 bytes
+ * @param length 
+ * @param pProbe 
+ * @param pOptions Options the decode would use, NULL for the defaults
+ * @return Parse result code, PNGParser_Error_Memory_Budget if the image and scratch exceed pOptions->memoryBudget,
+ *         PNGParser_Error_Region_Outside_Image if pOptions->region starts past the image. The probe is filled in
+ *         either way.
+ */
+extern PNGParserResultType PNGParseHeader( const uint8_t* data, uint32_t length, PNGProbe* pProbe,
+                                           const PNGParserOptionsType* pOptions );
+/**
+ * @brief Fills the options PNGParse uses.
+ * @param pOptions 
+ */
+extern void PNGParserGetDefaultOptions( PNGParserOptionsType* pOptions );
+/**
+ * @brief Fills the allocator the options default to, PNGPARSER_MALLOC, PNGPARSER_REALLOC and PNGPARSER_FREE.
+ * @param pAllocator 
+ */
+extern void PNGParserGetDefaultAllocator( PNGParserAllocatorType* pAllocator );
+/**
+ * @brief Sets up a bump pointer arena over memory the caller owns. Blocks are handed out in order and only come back
+ *        all at once with PNGParserArenaReset, so one reset frees every temporary of a decode.
+ * @param arena 
+ * @param memory 
+ * @param capacity 
+ */
+extern void PNGParserArenaInit( PNGParserArenaType* arena, void* memory, uint32_t capacity );
+/**
+ * @brief Gives back everything allocated from the arena.
+ * @param arena 
+ */
+extern void PNGParserArenaReset( PNGParserArenaType* arena );
+/**
+ * @brief Fills an allocator that allocates from the arena. Decodes fail with PNGParser_Error_Allocating_Memory when
+ *        the arena runs out.
+ * @param arena 
+ * @param pAllocator 
+ */
+extern void PNGParserGetArenaAllocator( PNGParserArenaType* arena, PNGParserAllocatorType* pAllocator );
+/**
+ * @brief Creates a parser for data that arrives in pieces.
+ * @return Parser handle, NULL if it could not be allocated
+ */
+extern PNGParser* PNGParserCreate( void );
+/**
+ * @brief Same as PNGParserCreate, with the decoding options.
+ * @param pOptions Options, NULL for the defaults
+ * @return Parser handle, NULL if it could not be allocated
+ */
+extern PNGParser* PNGParserCreateWithOptions( const PNGParserOptionsType* pOptions );
+/**
+ * @brief Makes the parser write the pixels into the caller's buffer, as PNGParseInto does. Has to be called before
+ *        the image data starts arriving.
+ * @param parser 
+ * @param destination 
+ * @param capacity Bytes available at destination
+ * @param rowStride Distance between the starts of two rows, 0 for rows packed back to back, unused by tiles and
+ *                  tensors
+ */
+extern void PNGParserSetOutput( PNGParser* parser, uint8_t* destination, uint32_t capacity, uint32_t rowStride );
+/**
+ * @brief Makes the parser hand the rows to rowOutput, as PNGParseRows does. Has to be called before the image data
+ *        starts arriving.
+ * @param parser 
+ * @param rowOutput 
+ * @param context Passed to rowOutput
+ */
+extern void PNGParserSetRowOutput( PNGParser* parser, PNGParserRowFunction rowOutput, void* context );
+/**
+ * @brief Feeds the next piece of the file to the parser. Chunks split between pieces are
+ *        kept by the parser, so data can be fed in any size. With PNGParser_CRC_Mode_Parallel the call waits for the
+ *        CRCs of the piece before returning, the data is only overlapped with inflate within a piece.
+ * @param parser 
+ * @param data 
+ * @param length 
+ * @return Parse result code so far
+ */
+extern PNGParserResultType PNGParserFeed( PNGParser* parser, uint8_t* data, uint32_t length );
+/**
+ * @brief Puts the result into pImage and frees the parser.
+ * @param parser 
+ * @param pImage 
+ * @return Parse result code, PNGParser_Error_Buffer_Length if the file ended early
+ */
+extern PNGParserResultType PNGParserFinish( PNGParser* parser, PNGImage* pImage );
+/**
+ * @brief Creates a decoder that keeps its zlib state and buffers between images, so decoding many images does no
+ *        allocations once the buffers have grown to the largest image.
+ * @param pOptions Options, NULL for the defaults
+ * @return Decoder handle, NULL if it could not be allocated
+ */
+extern PNGDecoder* PNGDecoderCreate( const PNGParserOptionsType* pOptions );
+/**
+ * @brief Parses the image buffer with the decoder. pImage->data belongs to the decoder and stays valid until the next
+ *        decode or PNGDecoderDestroy, it must not be passed to PNGImageFree.
+ * @param decoder 
+ * @param data 
+ * @param length 
+ * @param pImage 
+ * @return Parse result code
+ */
+extern PNGParserResultType PNGDecoderDecode( PNGDecoder* decoder, uint8_t* data, uint32_t length, PNGImage* pImage );
+/**
+ * @brief Parses the image buffer with the decoder and writes the pixels into the caller's buffer, as PNGParseInto.
+ * @param decoder 
+ * @param data 
+ * @param length 
+ * @param pImage 
+ * @param destination 
+ * @param capacity Bytes available at destination
+ * @param rowStride Distance between the starts of two rows, 0 for rows packed back to back, unused by tiles and
+ *                  tensors
+ * @return Parse result code
+ */
+extern PNGParserResultType PNGDecoderDecodeInto( PNGDecoder* decoder, uint8_t* data, uint32_t length, PNGImage* pImage,
+                                                 uint8_t* destination, uint32_t capacity, uint32_t rowStride );
+/**
+ * @brief Parses the image buffer with the decoder and hands the rows to rowOutput, as PNGParseRows.
+ * @param decoder 
+ * @param data 
+ * @param length 
+ * @param pImage 
+ * @param rowOutput 
+ * @param context Passed to rowOutput
+ * @return Parse result code
+ */
+extern PNGParserResultType PNGDecoderDecodeRows( PNGDecoder* decoder, uint8_t* data, uint32_t length, PNGImage* pImage,
+                                                 PNGParserRowFunction rowOutput, void* context );
+/**
+ * @brief Frees the decoder and everything it holds.
+ * @param decoder 
+ */
+extern void PNGDecoderDestroy( PNGDecoder* decoder );
+/**
+ * @brief Frees the pImage memory that is allocated. Only for images decoded with the default allocator, an image
+ *        allocated through options.allocator or an arena has to go to PNGImageFreeWithAllocator instead.
  * @param imageData 
  * @param length 
  */
 extern void PNGImageFree( uint8_t* imageData, uint32_t length );
+/**
+ * @brief Frees the pImage memory through the allocator the decode used. For an arena allocator this does nothing,
+ *        the memory comes back with PNGParserArenaReset.
+ * @param pAllocator Allocator from the decode options, NULL for the default one
+ * @param imageData 
+ * @param length 
+ */
+extern void PNGImageFreeWithAllocator( const PNGParserAllocatorType* pAllocator, uint8_t* imageData,
+                                       uint32_t length );
 
 /**
- * @brief External library function for calculating CRC.
+ * @brief Picks the decoder kernels for this CPU. Called on first use with PNGParser_CPU_Level_Auto, which can be
+ *        capped through the PNGPARSER_CPU_LEVEL environment variable (scalar, sse2, ssse3, avx2 or avx512).
+ *        Forcing a level must not run concurrently with decodes, call it before starting decoder threads.
+ * @param level Highest instruction set level to use
+ * @return Level in use, never above what the CPU supports
+ */
+extern PNGParserCPULevelType PNGParserInitCPU( PNGParserCPULevelType level );
+
+/**
+ * @brief Calculates CRC32 with the kernel picked for this CPU.
  * @param buffer 
  * @param length 
  * @return CRC32 of the buffer
  */
 extern uint32_t CRC32( uint8_t* buffer, uint32_t length );
 
+/**
+ * @brief Continues a CRC over the next part of the data.
+ * @param crc CRC of the data so far, 0 for none
+ * @param buffer 
+ * @param length 
+ * @return CRC32 of the data so far and the buffer
+ */
+extern uint32_t CRC32Update( uint32_t crc, uint8_t* buffer, uint32_t length );
+
 #endif// PNGPARSER_HEADER
\ No newline at end of file
@@ -0,0 +1,206 @@
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * PNGParser Runtime Allocators
+ */
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "PNGParserAllocator.h"
+#include "PNGParser.h"
+
+/* The vendored zlib's private state, only for its size. */
+#ifndef ZLIB_INTERNAL
+#define ZLIB_INTERNAL
+#endif
+#include "inftrees.h"
+#include "inflate.h"
+
+/***********************************************************************************************************************
+Macro definitions
+***********************************************************************************************************************/
+#define PNGPARSER_ARENA_ALIGNMENT 16u
+
+/* zlib frees without a size, so its blocks carry their size in front, padded to keep the block aligned. */
+#define PNGPARSER_ZLIB_BLOCK_HEADER_LENGTH 16u
+
+/***********************************************************************************************************************
+Static function Prototypes
+***********************************************************************************************************************/
+
+static void* PNGParserHeapAllocate( void* context, uint32_t size );
+static void* PNGParserHeapReallocate( void* context, void* pointer, uint32_t oldSize, uint32_t newSize );
+static void PNGParserHeapFree( void* context, void* pointer, uint32_t size );
+static void* PNGParserArenaAllocate( void* context, uint32_t size );
+static void PNGParserArenaFree( void* context, void* pointer, uint32_t size );
+
+/***********************************************************************************************************************
+Implementation
+***********************************************************************************************************************/
+
+static void* PNGParserHeapAllocate( void* context, uint32_t size )
+{
+    ( void ) context;
+    return PNGPARSER_MALLOC( size );
+}
+
+static void* PNGParserHeapReallocate( void* context, void* pointer, uint32_t oldSize, uint32_t newSize )
+{
+    ( void ) context;
+    ( void ) oldSize;
+    return PNGPARSER_REALLOC( pointer, newSize );
+}
+
+static void PNGParserHeapFree( void* context, void* pointer, uint32_t size )
+{
+    ( void ) context;
+    ( void ) size;
+    PNGPARSER_FREE( pointer, size );
+}
+
+void PNGParserGetDefaultAllocator( PNGParserAllocatorType* pAllocator )
+{
+    pAllocator->allocate = PNGParserHeapAllocate;
+    pAllocator->reallocate = PNGParserHeapReallocate;
+    pAllocator->free = PNGParserHeapFree;
+    pAllocator->context = NULL;
+}
+
+void* PNGParserAllocate( const PNGParserAllocatorType* allocator, uint32_t size )
+{
+    return allocator->allocate( allocator->context, size );
+}
+
+void* PNGParserReallocate( const PNGParserAllocatorType* allocator, void* pointer, uint32_t oldSize,
+                           uint32_t newSize )
+{
+    if ( NULL != allocator->reallocate )
+    {
+        return allocator->reallocate( allocator->context, pointer, oldSize, newSize );
+    }
+
+    void* result = allocator->allocate( allocator->context, newSize );
+    if ( NULL != result && NULL != pointer )
+    {
+        PNGPARSER_MEMCPY( result, pointer, oldSize < newSize ? oldSize : newSize );
+        allocator->free( allocator->context, pointer, oldSize );
+    }
+    return result;
+}
+
+void PNGParserFree( const PNGParserAllocatorType* allocator, void* pointer, uint32_t size )
+{
+    if ( NULL != pointer ) { allocator->free( allocator->context, pointer, size ); }
+}
+
+voidpf PNGParserZAlloc( voidpf opaque, uInt items, uInt size )
+{
+    const PNGParserAllocatorType* allocator = ( const PNGParserAllocatorType* ) opaque;
+    uint8_t* block = NULL;
+
+    if ( 0u == size || items <= ( 0xFFFFFFFFu - PNGPARSER_ZLIB_BLOCK_HEADER_LENGTH ) / size )
+    {
+        uint32_t length = items * size + PNGPARSER_ZLIB_BLOCK_HEADER_LENGTH;
+        block = ( uint8_t* ) PNGParserAllocate( allocator, length );
+        if ( NULL != block )
+        {
+            PNGPARSER_MEMCPY( block, &length, sizeof( length ) );
+            block += PNGPARSER_ZLIB_BLOCK_HEADER_LENGTH;
+        }
+    }
+    return block;
+}
+
+void PNGParserZFree( voidpf opaque, voidpf address )
+{
+    const PNGParserAllocatorType* allocator = ( const PNGParserAllocatorType* ) opaque;
+    uint8_t* block = ( uint8_t* ) address - PNGPARSER_ZLIB_BLOCK_HEADER_LENGTH;
+    uint32_t length;
+
+    PNGPARSER_MEMCPY( &length, block, sizeof( length ) );
+    PNGParserFree( allocator, block, length );
+}
+
+uint32_t PNGParserInflateScratchBytes( void )
+{
+    /* inflate always allocates the window for the largest stream, whatever the zlib header asks for. */
+    return ( uint32_t ) sizeof( struct inflate_state ) + PNGPARSER_ZLIB_BLOCK_HEADER_LENGTH +
+           ( 1u << PNGPARSER_ZLIB_MAX_WINDOW_BITS ) + PNGPARSER_ZLIB_BLOCK_HEADER_LENGTH;
+}
+
+void PNGParserArenaInit( PNGParserArenaType* arena, void* memory, uint32_t capacity )
+{
+    arena->memory = ( uint8_t* ) memory;
+    arena->capacity = capacity;
+    arena->used = 0;
+    arena->last = 0;
+}
+
+void PNGParserArenaReset( PNGParserArenaType* arena )
+{
+    arena->used = 0;
+    arena->last = 0;
+}
+
+static void* PNGParserArenaAllocate( void* context, uint32_t size )
+{
+    PNGParserArenaType* arena = ( PNGParserArenaType* ) context;
+    void* result = NULL;
+
+    /* Offsets are aligned from the start of the memory, which is expected to be at least as aligned as malloc's. */
+    uint32_t offset = ( arena->used + PNGPARSER_ARENA_ALIGNMENT - 1u ) & ~( PNGPARSER_ARENA_ALIGNMENT - 1u );
+    if ( offset >= arena->used && offset <= arena->capacity && size <= arena->capacity - offset )
+    {
+        result = &arena->memory[ offset ];
+        arena->last = offset;
+        arena->used = offset + size;
+    }
+    return result;
+}
+
+static void PNGParserArenaFree( void* context, void* pointer, uint32_t size )
+{
+    PNGParserArenaType* arena = ( PNGParserArenaType* ) context;
+    ( void ) size;
+
+    /* Only the newest block can be given back, everything else waits for PNGParserArenaReset. */
+    if ( ( uint8_t* ) pointer == &arena->memory[ arena->last ] ) { arena->used = arena->last; }
+}
+
+void PNGParserGetArenaAllocator( PNGParserArenaType* arena, PNGParserAllocatorType* pAllocator )
+{
+    pAllocator->allocate = PNGParserArenaAllocate;
+    pAllocator->reallocate = NULL;
+    pAllocator->free = PNGParserArenaFree;
+    pAllocator->context = arena;
+}
@@ -0,0 +1,93 @@
+#ifndef PNGPARSER_ALLOCATOR_HEADER
+#define PNGPARSER_ALLOCATOR_HEADER
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * PNGParser Runtime Allocators
+ */
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "PNGParserDefs.h"
+
+/***********************************************************************************************************************
+Function prototypes
+***********************************************************************************************************************/
+
+/**
+ * @brief Allocates through the allocator.
+ * @param allocator 
+ * @param size 
+ * @return Memory, NULL if it could not be allocated
+ */
+extern void* PNGParserAllocate( const PNGParserAllocatorType* allocator, uint32_t size );
+/**
+ * @brief Grows or shrinks an allocation, keeping the first min( oldSize, newSize ) bytes.
+ * @param allocator 
+ * @param pointer Allocation, NULL for none
+ * @param oldSize 
+ * @param newSize 
+ * @return Memory, NULL if it could not be allocated, then pointer is left as it was
+ */
+extern void* PNGParserReallocate( const PNGParserAllocatorType* allocator, void* pointer, uint32_t oldSize,
+                                  uint32_t newSize );
+/**
+ * @brief Frees an allocation, NULL is ignored.
+ * @param allocator 
+ * @param pointer 
+ * @param size Size it was allocated with
+ */
+extern void PNGParserFree( const PNGParserAllocatorType* allocator, void* pointer, uint32_t size );
+/**
+ * @brief zlib zalloc hook, opaque is the PNGParserAllocatorType.
+ * @param opaque 
+ * @param items 
+ * @param size 
+ * @return Memory, Z_NULL if it could not be allocated
+ */
+extern voidpf PNGParserZAlloc( voidpf opaque, uInt items, uInt size );
+/**
+ * @brief zlib zfree hook, opaque is the PNGParserAllocatorType.
+ * @param opaque 
+ * @param address 
+ */
+extern void PNGParserZFree( voidpf opaque, voidpf address );
+
+/**
+ * @brief Bytes one z_stream allocates through PNGParserZAlloc to inflate a PNG, the state and the 32K window.
+ * @return Size in bytes
+ */
+extern uint32_t PNGParserInflateScratchBytes( void );
+
+#endif// PNGPARSER_ALLOCATOR_HEADER
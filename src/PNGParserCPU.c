@@ -0,0 +1,227 @@
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * PNGParser CPU Feature Detection and Kernel Dispatch
+ */
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "PNGParserCPU.h"
+#include "PNGParser.h"
+
+#if defined( PNGPARSER_X86 )
+#include <cpuid.h>
+#endif
+
+#ifndef NON_STD_ENV
+#include <stdlib.h>
+#include <string.h>
+#endif
+
+/***********************************************************************************************************************
+Macro definitions
+***********************************************************************************************************************/
+#if defined( __GNUC__ )
+#define PNGPARSER_ATOMIC_LOAD( p ) __atomic_load_n( p, __ATOMIC_ACQUIRE )
+#define PNGPARSER_ATOMIC_STORE( p, v ) __atomic_store_n( p, v, __ATOMIC_RELEASE )
+#define PNGPARSER_ATOMIC_CAS( p, expected, desired ) __sync_bool_compare_and_swap( p, expected, desired )
+#else
+#define PNGPARSER_ATOMIC_LOAD( p ) ( *( p ) )
+#define PNGPARSER_ATOMIC_STORE( p, v ) ( *( p ) = ( v ) )
+#define PNGPARSER_ATOMIC_CAS( p, expected, desired ) ( ( *( p ) == ( expected ) ) ? ( *( p ) = ( desired ), 1 ) : 0 )
+#endif
+
+#define PNGPARSER_CPU_LEVEL_COUNT ( PNGParser_CPU_Level_AVX512 + 1 )
+
+/* States of a kernel table. */
+#define PNGPARSER_KERNELS_EMPTY 0
+#define PNGPARSER_KERNELS_BUILDING 1
+#define PNGPARSER_KERNELS_READY 2
+
+/* XCR0 bits for the SSE/AVX and the AVX-512 register state the OS has to save on context switches. */
+#define PNGPARSER_XCR0_AVX_STATE 0x06u
+#define PNGPARSER_XCR0_AVX512_STATE 0xE6u
+
+/***********************************************************************************************************************
+Static variables
+***********************************************************************************************************************/
+
+/* One table per level, each filled once and never written again, so a decode holding a pointer to one keeps seeing
+ * the same kernels. */
+static PNGParserKernelsType sKernelTables[ PNGPARSER_CPU_LEVEL_COUNT ];
+static int32_t sKernelTableStates[ PNGPARSER_CPU_LEVEL_COUNT ];
+static const PNGParserKernelsType* sKernels = NULL;
+
+/* Features each level is allowed to use, a forced level masks out everything above it. */
+static const uint32_t sPNGParserCPULevelFeatures[] = {
+        /*PNGParser_CPU_Level_Auto   -->*/ 0xFFFFFFFFu,
+        /*PNGParser_CPU_Level_Scalar -->*/ 0u,
+        /*PNGParser_CPU_Level_SSE2   -->*/ PNGPARSER_CPU_FEATURE_SSE2,
+        /*PNGParser_CPU_Level_SSSE3  -->*/ PNGPARSER_CPU_FEATURE_SSE2 | PNGPARSER_CPU_FEATURE_SSSE3 |
+                PNGPARSER_CPU_FEATURE_SSE41 | PNGPARSER_CPU_FEATURE_PCLMUL,
+        /*PNGParser_CPU_Level_AVX2   -->*/ PNGPARSER_CPU_FEATURE_SSE2 | PNGPARSER_CPU_FEATURE_SSSE3 |
+                PNGPARSER_CPU_FEATURE_SSE41 | PNGPARSER_CPU_FEATURE_PCLMUL | PNGPARSER_CPU_FEATURE_AVX2 |
+                PNGPARSER_CPU_FEATURE_F16C,
+        /*PNGParser_CPU_Level_AVX512 -->*/ 0xFFFFFFFFu,
+};
+
+/***********************************************************************************************************************
+Static function Prototypes
+***********************************************************************************************************************/
+
+static PNGParserCPULevelType PNGParserGetEnvironmentCPULevel( void );
+static PNGParserCPULevelType PNGParserGetFeaturesCPULevel( uint32_t features );
+static void PNGParserBuildKernels( PNGParserKernelsType* kernels, uint32_t features );
+
+/***********************************************************************************************************************
+Implementation
+***********************************************************************************************************************/
+
+uint32_t PNGParserDetectCPUFeatures( void )
+{
+    uint32_t features = 0;
+#if defined( PNGPARSER_X86 )
+    unsigned int eax, ebx, ecx, edx;
+    if ( __get_cpuid( 1, &eax, &ebx, &ecx, &edx ) )
+    {
+        if ( edx & bit_SSE2 ) { features |= PNGPARSER_CPU_FEATURE_SSE2; }
+        if ( ecx & bit_SSSE3 ) { features |= PNGPARSER_CPU_FEATURE_SSSE3; }
+        if ( ecx & bit_SSE4_1 ) { features |= PNGPARSER_CPU_FEATURE_SSE41; }
+        if ( ecx & bit_PCLMUL ) { features |= PNGPARSER_CPU_FEATURE_PCLMUL; }
+        uint32_t f16c = ecx & bit_F16C;
+
+        uint32_t xcr0 = 0;
+        if ( ecx & bit_OSXSAVE )
+        {
+            unsigned int xcr0High;
+            __asm__ volatile( "xgetbv" : "=a"( xcr0 ), "=d"( xcr0High ) : "c"( 0 ) );
+        }
+
+        if ( __get_cpuid_count( 7, 0, &eax, &ebx, &ecx, &edx ) )
+        {
+            if ( ( xcr0 & PNGPARSER_XCR0_AVX_STATE ) == PNGPARSER_XCR0_AVX_STATE && ( ebx & bit_AVX2 ) )
+            {
+                features |= PNGPARSER_CPU_FEATURE_AVX2;
+                if ( f16c ) { features |= PNGPARSER_CPU_FEATURE_F16C; }
+            }
+            if ( ( xcr0 & PNGPARSER_XCR0_AVX512_STATE ) == PNGPARSER_XCR0_AVX512_STATE && ( ebx & bit_AVX512F ) &&
+                 ( ebx & bit_AVX512BW ) && ( ebx & bit_AVX512VL ) )
+            {
+                features |= PNGPARSER_CPU_FEATURE_AVX512;
+                if ( ecx & bit_VPCLMULQDQ ) { features |= PNGPARSER_CPU_FEATURE_VPCLMUL; }
+            }
+        }
+    }
+#endif
+    return features;
+}
+
+static PNGParserCPULevelType PNGParserGetEnvironmentCPULevel( void )
+{
+    PNGParserCPULevelType level = PNGParser_CPU_Level_Auto;
+#ifndef NON_STD_ENV
+    const char* names[] = { "auto", "scalar", "sse2", "ssse3", "avx2", "avx512" };
+    const char* value = getenv( PNGPARSER_CPU_LEVEL_ENV );
+    for ( uint32_t i = 0; NULL != value && i <= PNGParser_CPU_Level_AVX512; i++ )
+    {
+        if ( 0 == strcmp( value, names[ i ] ) ) { level = ( PNGParserCPULevelType ) i; }
+    }
+#endif
+    return level;
+}
+
+static PNGParserCPULevelType PNGParserGetFeaturesCPULevel( uint32_t features )
+{
+    PNGParserCPULevelType level = PNGParser_CPU_Level_Scalar;
+    if ( features & PNGPARSER_CPU_FEATURE_SSE2 ) { level = PNGParser_CPU_Level_SSE2; }
+    if ( features & PNGPARSER_CPU_FEATURE_SSSE3 ) { level = PNGParser_CPU_Level_SSSE3; }
+    if ( features & PNGPARSER_CPU_FEATURE_AVX2 ) { level = PNGParser_CPU_Level_AVX2; }
+    if ( features & PNGPARSER_CPU_FEATURE_AVX512 ) { level = PNGParser_CPU_Level_AVX512; }
+    return level;
+}
+
+PNGParserCPULevelType PNGParserInitCPU( PNGParserCPULevelType level )
+{
+    if ( PNGParser_CPU_Level_Auto == level ) { level = PNGParserGetEnvironmentCPULevel(); }
+    if ( level > PNGParser_CPU_Level_AVX512 ) { level = PNGParser_CPU_Level_Auto; }
+    uint32_t detected = PNGParserDetectCPUFeatures();
+    PNGParserCPULevelType picked = PNGParserGetFeaturesCPULevel( detected & sPNGParserCPULevelFeatures[ level ] );
+    PNGParserKernelsType* kernels = &sKernelTables[ picked ];
+
+    if ( PNGPARSER_ATOMIC_CAS( &sKernelTableStates[ picked ], PNGPARSER_KERNELS_EMPTY, PNGPARSER_KERNELS_BUILDING ) )
+    {
+        PNGParserBuildKernels( kernels, detected & sPNGParserCPULevelFeatures[ picked ] );
+        PNGPARSER_ATOMIC_STORE( &sKernelTableStates[ picked ], PNGPARSER_KERNELS_READY );
+    }
+    /* Another thread is filling the same table, which takes microseconds. */
+    while ( PNGPARSER_KERNELS_READY != PNGPARSER_ATOMIC_LOAD( &sKernelTableStates[ picked ] ) ) {}
+
+    PNGPARSER_ATOMIC_STORE( &sKernels, kernels );
+    return picked;
+}
+
+const PNGParserKernelsType* PNGParserGetKernels( void )
+{
+    const PNGParserKernelsType* kernels = PNGPARSER_ATOMIC_LOAD( &sKernels );
+    if ( NULL == kernels )
+    {
+        PNGParserInitCPU( PNGParser_CPU_Level_Auto );
+        kernels = PNGPARSER_ATOMIC_LOAD( &sKernels );
+    }
+    return kernels;
+}
+
+static void PNGParserBuildKernels( PNGParserKernelsType* kernels, uint32_t features )
+{
+    kernels->features = features;
+    kernels->level = PNGParserGetFeaturesCPULevel( features );
+
+    PNGParserUnfilterKernelsScalar( &kernels->unfilter );
+    PNGParserPixelKernelsScalar( &kernels->pixel );
+    kernels->crc32Update = PNGParserCRC32UpdateScalar;
+
+#if defined( PNGPARSER_X86 )
+    if ( kernels->features & PNGPARSER_CPU_FEATURE_SSE2 ) { PNGParserUnfilterKernelsSSE2( &kernels->unfilter ); }
+    if ( kernels->features & PNGPARSER_CPU_FEATURE_SSSE3 ) { PNGParserUnfilterKernelsSSSE3( &kernels->unfilter ); }
+    if ( kernels->features & PNGPARSER_CPU_FEATURE_AVX2 ) { PNGParserUnfilterKernelsAVX2( &kernels->unfilter ); }
+    if ( kernels->features & PNGPARSER_CPU_FEATURE_SSE2 ) { PNGParserPixelKernelsSSE2( &kernels->pixel ); }
+    if ( kernels->features & PNGPARSER_CPU_FEATURE_SSSE3 ) { PNGParserPixelKernelsSSSE3( &kernels->pixel ); }
+    if ( kernels->features & PNGPARSER_CPU_FEATURE_AVX2 ) { PNGParserPixelKernelsAVX2( &kernels->pixel ); }
+    if ( kernels->features & PNGPARSER_CPU_FEATURE_F16C ) { PNGParserPixelKernelsF16C( &kernels->pixel ); }
+
+    uint32_t pclmul = PNGPARSER_CPU_FEATURE_SSE41 | PNGPARSER_CPU_FEATURE_PCLMUL;
+    uint32_t vpclmul = pclmul | PNGPARSER_CPU_FEATURE_AVX512 | PNGPARSER_CPU_FEATURE_VPCLMUL;
+    if ( ( kernels->features & pclmul ) == pclmul ) { kernels->crc32Update = PNGParserCRC32UpdatePCLMUL; }
+    if ( ( kernels->features & vpclmul ) == vpclmul ) { kernels->crc32Update = PNGParserCRC32UpdateVPCLMUL; }
+#endif
+}
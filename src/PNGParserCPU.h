@@ -0,0 +1,123 @@
+#ifndef PNGPARSER_CPU_HEADER
+#define PNGPARSER_CPU_HEADER
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * PNGParser CPU Feature Detection and Kernel Dispatch
+ */
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "PNGParserDefs.h"
+#include "PNGParserFilter.h"
+#include "PNGParserPixel.h"
+
+/***********************************************************************************************************************
+Macro definitions
+***********************************************************************************************************************/
+#if ( defined( __x86_64__ ) || defined( __i386__ ) ) && defined( __GNUC__ )
+#define PNGPARSER_X86 1
+#define PNGPARSER_TARGET_SSE2 __attribute__( ( target( "sse2" ) ) )
+#define PNGPARSER_TARGET_SSSE3 __attribute__( ( target( "ssse3" ) ) )
+#define PNGPARSER_TARGET_AVX2 __attribute__( ( target( "avx2" ) ) )
+#define PNGPARSER_TARGET_F16C __attribute__( ( target( "avx2,f16c" ) ) )
+#define PNGPARSER_TARGET_PCLMUL __attribute__( ( target( "sse4.1,pclmul" ) ) )
+#define PNGPARSER_TARGET_VPCLMUL __attribute__( ( target( "sse4.1,pclmul,avx512f,avx512bw,avx512vl,vpclmulqdq" ) ) )
+#endif
+
+#define PNGPARSER_CPU_FEATURE_SSE2 0x01u
+#define PNGPARSER_CPU_FEATURE_SSSE3 0x02u
+#define PNGPARSER_CPU_FEATURE_SSE41 0x04u
+#define PNGPARSER_CPU_FEATURE_PCLMUL 0x08u
+#define PNGPARSER_CPU_FEATURE_AVX2 0x10u
+#define PNGPARSER_CPU_FEATURE_AVX512 0x20u
+#define PNGPARSER_CPU_FEATURE_VPCLMUL 0x40u
+#define PNGPARSER_CPU_FEATURE_F16C 0x80u
+
+#define PNGPARSER_CPU_LEVEL_ENV "PNGPARSER_CPU_LEVEL"
+
+/***********************************************************************************************************************
+Type definitions
+***********************************************************************************************************************/
+
+typedef uint32_t ( *PNGParserCRC32Function )( uint32_t crc, uint8_t* buffer, uint32_t length );
+
+typedef struct {
+    PNGParserCPULevelType level;
+    uint32_t features;
+    PNGParserUnfilterKernelsType unfilter;
+    PNGParserPixelKernelsType pixel;
+    PNGParserCRC32Function crc32Update;
+} PNGParserKernelsType;
+
+/***********************************************************************************************************************
+Function prototypes
+***********************************************************************************************************************/
+
+/**
+ * @brief Returns the kernels picked for this CPU, running the detection with PNGParser_CPU_Level_Auto on first use.
+ * @return Kernel table
+ */
+extern const PNGParserKernelsType* PNGParserGetKernels( void );
+/**
+ * @brief Reads the instruction set extensions the CPU and the OS support.
+ * @return PNGPARSER_CPU_FEATURE_* mask
+ */
+extern uint32_t PNGParserDetectCPUFeatures( void );
+/**
+ * @brief Portable reference CRC32, the table implementation from Vendor/CRC.
+ * @param crc 
+ * @param buffer 
+ * @param length 
+ * @return CRC32 of the data so far and the buffer
+ */
+extern uint32_t PNGParserCRC32UpdateScalar( uint32_t crc, uint8_t* buffer, uint32_t length );
+/**
+ * @brief CRC32 folded 64 bytes at a time with PCLMULQDQ, needs SSE4.1 and PCLMUL.
+ * @param crc 
+ * @param buffer 
+ * @param length 
+ * @return CRC32 of the data so far and the buffer
+ */
+extern uint32_t PNGParserCRC32UpdatePCLMUL( uint32_t crc, uint8_t* buffer, uint32_t length );
+/**
+ * @brief CRC32 folded 256 bytes at a time with VPCLMULQDQ, needs AVX-512 and VPCLMULQDQ.
+ * @param crc 
+ * @param buffer 
+ * @param length 
+ * @return CRC32 of the data so far and the buffer
+ */
+extern uint32_t PNGParserCRC32UpdateVPCLMUL( uint32_t crc, uint8_t* buffer, uint32_t length );
+
+#endif// PNGPARSER_CPU_HEADER
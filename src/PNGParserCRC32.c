@@ -0,0 +1,56 @@
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * PNGParser CRC32 Entry Points
+ */
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "CRC32.h"
+#include "PNGParserCPU.h"
+
+/***********************************************************************************************************************
+Implementation
+***********************************************************************************************************************/
+
+uint32_t PNGParserCRC32UpdateScalar( uint32_t crc, uint8_t* buffer, uint32_t length )
+{
+    return CRC32TableUpdate( crc, buffer, length );
+}
+
+uint32_t CRC32Update( uint32_t crc, uint8_t* buffer, uint32_t length )
+{
+    return PNGParserGetKernels()->crc32Update( crc, buffer, length );
+}
+
+uint32_t CRC32( uint8_t* buffer, uint32_t length ) { return CRC32Update( 0, buffer, length ); }
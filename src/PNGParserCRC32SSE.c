@@ -0,0 +1,178 @@
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * PNGParser CRC32 Carry-less Multiply Folding
+ */
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "PNGParserCPU.h"
+
+#if defined( PNGPARSER_X86 )
+#include <immintrin.h>
+
+/***********************************************************************************************************************
+Macro definitions
+***********************************************************************************************************************/
+
+/* Folding works on the inverted running value in 16 byte blocks and needs at least four of them to start, whatever is
+ * left after the last whole block goes through the scalar kernel. */
+#define PNGPARSER_CRC32_FOLD_MIN_LENGTH 64u
+#define PNGPARSER_CRC32_FOLD_WIDE_MIN_LENGTH 256u
+
+/***********************************************************************************************************************
+Static variables
+***********************************************************************************************************************/
+
+/* Bit reflected x^(d+32) and x^(d-32) mod P, shifted left by one, for fold distances d of 512 and 128 bits, the 64 to
+ * 32 bit step and the Barrett reduction pair ( P, floor( x^64 / P ) ), see Intel's "Fast CRC Computation for Generic
+ * Polynomials Using PCLMULQDQ Instruction". */
+static const uint64_t sPNGParserCRC32Fold512[ 2 ] = { 0x0154442bd4u, 0x01c6e41596u };
+static const uint64_t sPNGParserCRC32Fold128[ 2 ] = { 0x01751997d0u, 0x00ccaa009eu };
+static const uint64_t sPNGParserCRC32Fold64[ 2 ] = { 0x0163cd6124u, 0x0000000000u };
+static const uint64_t sPNGParserCRC32Barrett[ 2 ] = { 0x01db710641u, 0x01f7011641u };
+/* Same for a fold distance of 2048 bits, four 512 bit registers at a time. */
+static const uint64_t sPNGParserCRC32Fold2048[ 2 ] = { 0x011542778au, 0x01322d1430u };
+
+/***********************************************************************************************************************
+Implementation
+***********************************************************************************************************************/
+
+PNGPARSER_TARGET_PCLMUL static inline __m128i PNGParserCRC32Fold( __m128i x, __m128i k, __m128i data )
+{
+    __m128i low = _mm_clmulepi64_si128( x, k, 0x00 );
+    __m128i high = _mm_clmulepi64_si128( x, k, 0x11 );
+    return _mm_xor_si128( _mm_xor_si128( low, high ), data );
+}
+
+/* Folds the remaining whole 16 byte blocks into x, then reduces the 128 bit remainder to the 32 bit CRC. */
+PNGPARSER_TARGET_PCLMUL static uint32_t PNGParserCRC32FoldFinish( __m128i x, const uint8_t* buffer, uint32_t length )
+{
+    __m128i k = _mm_loadu_si128( ( const __m128i* ) sPNGParserCRC32Fold128 );
+    for ( ; length >= 16u; buffer += 16u, length -= 16u )
+    {
+        x = PNGParserCRC32Fold( x, k, _mm_loadu_si128( ( const __m128i* ) buffer ) );
+    }
+
+    __m128i mask = _mm_setr_epi32( ~0, 0, ~0, 0 );
+    __m128i t = _mm_clmulepi64_si128( x, k, 0x10 );
+    x = _mm_xor_si128( _mm_srli_si128( x, 8 ), t );
+
+    k = _mm_loadl_epi64( ( const __m128i* ) sPNGParserCRC32Fold64 );
+    t = _mm_srli_si128( x, 4 );
+    x = _mm_xor_si128( _mm_clmulepi64_si128( _mm_and_si128( x, mask ), k, 0x00 ), t );
+
+    k = _mm_loadu_si128( ( const __m128i* ) sPNGParserCRC32Barrett );
+    t = _mm_clmulepi64_si128( _mm_and_si128( x, mask ), k, 0x10 );
+    t = _mm_clmulepi64_si128( _mm_and_si128( t, mask ), k, 0x00 );
+    x = _mm_xor_si128( x, t );
+
+    return ( uint32_t ) _mm_extract_epi32( x, 1 );
+}
+
+PNGPARSER_TARGET_PCLMUL uint32_t PNGParserCRC32UpdatePCLMUL( uint32_t crc, uint8_t* buffer, uint32_t length )
+{
+    if ( length < PNGPARSER_CRC32_FOLD_MIN_LENGTH ) { return PNGParserCRC32UpdateScalar( crc, buffer, length ); }
+
+    uint32_t folded = length & ~15u;
+    const uint8_t* p = buffer;
+    __m128i k = _mm_loadu_si128( ( const __m128i* ) sPNGParserCRC32Fold512 );
+    __m128i x0 = _mm_xor_si128( _mm_loadu_si128( ( const __m128i* ) p ), _mm_cvtsi32_si128( ( int ) ~crc ) );
+    __m128i x1 = _mm_loadu_si128( ( const __m128i* ) ( p + 16 ) );
+    __m128i x2 = _mm_loadu_si128( ( const __m128i* ) ( p + 32 ) );
+    __m128i x3 = _mm_loadu_si128( ( const __m128i* ) ( p + 48 ) );
+    p += 64u;
+
+    for ( uint32_t left = folded - 64u; left >= 64u; left -= 64u, p += 64u )
+    {
+        x0 = PNGParserCRC32Fold( x0, k, _mm_loadu_si128( ( const __m128i* ) p ) );
+        x1 = PNGParserCRC32Fold( x1, k, _mm_loadu_si128( ( const __m128i* ) ( p + 16 ) ) );
+        x2 = PNGParserCRC32Fold( x2, k, _mm_loadu_si128( ( const __m128i* ) ( p + 32 ) ) );
+        x3 = PNGParserCRC32Fold( x3, k, _mm_loadu_si128( ( const __m128i* ) ( p + 48 ) ) );
+    }
+
+    k = _mm_loadu_si128( ( const __m128i* ) sPNGParserCRC32Fold128 );
+    x0 = PNGParserCRC32Fold( x0, k, x1 );
+    x0 = PNGParserCRC32Fold( x0, k, x2 );
+    x0 = PNGParserCRC32Fold( x0, k, x3 );
+
+    crc = ~PNGParserCRC32FoldFinish( x0, p, ( uint32_t ) ( buffer + folded - p ) );
+    return PNGParserCRC32UpdateScalar( crc, buffer + folded, length - folded );
+}
+
+PNGPARSER_TARGET_VPCLMUL static inline __m512i PNGParserCRC32FoldWide( __m512i x, __m512i k, __m512i data )
+{
+    __m512i low = _mm512_clmulepi64_epi128( x, k, 0x00 );
+    __m512i high = _mm512_clmulepi64_epi128( x, k, 0x11 );
+    return _mm512_ternarylogic_epi64( low, high, data, 0x96 );
+}
+
+PNGPARSER_TARGET_VPCLMUL uint32_t PNGParserCRC32UpdateVPCLMUL( uint32_t crc, uint8_t* buffer, uint32_t length )
+{
+    if ( length < PNGPARSER_CRC32_FOLD_WIDE_MIN_LENGTH ) { return PNGParserCRC32UpdatePCLMUL( crc, buffer, length ); }
+
+    uint32_t folded = length & ~15u;
+    const uint8_t* p = buffer;
+    const uint8_t* end = buffer + folded;
+    __m512i k = _mm512_broadcast_i32x4( _mm_loadu_si128( ( const __m128i* ) sPNGParserCRC32Fold2048 ) );
+    __m512i seed = _mm512_zextsi128_si512( _mm_cvtsi32_si128( ( int ) ~crc ) );
+    __m512i z0 = _mm512_xor_si512( _mm512_loadu_si512( p ), seed );
+    __m512i z1 = _mm512_loadu_si512( p + 64 );
+    __m512i z2 = _mm512_loadu_si512( p + 128 );
+    __m512i z3 = _mm512_loadu_si512( p + 192 );
+    p += 256u;
+
+    for ( ; end - p >= 256; p += 256u )
+    {
+        z0 = PNGParserCRC32FoldWide( z0, k, _mm512_loadu_si512( p ) );
+        z1 = PNGParserCRC32FoldWide( z1, k, _mm512_loadu_si512( p + 64 ) );
+        z2 = PNGParserCRC32FoldWide( z2, k, _mm512_loadu_si512( p + 128 ) );
+        z3 = PNGParserCRC32FoldWide( z3, k, _mm512_loadu_si512( p + 192 ) );
+    }
+
+    k = _mm512_broadcast_i32x4( _mm_loadu_si128( ( const __m128i* ) sPNGParserCRC32Fold512 ) );
+    z0 = PNGParserCRC32FoldWide( z0, k, z1 );
+    z0 = PNGParserCRC32FoldWide( z0, k, z2 );
+    z0 = PNGParserCRC32FoldWide( z0, k, z3 );
+    for ( ; end - p >= 64; p += 64u ) { z0 = PNGParserCRC32FoldWide( z0, k, _mm512_loadu_si512( p ) ); }
+
+    __m128i k128 = _mm_loadu_si128( ( const __m128i* ) sPNGParserCRC32Fold128 );
+    __m128i x = PNGParserCRC32Fold( _mm512_extracti32x4_epi32( z0, 0 ), k128, _mm512_extracti32x4_epi32( z0, 1 ) );
+    x = PNGParserCRC32Fold( x, k128, _mm512_extracti32x4_epi32( z0, 2 ) );
+    x = PNGParserCRC32Fold( x, k128, _mm512_extracti32x4_epi32( z0, 3 ) );
+
+    crc = ~PNGParserCRC32FoldFinish( x, p, ( uint32_t ) ( end - p ) );
+    return PNGParserCRC32UpdateScalar( crc, buffer + folded, length - folded );
+}
+
+#endif
@@ -0,0 +1,252 @@
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * PNGParser Background Chunk CRC Verification
+ */
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "PNGParserCRCWorker.h"
+#include "PNGParser.h"
+
+#if defined( PNGPARSER_THREADS )
+#include <pthread.h>
+#endif
+
+/***********************************************************************************************************************
+Macro definitions
+***********************************************************************************************************************/
+#define PNGPARSER_CRC_WORKER_QUEUE_LENGTH 64u
+
+/***********************************************************************************************************************
+Type definitions
+***********************************************************************************************************************/
+#if defined( PNGPARSER_THREADS )
+
+typedef enum
+{
+    PNGParser_CRC_Job_Begin = 0,
+    PNGParser_CRC_Job_Update,
+    PNGParser_CRC_Job_Check
+} PNGParserCRCJobKindType;
+
+typedef struct {
+    PNGParserCRCJobKindType kind;
+    const uint8_t* data;
+    uint32_t length;
+    uint32_t crc;
+} PNGParserCRCJobType;
+
+struct PNGParserCRCWorkerType {
+    const PNGParserAllocatorType* allocator;
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t jobQueued;
+    pthread_cond_t jobDone;
+    PNGParserCRCJobType jobs[ PNGPARSER_CRC_WORKER_QUEUE_LENGTH ];
+    uint32_t head;
+    uint32_t count;
+    uint32_t crc;
+    BOOL failed;
+    BOOL stop;
+};
+
+/***********************************************************************************************************************
+Static function Prototypes
+***********************************************************************************************************************/
+
+static void* PNGParserCRCWorkerRun( void* argument );
+static void PNGParserCRCWorkerPush( PNGParserCRCWorkerType* worker, const PNGParserCRCJobType* job );
+
+/***********************************************************************************************************************
+Implementation
+***********************************************************************************************************************/
+
+uint32_t PNGParserCRCWorkerSize( void ) { return sizeof( PNGParserCRCWorkerType ); }
+
+PNGParserCRCWorkerType* PNGParserCRCWorkerCreate( const PNGParserAllocatorType* allocator )
+{
+    PNGParserCRCWorkerType* worker =
+            ( PNGParserCRCWorkerType* ) PNGParserAllocate( allocator, sizeof( PNGParserCRCWorkerType ) );
+    if ( NULL != worker )
+    {
+        PNGPARSER_MEMSET( worker, 0, sizeof( *worker ) );
+        worker->allocator = allocator;
+        pthread_mutex_init( &worker->mutex, NULL );
+        pthread_cond_init( &worker->jobQueued, NULL );
+        pthread_cond_init( &worker->jobDone, NULL );
+        if ( 0 != pthread_create( &worker->thread, NULL, PNGParserCRCWorkerRun, worker ) )
+        {
+            pthread_cond_destroy( &worker->jobDone );
+            pthread_cond_destroy( &worker->jobQueued );
+            pthread_mutex_destroy( &worker->mutex );
+            PNGParserFree( allocator, worker, sizeof( PNGParserCRCWorkerType ) );
+            worker = NULL;
+        }
+    }
+    return worker;
+}
+
+void PNGParserCRCWorkerDestroy( PNGParserCRCWorkerType* worker )
+{
+    pthread_mutex_lock( &worker->mutex );
+    worker->stop = TRUE;
+    pthread_cond_signal( &worker->jobQueued );
+    pthread_mutex_unlock( &worker->mutex );
+
+    pthread_join( worker->thread, NULL );
+    pthread_cond_destroy( &worker->jobDone );
+    pthread_cond_destroy( &worker->jobQueued );
+    pthread_mutex_destroy( &worker->mutex );
+    PNGParserFree( worker->allocator, worker, sizeof( PNGParserCRCWorkerType ) );
+}
+
+static void* PNGParserCRCWorkerRun( void* argument )
+{
+    PNGParserCRCWorkerType* worker = ( PNGParserCRCWorkerType* ) argument;
+
+    pthread_mutex_lock( &worker->mutex );
+    for ( ;; )
+    {
+        while ( 0u == worker->count && !worker->stop ) { pthread_cond_wait( &worker->jobQueued, &worker->mutex ); }
+        if ( 0u == worker->count ) { break; }
+
+        PNGParserCRCJobType job = worker->jobs[ worker->head ];
+        BOOL mismatch = FALSE;
+        pthread_mutex_unlock( &worker->mutex );
+
+        /* Only this thread touches the running CRC, the lock is held just for the queue. */
+        switch ( job.kind )
+        {
+            case PNGParser_CRC_Job_Begin:
+                worker->crc = job.crc;
+                break;
+            case PNGParser_CRC_Job_Update:
+                worker->crc = CRC32Update( worker->crc, ( uint8_t* ) job.data, job.length );
+                break;
+            case PNGParser_CRC_Job_Check:
+                mismatch = ( worker->crc != job.crc );
+                break;
+        }
+
+        pthread_mutex_lock( &worker->mutex );
+        if ( mismatch ) { worker->failed = TRUE; }
+        worker->head = ( worker->head + 1u ) % PNGPARSER_CRC_WORKER_QUEUE_LENGTH;
+        worker->count -= 1u;
+        pthread_cond_broadcast( &worker->jobDone );
+    }
+    pthread_mutex_unlock( &worker->mutex );
+    return NULL;
+}
+
+static void PNGParserCRCWorkerPush( PNGParserCRCWorkerType* worker, const PNGParserCRCJobType* job )
+{
+    pthread_mutex_lock( &worker->mutex );
+    while ( PNGPARSER_CRC_WORKER_QUEUE_LENGTH == worker->count )
+    {
+        pthread_cond_wait( &worker->jobDone, &worker->mutex );
+    }
+    worker->jobs[ ( worker->head + worker->count ) % PNGPARSER_CRC_WORKER_QUEUE_LENGTH ] = *job;
+    worker->count += 1u;
+    pthread_cond_signal( &worker->jobQueued );
+    pthread_mutex_unlock( &worker->mutex );
+}
+
+void PNGParserCRCWorkerBegin( PNGParserCRCWorkerType* worker, uint32_t crc )
+{
+    PNGParserCRCJobType job = { PNGParser_CRC_Job_Begin, NULL, 0, crc };
+    PNGParserCRCWorkerPush( worker, &job );
+}
+
+void PNGParserCRCWorkerUpdate( PNGParserCRCWorkerType* worker, const uint8_t* data, uint32_t length )
+{
+    PNGParserCRCJobType job = { PNGParser_CRC_Job_Update, data, length, 0 };
+    PNGParserCRCWorkerPush( worker, &job );
+}
+
+void PNGParserCRCWorkerCheck( PNGParserCRCWorkerType* worker, uint32_t receivedCRC )
+{
+    PNGParserCRCJobType job = { PNGParser_CRC_Job_Check, NULL, 0, receivedCRC };
+    PNGParserCRCWorkerPush( worker, &job );
+}
+
+PNGParserResultType PNGParserCRCWorkerWait( PNGParserCRCWorkerType* worker )
+{
+    pthread_mutex_lock( &worker->mutex );
+    while ( 0u != worker->count ) { pthread_cond_wait( &worker->jobDone, &worker->mutex ); }
+    BOOL failed = worker->failed;
+    worker->failed = FALSE;
+    pthread_mutex_unlock( &worker->mutex );
+
+    return failed ? PNGParser_Error_Corrupted_Data : PNGParser_Result_OK;
+}
+
+#else
+
+/* Without threads the parser keeps checking inline. */
+uint32_t PNGParserCRCWorkerSize( void ) { return 0; }
+
+PNGParserCRCWorkerType* PNGParserCRCWorkerCreate( const PNGParserAllocatorType* allocator )
+{
+    ( void ) allocator;
+    return NULL;
+}
+
+void PNGParserCRCWorkerDestroy( PNGParserCRCWorkerType* worker ) { ( void ) worker; }
+
+void PNGParserCRCWorkerBegin( PNGParserCRCWorkerType* worker, uint32_t crc )
+{
+    ( void ) worker;
+    ( void ) crc;
+}
+
+void PNGParserCRCWorkerUpdate( PNGParserCRCWorkerType* worker, const uint8_t* data, uint32_t length )
+{
+    ( void ) worker;
+    ( void ) data;
+    ( void ) length;
+}
+
+void PNGParserCRCWorkerCheck( PNGParserCRCWorkerType* worker, uint32_t receivedCRC )
+{
+    ( void ) worker;
+    ( void ) receivedCRC;
+}
+
+PNGParserResultType PNGParserCRCWorkerWait( PNGParserCRCWorkerType* worker )
+{
+    ( void ) worker;
+    return PNGParser_Result_OK;
+}
+
+#endif
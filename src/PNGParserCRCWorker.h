@@ -0,0 +1,98 @@
+#ifndef PNGPARSER_CRC_WORKER_HEADER
+#define PNGPARSER_CRC_WORKER_HEADER
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * PNGParser Background Chunk CRC Verification
+ */
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "PNGParserAllocator.h"
+#include "PNGParserDefs.h"
+
+/***********************************************************************************************************************
+Type definitions
+***********************************************************************************************************************/
+
+typedef struct PNGParserCRCWorkerType PNGParserCRCWorkerType;
+
+/***********************************************************************************************************************
+Function prototypes
+***********************************************************************************************************************/
+
+/**
+ * @brief Starts a thread that checks chunk CRCs in the order they are queued.
+ * @param allocator Allocator for the worker, has to outlive it
+ * @return Worker handle, NULL if threads are not available or could not be started
+ */
+extern PNGParserCRCWorkerType* PNGParserCRCWorkerCreate( const PNGParserAllocatorType* allocator );
+/**
+ * @brief Stops the thread and frees the worker.
+ * @param worker 
+ */
+extern void PNGParserCRCWorkerDestroy( PNGParserCRCWorkerType* worker );
+/**
+ * @brief Starts the next chunk.
+ * @param worker 
+ * @param crc CRC of the chunk type bytes
+ */
+extern void PNGParserCRCWorkerBegin( PNGParserCRCWorkerType* worker, uint32_t crc );
+/**
+ * @brief Queues the next piece of the chunk data. The bytes have to stay valid until PNGParserCRCWorkerWait.
+ * @param worker 
+ * @param data 
+ * @param length 
+ */
+extern void PNGParserCRCWorkerUpdate( PNGParserCRCWorkerType* worker, const uint8_t* data, uint32_t length );
+/**
+ * @brief Queues the comparison of the chunk CRC with the one received.
+ * @param worker 
+ * @param receivedCRC 
+ */
+extern void PNGParserCRCWorkerCheck( PNGParserCRCWorkerType* worker, uint32_t receivedCRC );
+/**
+ * @brief Waits until everything queued so far is checked.
+ * @param worker 
+ * @return PNGParser_Error_Corrupted_Data if any chunk since the last wait did not match
+ */
+extern PNGParserResultType PNGParserCRCWorkerWait( PNGParserCRCWorkerType* worker );
+
+/**
+ * @brief Bytes PNGParserCRCWorkerCreate allocates.
+ * @return Size in bytes, 0 without threads
+ */
+extern uint32_t PNGParserCRCWorkerSize( void );
+
+#endif// PNGPARSER_CRC_WORKER_HEADER
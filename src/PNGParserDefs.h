@@ -41,11 +41,11 @@ Includes
 ***********************************************************************************************************************/
 #include "STDTypes.h"
 
-#include <vector.h>
 #include <zlib.h>
 
 #ifndef PNGPARSER_MALLOC
 #include <stdlib.h>
+#include <string.h>
 #endif
 
 #ifndef NON_STD_MATH
@@ -60,7 +60,8 @@ Macro definitions
     {                                                                                                                  \
         137, 80, 78, 71, 13, 10, 26, 10                                                                                \
     }
-#define UINT8_TO_UINT32( x, y, z, w ) ( ( ( x ) << 24 ) | ( ( y ) << 16 ) | ( ( z ) << 8 ) | ( w ) )
+#define UINT8_TO_UINT32( x, y, z, w )                                                                                  \
+    ( ( ( uint32_t ) ( x ) << 24 ) | ( ( uint32_t ) ( y ) << 16 ) | ( ( uint32_t ) ( z ) << 8 ) | ( uint32_t ) ( w ) )
 #define TO_UPPERCASE_WORD( x ) ( ( x ) & 0xDFDFDFDF )
 #define TO_LOWERCASE_WORD( x ) ( ( x ) | 0x10101010 )
 
@@ -78,6 +79,7 @@ Macro definitions
 #define GAMMA_WORD 0x47414D41
 #define IDAT_WORD 0x49444154
 #define IEND_WORD 0x49454E44
+#define TRNS_WORD 0x54524E53
 
 #define PNGPARSER_CHUNK_LENGTH_LENGTH 4u
 #define PNGPARSER_CHUNK_TYPE_OFFSET 4u
@@ -86,7 +88,39 @@ Macro definitions
 #define PNGPARSER_CHUNK_CRC_LENGTH 4u
 #define PNGPARSER_CHUNK_METADATA_LENGTH                                                                                \
     ( PNGPARSER_CHUNK_LENGTH_LENGTH + PNGPARSER_CHUNK_TYPE_LENGTH + PNGPARSER_CHUNK_CRC_LENGTH )
+#define PNGPARSER_CHUNK_MAX_LENGTH 0x7FFFFFFFu
+#define PNGPARSER_IHDR_LENGTH 13u
+#define PNGPARSER_PLTE_MAX_LENGTH 768u
+#define PNGPARSER_GAMMA_LENGTH 4u
+#define PNGPARSER_SRGB_LENGTH 1u
+#define PNGPARSER_TRNS_MAX_LENGTH 256u
+#define PNGPARSER_PALETTE_MAX_ENTRIES 256u
+#define PNGPARSER_PALETTE_ENTRY_LENGTH 3u
+#define PNGPARSER_COLOR_TYPE_PALETTE 3u
+#define PNGPARSER_INTERLACE_ADAM7 1u
+#define PNGPARSER_ADAM7_PASS_COUNT 7u
+#define PNGPARSER_IMAGE_MAX_DIMENSION 0x7FFFFFFFu
+#define PNGPARSER_MEMORY_MAX_LENGTH 0xFFFFFFFFu
 #define PNGPARSER_COMPRESSION_INFLATION_INDEX 0u
+#define PNGPARSER_SAMPLE_MAP_LENGTH 16u
+#define PNGPARSER_TILE_DEFAULT_SIZE 8u
+#define PNGPARSER_TILE_MAX_SIZE 4096u
+/* Samples in the scale and bias pattern of an interleaved tensor row, divisible by 1 to 4 channels. */
+#define PNGPARSER_TENSOR_PATTERN_LENGTH 24u
+
+/* Bit depths each color type allows, bit n set for a depth of n. */
+#define PNGPARSER_BIT_DEPTHS_GRAY 0x10116u
+#define PNGPARSER_BIT_DEPTHS_PALETTE 0x00116u
+#define PNGPARSER_BIT_DEPTHS_COLOR 0x10100u
+
+#define PNGPARSER_ZLIB_HEADER_LENGTH 2u
+#define PNGPARSER_ZLIB_METHOD_DEFLATE 8u
+#define PNGPARSER_ZLIB_MAX_WINDOW_BITS 15
+#define PNGPARSER_ZLIB_FLAG_DICTIONARY 0x20u
+
+#define PNGPARSER_CHUNK_FLAG_NONE 0u
+#define PNGPARSER_CHUNK_FLAG_BUFFERED 1u
+#define PNGPARSER_CHUNK_FLAG_CRC_RECEIVED 2u
 
 #ifndef PNGPARSER_MALLOC
 #define PNGPARSER_MEMCPY( dest, p, size ) memcpy( dest, p, size )
@@ -112,7 +146,8 @@ typedef enum
     PNGParser_Chunk_SRGB = SRGB_WORD,
     PNGParser_Chunk_GAMMA = GAMMA_WORD,
     PNGParser_Chunk_IDAT = IDAT_WORD,
-    PNGParser_Chunk_IEND = IEND_WORD
+    PNGParser_Chunk_IEND = IEND_WORD,
+    PNGParser_Chunk_TRNS = TRNS_WORD
 } PNGParserChunkType;
 
 typedef enum
@@ -134,9 +169,111 @@ typedef enum
     PNGParser_Error_During_Decompression,
     PNGParser_Error_Allocating_Memory,
     PNGParser_Error_Not_Supported_Interlaced_Image,
-    PNGParser_Error_General
+    PNGParser_Error_General,
+    PNGParser_Error_Output_Too_Small,
+    PNGParser_Error_Memory_Budget,
+    PNGParser_Error_Region_Outside_Image,
+    PNGParser_Error_Tile_Size
 } PNGParserResultType;
 
+typedef enum
+{
+    PNGParser_CPU_Level_Auto = 0,
+    PNGParser_CPU_Level_Scalar,
+    PNGParser_CPU_Level_SSE2,
+    PNGParser_CPU_Level_SSSE3,
+    PNGParser_CPU_Level_AVX2,
+    PNGParser_CPU_Level_AVX512
+} PNGParserCPULevelType;
+
+/* Full checks every chunk CRC inline, Parallel checks the image data CRCs on a worker thread while inflating and
+ * reports a mismatch when the fed input is handed back, Skip trusts the file and calculates no CRC at all.
+ * The worker reads the input in place, so each PNGParserFeed call waits for it before returning. Parallel only pays
+ * off when a piece holds a lot of image data, a whole file or large pieces, and gains nothing with small pieces. */
+typedef enum
+{
+    PNGParser_CRC_Mode_Full = 0,
+    PNGParser_CRC_Mode_Parallel,
+    PNGParser_CRC_Mode_Skip
+} PNGParserCRCModeType;
+
+/* 16 bit samples come out either as uint16_t in the byte order of the host, or as 8 bit with the low byte dropped.
+ * Samples of 1, 2 and 4 bits are always expanded to a byte each. */
+typedef enum
+{
+    PNGParser_Sixteen_Bit_Native = 0,
+    PNGParser_Sixteen_Bit_Narrow
+} PNGParserSixteenBitModeType;
+
+/* Palette images come out as RGB, or RGBA when they have a tRNS chunk, always as RGBA, or as the raw 8 bit indices
+ * with the palette returned next to them. */
+typedef enum
+{
+    PNGParser_Palette_Expand = 0,
+    PNGParser_Palette_Expand_RGBA,
+    PNGParser_Palette_Indices
+} PNGParserPaletteModeType;
+
+/* Pixel layout of the output. Native keeps the channels of the file as the modes above produce them. The others are
+ * 8 bit and override those modes: gray is repeated into the color channels, a missing alpha is filled with 255, RGB
+ * and BGR drop alpha, and 16 bit samples keep their high byte. */
+typedef enum
+{
+    PNGParser_Format_Native = 0,
+    PNGParser_Format_RGBA8,
+    PNGParser_Format_BGRA8,
+    PNGParser_Format_RGB8,
+    PNGParser_Format_BGR8
+} PNGParserOutputFormatType;
+
+/* Box filtered downscaling during the decode. Each output pixel is the average of a 2x2, 4x4 or 8x8 block, cut short
+ * at the right and bottom edges. The value is the log2 of the block size. Palette indices cannot be averaged, so
+ * scaled palette images are always expanded. */
+typedef enum
+{
+    PNGParser_Scale_Full = 0,
+    PNGParser_Scale_Half,
+    PNGParser_Scale_Quarter,
+    PNGParser_Scale_Eighth
+} PNGParserScaleType;
+
+/* Order of the output pixels. Tiled cuts the output into square tiles of tileSize pixels, stored one after the other
+ * row by row, each with its own rows back to back. Morton stores the pixels inside each tile in Z-order instead and
+ * needs a power of two tileSize. Tiles at the right and bottom edges are padded to full size with zeros. */
+typedef enum
+{
+    PNGParser_Layout_Linear = 0,
+    PNGParser_Layout_Tiled,
+    PNGParser_Layout_Morton
+} PNGParserLayoutType;
+
+/* Samples of the output. The float types write every sample as sample / maximum * sampleScale + sampleBias of its
+ * channel, so the defaults map to 0 to 1 and a mean and deviation normalize with 1 / deviation and -mean / deviation.
+ * Float16 is IEEE half precision, rounded to nearest even. */
+typedef enum
+{
+    PNGParser_Sample_Integer = 0,
+    PNGParser_Sample_Float32,
+    PNGParser_Sample_Float16
+} PNGParserSampleType;
+
+/* A rectangle of the image in pixels, from its top left corner. */
+typedef struct {
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+} PNGParserRectType;
+
+typedef enum
+{
+    PNGParser_Row_Copy = 0,
+    PNGParser_Row_Unpack,
+    PNGParser_Row_Sixteen_Bit,
+    PNGParser_Row_Palette,
+    PNGParser_Row_Format
+} PNGParserRowConversionType;
+
 typedef enum
 {
     PNGParser_State_None = 0,
@@ -153,7 +290,9 @@ typedef enum
 {
     PNGParser_Reading_Chunk_State_None = 0,
     PNGParser_Reading_Chunk_State_Get_Metadata,
+    PNGParser_Reading_Chunk_State_Read_Data,
     PNGParser_Reading_Chunk_State_Check_CRC32,
+    PNGParser_Reading_Chunk_State_Process,
     PNGParser_Reading_Chunk_State_Error,
     PNGParser_Reading_Chunk_State_Done,
 } PNGParserReadingChunkStateType;
@@ -166,8 +305,6 @@ typedef struct {
     uint8_t* chunkData;
 } PNGChunk;
 
-typedef vec_t( PNGChunk ) vec_PNGChunk_t;
-
 typedef struct {
     int32_t width;
     int32_t height;
@@ -183,6 +320,20 @@ typedef struct {
     uint8_t* raw_data;
 } PNGParserParameterType;
 
+/* The pixels of a pass start at ( x, y ) and repeat every xStep columns and yStep rows. */
+typedef struct {
+    uint8_t x;
+    uint8_t y;
+    uint8_t xStep;
+    uint8_t yStep;
+} PNGParserPassType;
+
+typedef struct {
+    uint32_t length;
+    uint32_t capacity;
+    uint8_t* data;
+} PNGParserStagingBufferType;
+
 typedef struct {
     uint32_t width;
     uint32_t height;
@@ -197,32 +348,211 @@ typedef struct {
     uint8_t renderingIntent;
 } PNGMetadataDataType;
 
+typedef void* ( *PNGParserAllocateFunction )( void* context, uint32_t size );
+typedef void* ( *PNGParserReallocateFunction )( void* context, void* pointer, uint32_t oldSize, uint32_t newSize );
+typedef void ( *PNGParserFreeFunction )( void* context, void* pointer, uint32_t size );
+
+/* Memory the parser and its zlib stream allocate goes through this, reallocate may be NULL to allocate, copy and
+ * free instead. */
+typedef struct {
+    PNGParserAllocateFunction allocate;
+    PNGParserReallocateFunction reallocate;
+    PNGParserFreeFunction free;
+    void* context;
+} PNGParserAllocatorType;
+
+typedef struct {
+    uint8_t* memory;
+    uint32_t capacity;
+    uint32_t used;
+    uint32_t last;
+} PNGParserArenaType;
+
+/* Rows of the output that have just been finished. pass is 0 for a plain image, which reports bands of rows as they
+ * are done. An interlaced image reports the whole frame after each of its passes 1 to 7, after pass 1 every pixel
+ * is filled with its 8x8 block as a coarse preview. Downscaled, it reports only after its last pass. A region
+ * ends the passes early once none of them has pixels left in it, and has a preview only on the 8 pixel grid. data
+ * points at firstRow in the partially filled output, it is NULL for a row callback, tiles or a tensor. */
+typedef struct {
+    uint32_t pass;
+    uint32_t firstRow;
+    uint32_t rowCount;
+    const uint8_t* data;
+    uint32_t rowStride;
+} PNGParserProgressType;
+
+typedef void ( *PNGParserProgressFunction )( void* context, const PNGParserProgressType* pProgress );
+
+/* A finished output row, handed over in order from row 0. data is only valid during the call, the same memory holds
+ * the next row. */
+typedef struct {
+    const uint8_t* data;
+    uint32_t row;
+    uint32_t width;
+    uint32_t channels;
+    uint32_t bytesPerSample;
+} PNGParserRowType;
+
+typedef void ( *PNGParserRowFunction )( void* context, const PNGParserRowType* pRow );
+
+typedef struct {
+    PNGParserCRCModeType crcMode;
+    /* With FALSE the zlib header is checked by the parser and the data is inflated raw, so the Adler-32 over the
+     * whole decompressed image is neither calculated nor compared. The chunk CRCs already cover the same bytes. */
+    BOOL checkAdler32;
+    /* Also allocates the image, which then has to be freed with PNGImageFreeWithAllocator instead of PNGImageFree. */
+    PNGParserAllocatorType allocator;
+    /* Most bytes a decode may allocate, checked against the IHDR before anything is allocated, 0 for no limit. */
+    uint64_t memoryBudget;
+    PNGParserSixteenBitModeType sixteenBitMode;
+    PNGParserPaletteModeType paletteMode;
+    PNGParserOutputFormatType outputFormat;
+    PNGParserScaleType scale;
+    /* Part of the image to decode, cut to the image, a zero width or height for all of it. The output holds only the
+     * region, downscaled in blocks from its top left corner. Once the last row of the region is out inflating stops.
+     * The rest of the IDAT chunk that row ends in is still read and its CRC checked, unless crcMode skips CRCs. The
+     * IDAT chunks after it, every chunk after the image data including IEND, and the Adler-32 of the stream are
+     * neither read nor checked. */
+    PNGParserRectType region;
+    /* Tiles are filled from each output row as it is finished, up to PNGPARSER_TILE_MAX_SIZE pixels a side. A row
+     * callback takes linear rows and ignores the layout. */
+    PNGParserLayoutType layout;
+    uint32_t tileSize;
+    /* Tensor output, the channels of the output format in planes one after the other like NCHW, or as float samples,
+     * or both. Each output row is converted as it is finished. It takes the place of a tiled layout, while a row
+     * callback always takes integer interleaved rows. */
+    PNGParserSampleType sampleType;
+    BOOL planar;
+    float sampleScale[ 4 ];
+    float sampleBias[ 4 ];
+    /* Called during the decode as output rows are finished, NULL for none. */
+    PNGParserProgressFunction progress;
+    void* progressContext;
+    /* Rows of a plain image reported per call, 0 for every row. */
+    uint32_t progressRows;
+} PNGParserOptionsType;
+
 typedef struct PNGParserInternalDataType {
     PNGParserStateType state;
     PNGParserReadingChunkStateType readingChunkState;
     PNGParserParameterType parameters;
     PNGParserResultType result;
+    PNGParserOptionsType options;
     PNGMetadataDataType imageSpec;
     uint32_t chunkCount;
     uint32_t imageDataLength;
-    uint32_t compressedLength;
     uint32_t decompressedLength;
     uint32_t maxDecompressionLength;
+    uint32_t scanLineLength;
+    uint32_t scanLineSlotLength;
+    uint32_t scanLineFilled;
+    uint32_t currentRow;
+    /* An interlaced image is read as the seven reduced images of Adam7, a plain one as a single pass. currentRow
+     * counts the rows of the current pass. */
+    const PNGParserPassType* passes;
+    uint32_t passCount;
+    uint32_t passIndex;
+    uint32_t passWidth;
+    uint32_t passHeight;
+    uint32_t progressRow;
+    PNGParserRowConversionType rowConversion;
+    uint32_t outputChannels;
+    uint32_t outputSampleBytes;
+    uint32_t outputWidth;
+    uint32_t outputHeight;
+    /* The region cut to the image, and the pixels of the current pass inside it: columns from regionColumn on and
+     * rows from regionRow up to regionRowEnd. Rows outside it are only unfiltered, as the reference for the next. */
+    PNGParserRectType region;
+    uint32_t regionColumn;
+    uint32_t regionColumns;
+    uint32_t regionRow;
+    uint32_t regionRowEnd;
+    BOOL regionDone;
+    /* Set when the stream is dropped after the region, the rest of the current IDAT only goes through its CRC. */
+    BOOL regionStopped;
+    /* Per channel sums of the pixels of each output pixel while downscaling. A plain image only needs the output row
+     * being filled, an interlaced one the whole output. */
+    uint32_t* scaleSums;
+    uint8_t sampleMap[ PNGPARSER_SAMPLE_MAP_LENGTH ];
+    /* RGBA, entries past paletteLength are opaque black. */
+    uint8_t palette[ PNGPARSER_PALETTE_MAX_ENTRIES ][ 4 ];
+    uint32_t paletteLength;
+    BOOL paletteTransparency;
+    /* The palette in the order of the output format, or the gray levels of a packed gray image widened to color. */
+    uint8_t paletteLookup[ PNGPARSER_PALETTE_MAX_ENTRIES ][ 4 ];
     uint32_t seekOffset;
-    vec_PNGChunk_t chunks;
+    uint32_t chunkBytesRead;
+    uint32_t calculatedCRC;
+    BOOL inputExhausted;
+    PNGChunk currentChunk;
+    PNGParserStagingBufferType headerStaging;
+    PNGParserStagingBufferType chunkStaging;
 
     uint8_t* imageData;
-    uint8_t* decompressionBuffer;
-    uint8_t* compressedData;
+    uint8_t* scanLineBuffer;
+    uint32_t imageDataCapacity;
+    uint32_t scanLineBufferCapacity;
+    uint8_t* outputData;
+    uint32_t outputRowStride;
+    uint8_t* destination;
+    uint32_t destinationCapacity;
+    uint32_t destinationRowStride;
+    /* Takes the rows instead of an image. outputData is then a single row, except for an interlaced image at full
+     * scale, whose rows are only final after its last pass. */
+    PNGParserRowFunction rowOutput;
+    void* rowOutputContext;
+    /* Tiles and tensors form the rows in scratch, like a row callback, and convert them into layoutData. */
+    uint8_t* layoutData;
+    BOOL emitRows;
+    /* Float scale and bias of every sample over PNGPARSER_TENSOR_PATTERN_LENGTH interleaved samples, which is a
+     * whole number of pixels for every channel count. */
+    float tensorScale[ PNGPARSER_TENSOR_PATTERN_LENGTH ];
+    float tensorBias[ PNGPARSER_TENSOR_PATTERN_LENGTH ];
+    BOOL retainResources;
+
+    z_stream inflateStream;
+    BOOL inflateStreamInitialized;
+    BOOL inflateStreamStarted;
+    BOOL inflateStreamEnded;
+    uint8_t zlibHeader[ PNGPARSER_ZLIB_HEADER_LENGTH ];
+    uint32_t zlibHeaderLength;
+
+    struct PNGParserCRCWorkerType* crcWorker;
 } PNGParserInternalDataType;
 
 typedef struct PNGParserDataType {
     PNGMetadataDataType imageSpec;
     uint32_t length;
     uint8_t* data;
+    /* Layout of data, which differs from imageSpec for palettes, depths other than 8, output formats, scaling,
+     * regions and tensors. length includes the padding of edge tiles. bytesPerSample is 4 for Float32 samples. */
+    uint32_t width;
+    uint32_t height;
+    uint32_t channels;
+    uint32_t bytesPerSample;
+    PNGParserSampleType sampleType;
+    BOOL planar;
+    /* The PLTE entries as RGBA with the tRNS alphas, for palette images in every palette mode. */
+    uint32_t paletteLength;
+    uint8_t palette[ PNGPARSER_PALETTE_MAX_ENTRIES ][ 4 ];
 } PNGImageDataType;
 
+typedef struct PNGDecoderDataType {
+    PNGParserInternalDataType parser;
+} PNGDecoderDataType;
+
+typedef struct PNGProbeDataType {
+    PNGMetadataDataType imageSpec;
+    /* Size of the output, smaller than imageSpec when the options downscale or pick a region. */
+    uint32_t width;
+    uint32_t height;
+    uint64_t scratchBytes;
+    uint64_t outputBytes;
+} PNGProbeDataType;
+
 typedef PNGParserInternalDataType PNGParser;
 typedef PNGImageDataType PNGImage;
+typedef PNGDecoderDataType PNGDecoder;
+typedef PNGProbeDataType PNGProbe;
 
 #endif//PNGPARSER_DEFS
\ No newline at end of file
@@ -0,0 +1,187 @@
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * PNGParser Portable Scanline Filter Kernels
+ */
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "PNGParserFilter.h"
+#include "PNGParserCPU.h"
+
+/***********************************************************************************************************************
+Macro definitions
+***********************************************************************************************************************/
+
+/* One specialization per pixel size, the compiler folds the constant distance into each loop. */
+#define PNGPARSER_DEFINE_SCALAR_UNFILTERS( bpp )                                                                       \
+    static void PNGParserUnfilterSub##bpp( uint8_t* row, const uint8_t* previous, uint32_t length )                    \
+    {                                                                                                                  \
+        ( void ) previous;                                                                                             \
+        PNGParserUnfilterSubScalar( row, length, bpp );                                                                \
+    }                                                                                                                  \
+    static void PNGParserUnfilterAverage##bpp( uint8_t* row, const uint8_t* previous, uint32_t length )                \
+    {                                                                                                                  \
+        PNGParserUnfilterAverageScalar( row, previous, length, bpp );                                                  \
+    }                                                                                                                  \
+    static void PNGParserUnfilterPaeth##bpp( uint8_t* row, const uint8_t* previous, uint32_t length )                  \
+    {                                                                                                                  \
+        PNGParserUnfilterPaethScalar( row, previous, length, bpp );                                                    \
+    }
+
+#define PNGPARSER_SET_SCALAR_UNFILTERS( kernels, bpp )                                                                 \
+    do {                                                                                                               \
+        PNGParserUnfilterRowFunction* entry = ( kernels )->unfilter[ PNGParserFilterBppIndex( bpp ) ];                 \
+        entry[ PNGParser_Filtering_None ] = PNGParserUnfilterNone;                                                     \
+        entry[ PNGParser_Filtering_Sub ] = PNGParserUnfilterSub##bpp;                                                  \
+        entry[ PNGParser_Filtering_Up ] = PNGParserUnfilterUp;                                                         \
+        entry[ PNGParser_Filtering_Average ] = PNGParserUnfilterAverage##bpp;                                          \
+        entry[ PNGParser_Filtering_Paeth ] = PNGParserUnfilterPaeth##bpp;                                              \
+    } while ( 0 )
+
+/***********************************************************************************************************************
+Static function Prototypes
+***********************************************************************************************************************/
+
+static uint8_t PNGParserPaethPredictor( int16_t a, int16_t b, int16_t c );
+static void PNGParserUnfilterNone( uint8_t* row, const uint8_t* previous, uint32_t length );
+static void PNGParserUnfilterUp( uint8_t* row, const uint8_t* previous, uint32_t length );
+static inline void PNGParserUnfilterSubScalar( uint8_t* row, uint32_t length, uint32_t bpp );
+static inline void PNGParserUnfilterAverageScalar( uint8_t* row, const uint8_t* previous, uint32_t length,
+                                                   uint32_t bpp );
+static inline void PNGParserUnfilterPaethScalar( uint8_t* row, const uint8_t* previous, uint32_t length,
+                                                 uint32_t bpp );
+
+/***********************************************************************************************************************
+Implementation
+***********************************************************************************************************************/
+
+static uint8_t PNGParserPaethPredictor( int16_t a, int16_t b, int16_t c )
+{
+    int thresh = c * 3 - ( a + b );
+    int lo = a < b ? a : b;
+    int hi = a < b ? b : a;
+    int t0 = ( hi <= thresh ) ? lo : c;
+    int t1 = ( thresh <= lo ) ? hi : t0;
+
+    return ( uint8_t ) t1;
+}
+
+static void PNGParserUnfilterNone( uint8_t* row, const uint8_t* previous, uint32_t length )
+{
+    ( void ) row;
+    ( void ) previous;
+    ( void ) length;
+}
+
+static void PNGParserUnfilterUp( uint8_t* row, const uint8_t* previous, uint32_t length )
+{
+    for ( uint32_t i = 0; i < length; i++ ) { row[ i ] += previous[ i ]; }
+}
+
+static inline void PNGParserUnfilterSubScalar( uint8_t* row, uint32_t length, uint32_t bpp )
+{
+    for ( uint32_t i = bpp; i < length; i++ ) { row[ i ] += row[ i - bpp ]; }
+}
+
+static inline void PNGParserUnfilterAverageScalar( uint8_t* row, const uint8_t* previous, uint32_t length,
+                                                   uint32_t bpp )
+{
+    uint32_t i = 0;
+    for ( ; i < bpp && i < length; i++ ) { row[ i ] += previous[ i ] >> 1; }
+    for ( ; i < length; i++ ) { row[ i ] += ( uint8_t ) ( ( row[ i - bpp ] + previous[ i ] ) >> 1 ); }
+}
+
+static inline void PNGParserUnfilterPaethScalar( uint8_t* row, const uint8_t* previous, uint32_t length,
+                                                 uint32_t bpp )
+{
+    uint32_t i = 0;
+    /* Without a left pixel the predictor always picks the byte above. */
+    for ( ; i < bpp && i < length; i++ ) { row[ i ] += previous[ i ]; }
+    for ( ; i < length; i++ )
+    {
+        row[ i ] += PNGParserPaethPredictor( row[ i - bpp ], previous[ i ], previous[ i - bpp ] );
+    }
+}
+
+PNGPARSER_DEFINE_SCALAR_UNFILTERS( 1 )
+PNGPARSER_DEFINE_SCALAR_UNFILTERS( 2 )
+PNGPARSER_DEFINE_SCALAR_UNFILTERS( 3 )
+PNGPARSER_DEFINE_SCALAR_UNFILTERS( 4 )
+PNGPARSER_DEFINE_SCALAR_UNFILTERS( 6 )
+PNGPARSER_DEFINE_SCALAR_UNFILTERS( 8 )
+
+uint32_t PNGParserFilterBppIndex( uint32_t bytesPerPixel )
+{
+    uint32_t index = PNGPARSER_FILTER_BPP_COUNT;
+    switch ( bytesPerPixel )
+    {
+        case 1:
+        case 2:
+        case 3:
+        case 4:
+            index = bytesPerPixel - 1;
+            break;
+        case 6:
+            index = 4;
+            break;
+        case 8:
+            index = 5;
+            break;
+        default:
+            break;
+    }
+    return index;
+}
+
+void PNGParserUnfilterKernelsScalar( PNGParserUnfilterKernelsType* kernels )
+{
+    PNGPARSER_SET_SCALAR_UNFILTERS( kernels, 1 );
+    PNGPARSER_SET_SCALAR_UNFILTERS( kernels, 2 );
+    PNGPARSER_SET_SCALAR_UNFILTERS( kernels, 3 );
+    PNGPARSER_SET_SCALAR_UNFILTERS( kernels, 4 );
+    PNGPARSER_SET_SCALAR_UNFILTERS( kernels, 6 );
+    PNGPARSER_SET_SCALAR_UNFILTERS( kernels, 8 );
+}
+
+PNGParserUnfilterRowFunction PNGParserGetUnfilterKernel( PNGParserFilteringType filter, uint32_t bytesPerPixel )
+{
+    PNGParserUnfilterRowFunction kernel = NULL;
+    uint32_t index = PNGParserFilterBppIndex( bytesPerPixel );
+
+    if ( index < PNGPARSER_FILTER_BPP_COUNT && filter < PNGPARSER_FILTER_COUNT )
+    {
+        kernel = PNGParserGetKernels()->unfilter.unfilter[ index ][ filter ];
+    }
+    return kernel;
+}
@@ -0,0 +1,103 @@
+#ifndef PNGPARSER_FILTER_HEADER
+#define PNGPARSER_FILTER_HEADER
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * PNGParser Scanline Filter Kernels
+ */
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "PNGParserDefs.h"
+
+/***********************************************************************************************************************
+Macro definitions
+***********************************************************************************************************************/
+#define PNGPARSER_FILTER_COUNT ( PNGParser_Filtering_Paeth + 1 )
+#define PNGPARSER_FILTER_BPP_COUNT 6u
+
+/***********************************************************************************************************************
+Type definitions
+***********************************************************************************************************************/
+
+/**
+ * @brief Reverses the filter of one scanline in place. previous is the unfiltered row above it, all zeros for the
+ *        first row, and the filter type byte is not part of either row.
+ */
+typedef void ( *PNGParserUnfilterRowFunction )( uint8_t* row, const uint8_t* previous, uint32_t length );
+
+typedef struct {
+    PNGParserUnfilterRowFunction unfilter[ PNGPARSER_FILTER_BPP_COUNT ][ PNGPARSER_FILTER_COUNT ];
+} PNGParserUnfilterKernelsType;
+
+/***********************************************************************************************************************
+Function prototypes
+***********************************************************************************************************************/
+
+/**
+ * @brief Maps the distance between corresponding bytes of neighbouring pixels (1, 2, 3, 4, 6 or 8) to its kernel
+ *        table index.
+ * @param bytesPerPixel 
+ * @return Index into the kernel table, PNGPARSER_FILTER_BPP_COUNT if there are no kernels for it
+ */
+extern uint32_t PNGParserFilterBppIndex( uint32_t bytesPerPixel );
+/**
+ * @brief Returns the row kernel picked for this CPU for the filter and pixel size.
+ * @param filter 
+ * @param bytesPerPixel 
+ * @return Row kernel, NULL if the pixel size is not supported
+ */
+extern PNGParserUnfilterRowFunction PNGParserGetUnfilterKernel( PNGParserFilteringType filter, uint32_t bytesPerPixel );
+/**
+ * @brief Fills the table with the portable kernels.
+ * @param kernels 
+ */
+extern void PNGParserUnfilterKernelsScalar( PNGParserUnfilterKernelsType* kernels );
+/**
+ * @brief Replaces the table entries that have SSE2 versions.
+ * @param kernels 
+ */
+extern void PNGParserUnfilterKernelsSSE2( PNGParserUnfilterKernelsType* kernels );
+/**
+ * @brief Replaces the table entries that have SSSE3 versions.
+ * @param kernels 
+ */
+extern void PNGParserUnfilterKernelsSSSE3( PNGParserUnfilterKernelsType* kernels );
+/**
+ * @brief Replaces the table entries that have AVX2 versions.
+ * @param kernels 
+ */
+extern void PNGParserUnfilterKernelsAVX2( PNGParserUnfilterKernelsType* kernels );
+
+#endif// PNGPARSER_FILTER_HEADER
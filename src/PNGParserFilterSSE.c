@@ -0,0 +1,317 @@
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * PNGParser SSE2, SSSE3 and AVX2 Scanline Filter Kernels
+ */
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "PNGParserCPU.h"
+#include "PNGParserFilter.h"
+
+#if defined( PNGPARSER_X86 )
+#include <immintrin.h>
+
+/***********************************************************************************************************************
+Macro definitions
+***********************************************************************************************************************/
+
+/* Sub is a running sum with a stride of bpp bytes, for power of two pixel sizes 16 bytes are summed at once with
+ * log2 shifted adds and the last pixel of the previous block is carried in. */
+#define PNGPARSER_DEFINE_SSE2_SUB_PREFIX( bpp )                                                                        \
+    PNGPARSER_TARGET_SSE2 static void PNGParserUnfilterSubSSE2_##bpp( uint8_t* row, const uint8_t* previous,          \
+                                                                      uint32_t length )                                \
+    {                                                                                                                  \
+        ( void ) previous;                                                                                             \
+        __m128i carry = _mm_setzero_si128();                                                                           \
+        uint32_t i = 0;                                                                                                \
+        for ( ; i + 16u <= length; i += 16u )                                                                          \
+        {                                                                                                              \
+            __m128i x = _mm_loadu_si128( ( const __m128i* ) &row[ i ] );                                               \
+            x = _mm_add_epi8( x, _mm_slli_si128( x, bpp ) );                                                           \
+            if ( 2 * bpp < 16 ) { x = _mm_add_epi8( x, _mm_slli_si128( x, 2 * bpp ) ); }                               \
+            if ( 4 * bpp < 16 ) { x = _mm_add_epi8( x, _mm_slli_si128( x, 4 * bpp ) ); }                               \
+            if ( 8 * bpp < 16 ) { x = _mm_add_epi8( x, _mm_slli_si128( x, 8 * bpp ) ); }                               \
+            x = _mm_add_epi8( x, carry );                                                                              \
+            _mm_storeu_si128( ( __m128i* ) &row[ i ], x );                                                             \
+            carry = PNGParserBroadcastLastPixel##bpp( x );                                                             \
+        }                                                                                                              \
+        if ( i == 0u ) { i = bpp; }                                                                                    \
+        for ( ; i < length; i++ ) { row[ i ] += row[ i - bpp ]; }                                                      \
+    }
+
+#define PNGPARSER_DEFINE_SSE_PIXEL_UNFILTERS( bpp )                                                                    \
+    PNGPARSER_TARGET_SSE2 static void PNGParserUnfilterSubSSE2_##bpp( uint8_t* row, const uint8_t* previous,          \
+                                                                      uint32_t length )                                \
+    {                                                                                                                  \
+        ( void ) previous;                                                                                             \
+        PNGParserUnfilterSubPixelSSE2( row, length, bpp );                                                             \
+    }
+
+#define PNGPARSER_DEFINE_SSE_PIXEL_PREDICTORS( bpp )                                                                   \
+    PNGPARSER_TARGET_SSE2 static void PNGParserUnfilterAverageSSE2_##bpp( uint8_t* row, const uint8_t* previous,      \
+                                                                          uint32_t length )                            \
+    {                                                                                                                  \
+        PNGParserUnfilterAveragePixelSSE2( row, previous, length, bpp );                                               \
+    }                                                                                                                  \
+    PNGPARSER_TARGET_SSE2 static void PNGParserUnfilterPaethSSE2_##bpp( uint8_t* row, const uint8_t* previous,        \
+                                                                        uint32_t length )                              \
+    {                                                                                                                  \
+        PNGParserUnfilterPaethPixelSSE2( row, previous, length, bpp );                                                 \
+    }
+
+#define PNGPARSER_DEFINE_SSSE3_PAETH( bpp )                                                                            \
+    PNGPARSER_TARGET_SSSE3 static void PNGParserUnfilterPaethSSSE3_##bpp( uint8_t* row, const uint8_t* previous,      \
+                                                                          uint32_t length )                            \
+    {                                                                                                                  \
+        PNGParserUnfilterPaethPixelSSSE3( row, previous, length, bpp );                                                \
+    }
+
+#define PNGPARSER_SELECT_SSE( mask, a, b ) ( _mm_or_si128( _mm_and_si128( mask, a ), _mm_andnot_si128( mask, b ) ) )
+
+/* Paeth on 16 bit lanes, the distances are |b - c|, |a - c| and |a + b - 2c| and ties favour a, then b. */
+#define PNGPARSER_PAETH_PIXEL_SSE( row, previous, length, bpp, ABS )                                                   \
+    do {                                                                                                               \
+        const __m128i zero = _mm_setzero_si128();                                                                      \
+        __m128i a = zero, c = zero;                                                                                    \
+        for ( uint32_t i = 0; i + bpp <= length; i += bpp )                                                            \
+        {                                                                                                              \
+            __m128i b = _mm_unpacklo_epi8( PNGParserLoadPixel( &previous[ i ], bpp ), zero );                          \
+            __m128i x = PNGParserLoadPixel( &row[ i ], bpp );                                                          \
+            __m128i pa = _mm_sub_epi16( b, c );                                                                        \
+            __m128i pb = _mm_sub_epi16( a, c );                                                                        \
+            __m128i pc = _mm_add_epi16( pa, pb );                                                                      \
+            pa = ABS( pa );                                                                                            \
+            pb = ABS( pb );                                                                                            \
+            pc = ABS( pc );                                                                                            \
+            __m128i smallest = _mm_min_epi16( pc, _mm_min_epi16( pa, pb ) );                                           \
+            __m128i nearest = PNGPARSER_SELECT_SSE( _mm_cmpeq_epi16( smallest, pa ), a,                                \
+                                                    PNGPARSER_SELECT_SSE( _mm_cmpeq_epi16( smallest, pb ), b, c ) );   \
+            x = _mm_add_epi8( x, _mm_packus_epi16( nearest, nearest ) );                                               \
+            PNGParserStorePixel( &row[ i ], x, bpp );                                                                  \
+            a = _mm_unpacklo_epi8( x, zero );                                                                          \
+            c = b;                                                                                                     \
+        }                                                                                                              \
+    } while ( 0 )
+
+#define PNGPARSER_ABS_SSE2( x ) ( _mm_max_epi16( ( x ), _mm_sub_epi16( _mm_setzero_si128(), ( x ) ) ) )
+#define PNGPARSER_ABS_SSSE3( x ) ( _mm_abs_epi16( x ) )
+
+/***********************************************************************************************************************
+Implementation
+***********************************************************************************************************************/
+
+/* Pixels are moved through a general register, a short copy to the stack followed by a wider vector load would stall
+ * on store forwarding once per pixel. */
+PNGPARSER_TARGET_SSE2 static inline __m128i PNGParserLoadPixel( const uint8_t* pixel, uint32_t bpp )
+{
+    uint32_t low = 0;
+    uint16_t high = 0;
+    if ( bpp >= 4u ) { PNGPARSER_MEMCPY( &low, pixel, 4u ); }
+    else { PNGPARSER_MEMCPY( &low, pixel, 2u ); }
+    if ( 3u == bpp ) { low |= ( uint32_t ) pixel[ 2 ] << 16; }
+    if ( 6u == bpp ) { PNGPARSER_MEMCPY( &high, &pixel[ 4 ], 2u ); }
+
+    uint64_t value = low | ( ( uint64_t ) high << 32 );
+    if ( 8u == bpp ) { PNGPARSER_MEMCPY( &value, pixel, 8u ); }
+    return _mm_set_epi64x( 0, ( int64_t ) value );
+}
+
+PNGPARSER_TARGET_SSE2 static inline void PNGParserStorePixel( uint8_t* pixel, __m128i value, uint32_t bpp )
+{
+    uint64_t bytes;
+    _mm_storel_epi64( ( __m128i* ) &bytes, value );
+    uint32_t low = ( uint32_t ) bytes;
+    uint16_t high = ( uint16_t ) ( bytes >> 32 );
+    if ( 8u == bpp ) { PNGPARSER_MEMCPY( pixel, &bytes, 8u ); }
+    else if ( bpp >= 4u ) { PNGPARSER_MEMCPY( pixel, &low, 4u ); }
+    else { PNGPARSER_MEMCPY( pixel, &low, 2u ); }
+    if ( 3u == bpp ) { pixel[ 2 ] = ( uint8_t ) ( low >> 16 ); }
+    if ( 6u == bpp ) { PNGPARSER_MEMCPY( &pixel[ 4 ], &high, 2u ); }
+}
+
+PNGPARSER_TARGET_SSE2 static inline __m128i PNGParserBroadcastLastPixel1( __m128i x )
+{
+    x = _mm_unpackhi_epi8( x, x );
+    x = _mm_shufflehi_epi16( x, 0xFF );
+    return _mm_unpackhi_epi64( x, x );
+}
+
+PNGPARSER_TARGET_SSE2 static inline __m128i PNGParserBroadcastLastPixel2( __m128i x )
+{
+    x = _mm_shufflehi_epi16( x, 0xFF );
+    return _mm_unpackhi_epi64( x, x );
+}
+
+PNGPARSER_TARGET_SSE2 static inline __m128i PNGParserBroadcastLastPixel4( __m128i x )
+{
+    return _mm_shuffle_epi32( x, 0xFF );
+}
+
+PNGPARSER_TARGET_SSE2 static inline __m128i PNGParserBroadcastLastPixel8( __m128i x )
+{
+    return _mm_unpackhi_epi64( x, x );
+}
+
+PNGPARSER_TARGET_SSE2 static void PNGParserUnfilterUpSSE2( uint8_t* row, const uint8_t* previous,
+                                                           uint32_t length )
+{
+    uint32_t i = 0;
+    for ( ; i + 16u <= length; i += 16u )
+    {
+        __m128i x = _mm_loadu_si128( ( const __m128i* ) &row[ i ] );
+        __m128i b = _mm_loadu_si128( ( const __m128i* ) &previous[ i ] );
+        _mm_storeu_si128( ( __m128i* ) &row[ i ], _mm_add_epi8( x, b ) );
+    }
+    for ( ; i < length; i++ ) { row[ i ] += previous[ i ]; }
+}
+
+PNGPARSER_TARGET_SSE2 static inline void PNGParserUnfilterSubPixelSSE2( uint8_t* row, uint32_t length,
+                                                                       uint32_t bpp )
+{
+    __m128i a = _mm_setzero_si128();
+    for ( uint32_t i = 0; i + bpp <= length; i += bpp )
+    {
+        a = _mm_add_epi8( PNGParserLoadPixel( &row[ i ], bpp ), a );
+        PNGParserStorePixel( &row[ i ], a, bpp );
+    }
+}
+
+PNGPARSER_TARGET_SSE2 static inline void PNGParserUnfilterAveragePixelSSE2( uint8_t* row, const uint8_t* previous,
+                                                                           uint32_t length, uint32_t bpp )
+{
+    const __m128i one = _mm_set1_epi8( 1 );
+    __m128i a = _mm_setzero_si128();
+    for ( uint32_t i = 0; i + bpp <= length; i += bpp )
+    {
+        __m128i b = PNGParserLoadPixel( &previous[ i ], bpp );
+        /* _mm_avg_epu8 rounds up, take the lost bit back off to get floor( ( a + b ) / 2 ). */
+        __m128i average = _mm_sub_epi8( _mm_avg_epu8( a, b ), _mm_and_si128( _mm_xor_si128( a, b ), one ) );
+        a = _mm_add_epi8( PNGParserLoadPixel( &row[ i ], bpp ), average );
+        PNGParserStorePixel( &row[ i ], a, bpp );
+    }
+}
+
+PNGPARSER_TARGET_SSE2 static inline void PNGParserUnfilterPaethPixelSSE2( uint8_t* row, const uint8_t* previous,
+                                                                         uint32_t length, uint32_t bpp )
+{
+    PNGPARSER_PAETH_PIXEL_SSE( row, previous, length, bpp, PNGPARSER_ABS_SSE2 );
+}
+
+PNGPARSER_DEFINE_SSE2_SUB_PREFIX( 1 )
+PNGPARSER_DEFINE_SSE2_SUB_PREFIX( 2 )
+PNGPARSER_DEFINE_SSE2_SUB_PREFIX( 4 )
+PNGPARSER_DEFINE_SSE2_SUB_PREFIX( 8 )
+PNGPARSER_DEFINE_SSE_PIXEL_UNFILTERS( 3 )
+PNGPARSER_DEFINE_SSE_PIXEL_UNFILTERS( 6 )
+PNGPARSER_DEFINE_SSE_PIXEL_PREDICTORS( 3 )
+PNGPARSER_DEFINE_SSE_PIXEL_PREDICTORS( 4 )
+PNGPARSER_DEFINE_SSE_PIXEL_PREDICTORS( 6 )
+PNGPARSER_DEFINE_SSE_PIXEL_PREDICTORS( 8 )
+
+PNGPARSER_TARGET_SSSE3 static inline void PNGParserUnfilterPaethPixelSSSE3( uint8_t* row, const uint8_t* previous,
+                                                                           uint32_t length, uint32_t bpp )
+{
+    PNGPARSER_PAETH_PIXEL_SSE( row, previous, length, bpp, PNGPARSER_ABS_SSSE3 );
+}
+
+PNGPARSER_DEFINE_SSSE3_PAETH( 3 )
+PNGPARSER_DEFINE_SSSE3_PAETH( 4 )
+PNGPARSER_DEFINE_SSSE3_PAETH( 6 )
+PNGPARSER_DEFINE_SSSE3_PAETH( 8 )
+
+PNGPARSER_TARGET_AVX2 static void PNGParserUnfilterUpAVX2( uint8_t* row, const uint8_t* previous,
+                                                           uint32_t length )
+{
+    uint32_t i = 0;
+    for ( ; i + 32u <= length; i += 32u )
+    {
+        __m256i x = _mm256_loadu_si256( ( const __m256i* ) &row[ i ] );
+        __m256i b = _mm256_loadu_si256( ( const __m256i* ) &previous[ i ] );
+        _mm256_storeu_si256( ( __m256i* ) &row[ i ], _mm256_add_epi8( x, b ) );
+    }
+    PNGParserUnfilterUpSSE2( &row[ i ], &previous[ i ], length - i );
+}
+
+void PNGParserUnfilterKernelsSSE2( PNGParserUnfilterKernelsType* kernels )
+{
+    const uint32_t pixelSizes[] = { 1, 2, 3, 4, 6, 8 };
+    for ( uint32_t i = 0; i < PNGPARSER_FILTER_BPP_COUNT; i++ )
+    {
+        kernels->unfilter[ PNGParserFilterBppIndex( pixelSizes[ i ] ) ][ PNGParser_Filtering_Up ] =
+                PNGParserUnfilterUpSSE2;
+    }
+
+    /* Average and Paeth on 1 and 2 byte pixels are a byte serial chain, the scalar kernels stay faster there. */
+    PNGParserUnfilterRowFunction* entry = kernels->unfilter[ PNGParserFilterBppIndex( 1 ) ];
+    entry[ PNGParser_Filtering_Sub ] = PNGParserUnfilterSubSSE2_1;
+    entry = kernels->unfilter[ PNGParserFilterBppIndex( 2 ) ];
+    entry[ PNGParser_Filtering_Sub ] = PNGParserUnfilterSubSSE2_2;
+    entry = kernels->unfilter[ PNGParserFilterBppIndex( 3 ) ];
+    entry[ PNGParser_Filtering_Sub ] = PNGParserUnfilterSubSSE2_3;
+    entry[ PNGParser_Filtering_Average ] = PNGParserUnfilterAverageSSE2_3;
+    entry[ PNGParser_Filtering_Paeth ] = PNGParserUnfilterPaethSSE2_3;
+    entry = kernels->unfilter[ PNGParserFilterBppIndex( 4 ) ];
+    entry[ PNGParser_Filtering_Sub ] = PNGParserUnfilterSubSSE2_4;
+    entry[ PNGParser_Filtering_Average ] = PNGParserUnfilterAverageSSE2_4;
+    entry[ PNGParser_Filtering_Paeth ] = PNGParserUnfilterPaethSSE2_4;
+    entry = kernels->unfilter[ PNGParserFilterBppIndex( 6 ) ];
+    entry[ PNGParser_Filtering_Sub ] = PNGParserUnfilterSubSSE2_6;
+    entry[ PNGParser_Filtering_Average ] = PNGParserUnfilterAverageSSE2_6;
+    entry[ PNGParser_Filtering_Paeth ] = PNGParserUnfilterPaethSSE2_6;
+    entry = kernels->unfilter[ PNGParserFilterBppIndex( 8 ) ];
+    entry[ PNGParser_Filtering_Sub ] = PNGParserUnfilterSubSSE2_8;
+    entry[ PNGParser_Filtering_Average ] = PNGParserUnfilterAverageSSE2_8;
+    entry[ PNGParser_Filtering_Paeth ] = PNGParserUnfilterPaethSSE2_8;
+}
+
+void PNGParserUnfilterKernelsSSSE3( PNGParserUnfilterKernelsType* kernels )
+{
+    kernels->unfilter[ PNGParserFilterBppIndex( 3 ) ][ PNGParser_Filtering_Paeth ] = PNGParserUnfilterPaethSSSE3_3;
+    kernels->unfilter[ PNGParserFilterBppIndex( 4 ) ][ PNGParser_Filtering_Paeth ] = PNGParserUnfilterPaethSSSE3_4;
+    kernels->unfilter[ PNGParserFilterBppIndex( 6 ) ][ PNGParser_Filtering_Paeth ] = PNGParserUnfilterPaethSSSE3_6;
+    kernels->unfilter[ PNGParserFilterBppIndex( 8 ) ][ PNGParser_Filtering_Paeth ] = PNGParserUnfilterPaethSSSE3_8;
+}
+
+void PNGParserUnfilterKernelsAVX2( PNGParserUnfilterKernelsType* kernels )
+{
+    /* Sub, Average and Paeth carry each pixel into the next one, wider vectors only pay off for Up. */
+    const uint32_t pixelSizes[] = { 1, 2, 3, 4, 6, 8 };
+    for ( uint32_t i = 0; i < PNGPARSER_FILTER_BPP_COUNT; i++ )
+    {
+        kernels->unfilter[ PNGParserFilterBppIndex( pixelSizes[ i ] ) ][ PNGParser_Filtering_Up ] =
+                PNGParserUnfilterUpAVX2;
+    }
+}
+
+#endif
@@ -0,0 +1,533 @@
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * PNGParser Portable Sample Conversion Kernels
+ */
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "PNGParserPixel.h"
+#include "PNGParserCPU.h"
+
+/***********************************************************************************************************************
+Macro definitions
+***********************************************************************************************************************/
+
+/* One specialization per bit depth, the inner loop over the samples of a byte unrolls completely. */
+#define PNGPARSER_DEFINE_SCALAR_UNPACK( bits )                                                                         \
+    static void PNGParserUnpack##bits( uint8_t* output, const uint8_t* row, uint32_t count, const uint8_t* map )      \
+    {                                                                                                                  \
+        PNGParserUnpackScalar( output, row, count, map, bits );                                                        \
+    }
+
+/* One specialization per input layout and format, so the channel loop of each pixel unrolls into fixed moves. */
+#define PNGPARSER_DEFINE_SCALAR_FORMAT( bytes, channels, format )                                                     \
+    static void PNGParserFormat##bytes##x##channels##format( uint8_t* output, const uint8_t* row, uint32_t count )   \
+    {                                                                                                                  \
+        PNGParserFormatScalar( output, row, count, bytes, channels, PNGParser_Format_##format );                      \
+    }
+
+#define PNGPARSER_DEFINE_SCALAR_FORMATS( bytes, channels )                                                            \
+    PNGPARSER_DEFINE_SCALAR_FORMAT( bytes, channels, RGBA8 )                                                          \
+    PNGPARSER_DEFINE_SCALAR_FORMAT( bytes, channels, BGRA8 )                                                          \
+    PNGPARSER_DEFINE_SCALAR_FORMAT( bytes, channels, RGB8 )                                                           \
+    PNGPARSER_DEFINE_SCALAR_FORMAT( bytes, channels, BGR8 )
+
+#define PNGPARSER_SET_SCALAR_FORMATS( kernels, bytes, channels )                                                      \
+    ( kernels )->format[ bytes - 1 ][ channels - 1 ][ 0 ] = PNGParserFormat##bytes##x##channels##RGBA8;               \
+    ( kernels )->format[ bytes - 1 ][ channels - 1 ][ 1 ] = PNGParserFormat##bytes##x##channels##BGRA8;               \
+    ( kernels )->format[ bytes - 1 ][ channels - 1 ][ 2 ] = PNGParserFormat##bytes##x##channels##RGB8;                \
+    ( kernels )->format[ bytes - 1 ][ channels - 1 ][ 3 ] = PNGParserFormat##bytes##x##channels##BGR8
+
+#define PNGPARSER_DEFINE_SCALAR_TENSOR( bytes, channels, planar, layout, type )                                       \
+    static void PNGParserTensor##bytes##x##channels##layout##type( uint8_t* output, size_t planeBytes,                \
+                                                                   const uint8_t* row, uint32_t count,                \
+                                                                   const float* scale, const float* bias )            \
+    {                                                                                                                 \
+        PNGParserTensor( output, planeBytes, row, count, scale, bias, bytes, channels, planar,                        \
+                         PNGParser_Sample_##type );                                                                   \
+    }
+
+#define PNGPARSER_DEFINE_SCALAR_TENSORS( bytes, channels )                                                            \
+    PNGPARSER_DEFINE_SCALAR_TENSOR( bytes, channels, FALSE, Pixels, Integer )                                         \
+    PNGPARSER_DEFINE_SCALAR_TENSOR( bytes, channels, FALSE, Pixels, Float32 )                                         \
+    PNGPARSER_DEFINE_SCALAR_TENSOR( bytes, channels, FALSE, Pixels, Float16 )                                         \
+    PNGPARSER_DEFINE_SCALAR_TENSOR( bytes, channels, TRUE, Planes, Integer )                                          \
+    PNGPARSER_DEFINE_SCALAR_TENSOR( bytes, channels, TRUE, Planes, Float32 )                                          \
+    PNGPARSER_DEFINE_SCALAR_TENSOR( bytes, channels, TRUE, Planes, Float16 )
+
+#define PNGPARSER_SET_SCALAR_TENSORS( kernels, bytes, channels )                                                      \
+    ( kernels )->tensor[ bytes - 1 ][ channels - 1 ][ 0 ][ 0 ] = PNGParserTensor##bytes##x##channels##PixelsInteger;  \
+    ( kernels )->tensor[ bytes - 1 ][ channels - 1 ][ 0 ][ 1 ] = PNGParserTensor##bytes##x##channels##PixelsFloat32;  \
+    ( kernels )->tensor[ bytes - 1 ][ channels - 1 ][ 0 ][ 2 ] = PNGParserTensor##bytes##x##channels##PixelsFloat16;  \
+    ( kernels )->tensor[ bytes - 1 ][ channels - 1 ][ 1 ][ 0 ] = PNGParserTensor##bytes##x##channels##PlanesInteger;  \
+    ( kernels )->tensor[ bytes - 1 ][ channels - 1 ][ 1 ][ 1 ] = PNGParserTensor##bytes##x##channels##PlanesFloat32;  \
+    ( kernels )->tensor[ bytes - 1 ][ channels - 1 ][ 1 ][ 2 ] = PNGParserTensor##bytes##x##channels##PlanesFloat16
+
+/***********************************************************************************************************************
+Static variables
+***********************************************************************************************************************/
+
+/* The input channel behind each output channel, by input channels and format. Gray repeats into R, G and B. */
+static const int8_t sPNGParserFormatSelect[ 4 ][ PNGPARSER_OUTPUT_FORMAT_COUNT ][ 4 ] = {
+        { { 0, 0, 0, PNGPARSER_FORMAT_FILL }, { 0, 0, 0, PNGPARSER_FORMAT_FILL }, { 0, 0, 0 }, { 0, 0, 0 } },
+        { { 0, 0, 0, 1 }, { 0, 0, 0, 1 }, { 0, 0, 0 }, { 0, 0, 0 } },
+        { { 0, 1, 2, PNGPARSER_FORMAT_FILL }, { 2, 1, 0, PNGPARSER_FORMAT_FILL }, { 0, 1, 2 }, { 2, 1, 0 } },
+        { { 0, 1, 2, 3 }, { 2, 1, 0, 3 }, { 0, 1, 2 }, { 2, 1, 0 } } };
+static const uint8_t sPNGParserFormatChannels[ PNGPARSER_OUTPUT_FORMAT_COUNT ] = { 4, 4, 3, 3 };
+
+/***********************************************************************************************************************
+Static function Prototypes
+***********************************************************************************************************************/
+
+static inline void PNGParserUnpackScalar( uint8_t* output, const uint8_t* row, uint32_t count, const uint8_t* map,
+                                          uint32_t bits );
+static void PNGParserSwap16Scalar( uint8_t* output, const uint8_t* row, uint32_t count );
+static void PNGParserNarrow16Scalar( uint8_t* output, const uint8_t* row, uint32_t count );
+static void PNGParserPaletteRGBScalar( uint8_t* output, const uint8_t* indices, uint32_t count,
+                                       const uint8_t* palette );
+static void PNGParserPaletteRGBAScalar( uint8_t* output, const uint8_t* indices, uint32_t count,
+                                        const uint8_t* palette );
+static inline void PNGParserScatter( uint8_t* output, const uint8_t* pixels, uint32_t count, uint32_t pixelBytes,
+                                     uint32_t step );
+static inline void PNGParserSwizzle( uint8_t* tile, const uint8_t* pixels, uint32_t count, uint32_t pixelBytes,
+                                     uint32_t row );
+static inline void PNGParserFormatScalar( uint8_t* output, const uint8_t* row, uint32_t count, uint32_t sampleBytes,
+                                          uint32_t channels, PNGParserOutputFormatType format );
+static inline void PNGParserAccumulate( uint32_t* sums, const uint8_t* pixels, uint32_t count, uint32_t channels,
+                                        uint32_t sampleBytes, uint32_t first, uint32_t step, uint32_t shift );
+static inline uint16_t PNGParserFloatToHalf( float value );
+static inline void PNGParserTensor( uint8_t* output, size_t planeBytes, const uint8_t* row, uint32_t count,
+                                    const float* scale, const float* bias, uint32_t sampleBytes, uint32_t channels,
+                                    BOOL planar, PNGParserSampleType type );
+
+/***********************************************************************************************************************
+Implementation
+***********************************************************************************************************************/
+
+static inline void PNGParserUnpackScalar( uint8_t* output, const uint8_t* row, uint32_t count, const uint8_t* map,
+                                          uint32_t bits )
+{
+    const uint32_t perByte = 8u / bits;
+    const uint32_t mask = ( 1u << bits ) - 1u;
+    uint32_t i = 0;
+    for ( ; i + perByte <= count; i += perByte )
+    {
+        uint32_t packed = *row++;
+        for ( uint32_t j = 0; j < perByte; j++ )
+        {
+            output[ i + j ] = map[ ( packed >> ( 8u - bits - bits * j ) ) & mask ];
+        }
+    }
+    /* The last byte of a row may be only partly used, its low bits are padding. */
+    for ( uint32_t shift = 8u - bits; i < count; i++, shift -= bits ) { output[ i ] = map[ ( *row >> shift ) & mask ]; }
+}
+
+static void PNGParserSwap16Scalar( uint8_t* output, const uint8_t* row, uint32_t count )
+{
+    for ( uint32_t i = 0; i < count; i++ )
+    {
+        output[ 2u * i ] = row[ 2u * i + 1u ];
+        output[ 2u * i + 1u ] = row[ 2u * i ];
+    }
+}
+
+static void PNGParserNarrow16Scalar( uint8_t* output, const uint8_t* row, uint32_t count )
+{
+    for ( uint32_t i = 0; i < count; i++ ) { output[ i ] = row[ 2u * i ]; }
+}
+
+/* Each pixel is copied as a whole entry and the next one overwrites its alpha, only the last pixel is cut to 3
+ * bytes. */
+static void PNGParserPaletteRGBScalar( uint8_t* output, const uint8_t* indices, uint32_t count,
+                                       const uint8_t* palette )
+{
+    uint32_t i = 0;
+    for ( ; i + 1u < count; i++ ) { PNGPARSER_MEMCPY( &output[ 3u * i ], &palette[ 4u * indices[ i ] ], 4u ); }
+    if ( i < count ) { PNGPARSER_MEMCPY( &output[ 3u * i ], &palette[ 4u * indices[ i ] ], 3u ); }
+}
+
+static void PNGParserPaletteRGBAScalar( uint8_t* output, const uint8_t* indices, uint32_t count,
+                                        const uint8_t* palette )
+{
+    for ( uint32_t i = 0; i < count; i++ ) { PNGPARSER_MEMCPY( &output[ 4u * i ], &palette[ 4u * indices[ i ] ], 4u ); }
+}
+
+static inline void PNGParserScatter( uint8_t* output, const uint8_t* pixels, uint32_t count, uint32_t pixelBytes,
+                                     uint32_t step )
+{
+    const uint32_t stride = pixelBytes * step;
+    for ( uint32_t i = 0; i < count; i++ )
+    {
+        PNGPARSER_MEMCPY( &output[ i * stride ], &pixels[ i * pixelBytes ], pixelBytes );
+    }
+}
+
+static inline void PNGParserSwizzle( uint8_t* tile, const uint8_t* pixels, uint32_t count, uint32_t pixelBytes,
+                                     uint32_t row )
+{
+    /* The column bits take the even bit positions of the Z-order index and the row bits the odd ones, so the two
+     * columns of a pair are neighbours. The pair offset steps by an add that carries across the row bits. */
+    const uint32_t pairMask = 0x55555554u;
+    uint32_t rowBits = row;
+    rowBits = ( rowBits | ( rowBits << 8 ) ) & 0x00FF00FFu;
+    rowBits = ( rowBits | ( rowBits << 4 ) ) & 0x0F0F0F0Fu;
+    rowBits = ( rowBits | ( rowBits << 2 ) ) & 0x33333333u;
+    rowBits = ( ( rowBits | ( rowBits << 1 ) ) & 0x55555555u ) << 1;
+
+    uint32_t pair = 0;
+    uint32_t i = 0;
+    for ( ; i + 2u <= count; i += 2u, pair = ( pair - pairMask ) & pairMask )
+    {
+        PNGPARSER_MEMCPY( &tile[ ( pair | rowBits ) * pixelBytes ], &pixels[ i * pixelBytes ], 2u * pixelBytes );
+    }
+    if ( i < count )
+    {
+        PNGPARSER_MEMCPY( &tile[ ( pair | rowBits ) * pixelBytes ], &pixels[ i * pixelBytes ], pixelBytes );
+    }
+}
+
+static inline void PNGParserFormatScalar( uint8_t* output, const uint8_t* row, uint32_t count, uint32_t sampleBytes,
+                                          uint32_t channels, PNGParserOutputFormatType format )
+{
+    const int8_t* select = sPNGParserFormatSelect[ channels - 1u ][ format - 1u ];
+    const uint32_t outputChannels = sPNGParserFormatChannels[ format - 1u ];
+    const uint32_t pixelBytes = sampleBytes * channels;
+    for ( uint32_t i = 0; i < count; i++, row += pixelBytes, output += outputChannels )
+    {
+        for ( uint32_t k = 0; k < outputChannels; k++ )
+        {
+            output[ k ] = ( PNGPARSER_FORMAT_FILL == select[ k ] ) ? 0xFFu : row[ select[ k ] * sampleBytes ];
+        }
+    }
+}
+
+static inline void PNGParserAccumulate( uint32_t* sums, const uint8_t* pixels, uint32_t count, uint32_t channels,
+                                        uint32_t sampleBytes, uint32_t first, uint32_t step, uint32_t shift )
+{
+    for ( uint32_t i = 0, x = first; i < count; i++, x += step, pixels += channels * sampleBytes )
+    {
+        uint32_t* sum = &sums[ ( x >> shift ) * channels ];
+        for ( uint32_t c = 0; c < channels; c++ )
+        {
+            if ( 2u == sampleBytes )
+            {
+                uint16_t sample;
+                PNGPARSER_MEMCPY( &sample, &pixels[ 2u * c ], 2u );
+                sum[ c ] += sample;
+            }
+            else { sum[ c ] += pixels[ c ]; }
+        }
+    }
+}
+
+/* Rounds to nearest even like F16C. A result below the normal range is rounded by adding 0.5, which leaves its
+ * mantissa in the low bits of the float, and the others by adding half an ulp of the narrower mantissa. */
+static inline uint16_t PNGParserFloatToHalf( float value )
+{
+    uint32_t bits;
+    PNGPARSER_MEMCPY( &bits, &value, 4u );
+    uint32_t sign = ( bits >> 16 ) & 0x8000u;
+    uint32_t magnitude = bits & 0x7FFFFFFFu;
+    uint32_t half;
+    if ( magnitude >= 0x47800000u ) { half = ( magnitude > 0x7F800000u ) ? 0x7E00u : 0x7C00u; }
+    else if ( magnitude < 0x38800000u )
+    {
+        float small;
+        PNGPARSER_MEMCPY( &small, &magnitude, 4u );
+        small += 0.5f;
+        PNGPARSER_MEMCPY( &half, &small, 4u );
+        half -= 0x3F000000u;
+    }
+    else
+    {
+        uint32_t odd = ( magnitude >> 13 ) & 1u;
+        half = ( magnitude + 0xC8000FFFu + odd ) >> 13;
+    }
+    return ( uint16_t ) ( sign | half );
+}
+
+static inline void PNGParserTensor( uint8_t* output, size_t planeBytes, const uint8_t* row, uint32_t count,
+                                    const float* scale, const float* bias, uint32_t sampleBytes, uint32_t channels,
+                                    BOOL planar, PNGParserSampleType type )
+{
+    const uint32_t elementBytes = ( PNGParser_Sample_Float32 == type )   ? 4u
+                                  : ( PNGParser_Sample_Float16 == type ) ? 2u
+                                                                         : sampleBytes;
+    for ( uint32_t i = 0; i < count; i++ )
+    {
+        for ( uint32_t c = 0; c < channels; c++ )
+        {
+            const uint8_t* sample = &row[ ( ( size_t ) i * channels + c ) * sampleBytes ];
+            uint8_t* element = planar ? &output[ c * planeBytes + ( size_t ) i * elementBytes ]
+                                      : &output[ ( ( size_t ) i * channels + c ) * elementBytes ];
+            if ( PNGParser_Sample_Integer == type ) { PNGPARSER_MEMCPY( element, sample, sampleBytes ); }
+            else
+            {
+                uint16_t wide = sample[ 0 ];
+                if ( 2u == sampleBytes ) { PNGPARSER_MEMCPY( &wide, sample, 2u ); }
+                float value = ( float ) wide * scale[ c ] + bias[ c ];
+                if ( PNGParser_Sample_Float32 == type ) { PNGPARSER_MEMCPY( element, &value, 4u ); }
+                else
+                {
+                    uint16_t half = PNGParserFloatToHalf( value );
+                    PNGPARSER_MEMCPY( element, &half, 2u );
+                }
+            }
+        }
+    }
+}
+
+PNGPARSER_DEFINE_SCALAR_UNPACK( 1 )
+PNGPARSER_DEFINE_SCALAR_UNPACK( 2 )
+PNGPARSER_DEFINE_SCALAR_UNPACK( 4 )
+
+PNGPARSER_DEFINE_SCALAR_FORMATS( 1, 1 )
+PNGPARSER_DEFINE_SCALAR_FORMATS( 1, 2 )
+PNGPARSER_DEFINE_SCALAR_FORMATS( 1, 3 )
+PNGPARSER_DEFINE_SCALAR_FORMATS( 1, 4 )
+PNGPARSER_DEFINE_SCALAR_FORMATS( 2, 1 )
+PNGPARSER_DEFINE_SCALAR_FORMATS( 2, 2 )
+PNGPARSER_DEFINE_SCALAR_FORMATS( 2, 3 )
+PNGPARSER_DEFINE_SCALAR_FORMATS( 2, 4 )
+
+PNGPARSER_DEFINE_SCALAR_TENSORS( 1, 1 )
+PNGPARSER_DEFINE_SCALAR_TENSORS( 1, 2 )
+PNGPARSER_DEFINE_SCALAR_TENSORS( 1, 3 )
+PNGPARSER_DEFINE_SCALAR_TENSORS( 1, 4 )
+PNGPARSER_DEFINE_SCALAR_TENSORS( 2, 1 )
+PNGPARSER_DEFINE_SCALAR_TENSORS( 2, 2 )
+PNGPARSER_DEFINE_SCALAR_TENSORS( 2, 3 )
+PNGPARSER_DEFINE_SCALAR_TENSORS( 2, 4 )
+
+uint32_t PNGParserUnpackDepthIndex( uint32_t bitDepth )
+{
+    uint32_t index = PNGPARSER_UNPACK_DEPTH_COUNT;
+    switch ( bitDepth )
+    {
+        case 1:
+            index = 0;
+            break;
+        case 2:
+            index = 1;
+            break;
+        case 4:
+            index = 2;
+            break;
+        default:
+            break;
+    }
+    return index;
+}
+
+void PNGParserPixelKernelsScalar( PNGParserPixelKernelsType* kernels )
+{
+    kernels->unpack[ PNGParserUnpackDepthIndex( 1 ) ] = PNGParserUnpack1;
+    kernels->unpack[ PNGParserUnpackDepthIndex( 2 ) ] = PNGParserUnpack2;
+    kernels->unpack[ PNGParserUnpackDepthIndex( 4 ) ] = PNGParserUnpack4;
+    kernels->swap16 = PNGParserSwap16Scalar;
+    kernels->narrow16 = PNGParserNarrow16Scalar;
+    kernels->paletteRGB = PNGParserPaletteRGBScalar;
+    kernels->paletteRGBA = PNGParserPaletteRGBAScalar;
+    PNGPARSER_SET_SCALAR_FORMATS( kernels, 1, 1 );
+    PNGPARSER_SET_SCALAR_FORMATS( kernels, 1, 2 );
+    PNGPARSER_SET_SCALAR_FORMATS( kernels, 1, 3 );
+    PNGPARSER_SET_SCALAR_FORMATS( kernels, 1, 4 );
+    PNGPARSER_SET_SCALAR_FORMATS( kernels, 2, 1 );
+    PNGPARSER_SET_SCALAR_FORMATS( kernels, 2, 2 );
+    PNGPARSER_SET_SCALAR_FORMATS( kernels, 2, 3 );
+    PNGPARSER_SET_SCALAR_FORMATS( kernels, 2, 4 );
+    PNGPARSER_SET_SCALAR_TENSORS( kernels, 1, 1 );
+    PNGPARSER_SET_SCALAR_TENSORS( kernels, 1, 2 );
+    PNGPARSER_SET_SCALAR_TENSORS( kernels, 1, 3 );
+    PNGPARSER_SET_SCALAR_TENSORS( kernels, 1, 4 );
+    PNGPARSER_SET_SCALAR_TENSORS( kernels, 2, 1 );
+    PNGPARSER_SET_SCALAR_TENSORS( kernels, 2, 2 );
+    PNGPARSER_SET_SCALAR_TENSORS( kernels, 2, 3 );
+    PNGPARSER_SET_SCALAR_TENSORS( kernels, 2, 4 );
+}
+
+PNGParserUnpackRowFunction PNGParserGetUnpackKernel( uint32_t bitDepth )
+{
+    PNGParserUnpackRowFunction kernel = NULL;
+    uint32_t index = PNGParserUnpackDepthIndex( bitDepth );
+
+    if ( index < PNGPARSER_UNPACK_DEPTH_COUNT ) { kernel = PNGParserGetKernels()->pixel.unpack[ index ]; }
+    return kernel;
+}
+
+PNGParserConvertRowFunction PNGParserGetSixteenBitKernel( PNGParserSixteenBitModeType mode )
+{
+    const PNGParserPixelKernelsType* kernels = &PNGParserGetKernels()->pixel;
+    return ( PNGParser_Sixteen_Bit_Narrow == mode ) ? kernels->narrow16 : kernels->swap16;
+}
+
+void PNGParserScatterPixels( uint8_t* output, const uint8_t* pixels, uint32_t count, uint32_t pixelBytes,
+                             uint32_t step )
+{
+    /* A constant pixel size turns each copy into a single move. */
+    switch ( pixelBytes )
+    {
+        case 1:
+            PNGParserScatter( output, pixels, count, 1, step );
+            break;
+        case 2:
+            PNGParserScatter( output, pixels, count, 2, step );
+            break;
+        case 3:
+            PNGParserScatter( output, pixels, count, 3, step );
+            break;
+        case 4:
+            PNGParserScatter( output, pixels, count, 4, step );
+            break;
+        case 6:
+            PNGParserScatter( output, pixels, count, 6, step );
+            break;
+        case 8:
+            PNGParserScatter( output, pixels, count, 8, step );
+            break;
+        default:
+            PNGParserScatter( output, pixels, count, pixelBytes, step );
+            break;
+    }
+}
+
+void PNGParserSwizzlePixels( uint8_t* tile, const uint8_t* pixels, uint32_t count, uint32_t pixelBytes,
+                             uint32_t row )
+{
+    switch ( pixelBytes )
+    {
+        case 1:
+            PNGParserSwizzle( tile, pixels, count, 1, row );
+            break;
+        case 2:
+            PNGParserSwizzle( tile, pixels, count, 2, row );
+            break;
+        case 3:
+            PNGParserSwizzle( tile, pixels, count, 3, row );
+            break;
+        case 4:
+            PNGParserSwizzle( tile, pixels, count, 4, row );
+            break;
+        case 6:
+            PNGParserSwizzle( tile, pixels, count, 6, row );
+            break;
+        case 8:
+            PNGParserSwizzle( tile, pixels, count, 8, row );
+            break;
+        default:
+            PNGParserSwizzle( tile, pixels, count, pixelBytes, row );
+            break;
+    }
+}
+
+PNGParserPaletteRowFunction PNGParserGetPaletteKernel( uint32_t channels )
+{
+    const PNGParserPixelKernelsType* kernels = &PNGParserGetKernels()->pixel;
+    return ( 4u == channels ) ? kernels->paletteRGBA : kernels->paletteRGB;
+}
+
+uint32_t PNGParserGetFormatChannels( PNGParserOutputFormatType format )
+{
+    return sPNGParserFormatChannels[ format - 1u ];
+}
+
+const int8_t* PNGParserGetFormatSelect( uint32_t channels, PNGParserOutputFormatType format )
+{
+    return sPNGParserFormatSelect[ channels - 1u ][ format - 1u ];
+}
+
+PNGParserFormatRowFunction PNGParserGetFormatKernel( uint32_t sampleBytes, uint32_t channels,
+                                                     PNGParserOutputFormatType format )
+{
+    return PNGParserGetKernels()->pixel.format[ sampleBytes - 1u ][ channels - 1u ][ format - 1u ];
+}
+
+PNGParserTensorRowFunction PNGParserGetTensorKernel( uint32_t sampleBytes, uint32_t channels, BOOL planar,
+                                                     PNGParserSampleType type )
+{
+    return PNGParserGetKernels()->pixel.tensor[ sampleBytes - 1u ][ channels - 1u ][ planar ? 1u : 0u ][ type ];
+}
+
+void PNGParserTensorPixels( uint8_t* output, size_t planeBytes, const uint8_t* row, uint32_t count, const float* scale,
+                            const float* bias, uint32_t sampleBytes, uint32_t channels, BOOL planar,
+                            PNGParserSampleType type )
+{
+    PNGParserTensor( output, planeBytes, row, count, scale, bias, sampleBytes, channels, planar, type );
+}
+
+void PNGParserAccumulatePixels( uint32_t* sums, const uint8_t* pixels, uint32_t count, uint32_t channels,
+                                uint32_t sampleBytes, uint32_t first, uint32_t step, uint32_t shift )
+{
+    /* Constant 8 bit layouts turn the channel loop into straight adds. */
+    switch ( 1u == sampleBytes ? channels : 0u )
+    {
+        case 1:
+            PNGParserAccumulate( sums, pixels, count, 1, 1, first, step, shift );
+            break;
+        case 2:
+            PNGParserAccumulate( sums, pixels, count, 2, 1, first, step, shift );
+            break;
+        case 3:
+            PNGParserAccumulate( sums, pixels, count, 3, 1, first, step, shift );
+            break;
+        case 4:
+            PNGParserAccumulate( sums, pixels, count, 4, 1, first, step, shift );
+            break;
+        default:
+            PNGParserAccumulate( sums, pixels, count, channels, sampleBytes, first, step, shift );
+            break;
+    }
+}
+
+void PNGParserAveragePixels( uint8_t* output, uint32_t* sums, uint32_t count, uint32_t channels,
+                             uint32_t sampleBytes, uint32_t width, uint32_t shift, uint32_t rows )
+{
+    for ( uint32_t i = 0; i < count; i++ )
+    {
+        uint32_t columns = width - ( i << shift );
+        if ( columns > ( 1u << shift ) ) { columns = 1u << shift; }
+        uint32_t divisor = columns * rows;
+        for ( uint32_t c = 0; c < channels; c++, sums++, output += sampleBytes )
+        {
+            uint32_t average = ( *sums + divisor / 2u ) / divisor;
+            if ( 2u == sampleBytes )
+            {
+                uint16_t sample = ( uint16_t ) average;
+                PNGPARSER_MEMCPY( output, &sample, 2u );
+            }
+            else { *output = ( uint8_t ) average; }
+            *sums = 0;
+        }
+    }
+}
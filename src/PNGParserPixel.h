@@ -0,0 +1,253 @@
+#ifndef PNGPARSER_PIXEL_HEADER
+#define PNGPARSER_PIXEL_HEADER
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * PNGParser Sample Conversion Kernels
+ */
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "PNGParserDefs.h"
+
+/***********************************************************************************************************************
+Macro definitions
+***********************************************************************************************************************/
+#define PNGPARSER_UNPACK_DEPTH_COUNT 3u
+/* The output formats other than Native. */
+#define PNGPARSER_OUTPUT_FORMAT_COUNT 4u
+/* A format channel that is not read from the input but filled with 255. */
+#define PNGPARSER_FORMAT_FILL ( -1 )
+#define PNGPARSER_SAMPLE_TYPE_COUNT 3u
+
+/***********************************************************************************************************************
+Type definitions
+***********************************************************************************************************************/
+
+/**
+ * @brief Expands count packed samples, most significant bits first, to one byte each. Every sample is replaced by
+ *        its entry in map, which has PNGPARSER_SAMPLE_MAP_LENGTH bytes.
+ */
+typedef void ( *PNGParserUnpackRowFunction )( uint8_t* output, const uint8_t* row, uint32_t count,
+                                              const uint8_t* map );
+/**
+ * @brief Converts count big endian 16 bit samples.
+ */
+typedef void ( *PNGParserConvertRowFunction )( uint8_t* output, const uint8_t* row, uint32_t count );
+/**
+ * @brief Looks up count 8 bit indices in a 256 entry RGBA palette. The indices may be the last count bytes of output
+ *        itself, every kernel reads them ahead of the pixels it writes.
+ */
+typedef void ( *PNGParserPaletteRowFunction )( uint8_t* output, const uint8_t* indices, uint32_t count,
+                                               const uint8_t* palette );
+
+/**
+ * @brief Rearranges count pixels into an 8 bit output format. 16 bit input samples are big endian and keep their high
+ *        byte.
+ */
+typedef void ( *PNGParserFormatRowFunction )( uint8_t* output, const uint8_t* row, uint32_t count );
+
+/**
+ * @brief Converts count interleaved pixels of 8 bit or host order 16 bit samples to tensor samples. A planar kernel
+ *        writes channel c at output + c * planeBytes, an interleaved one ignores planeBytes. scale and bias hold
+ *        PNGPARSER_TENSOR_PATTERN_LENGTH entries, one per interleaved sample, with the maximum sample folded into
+ *        scale.
+ */
+typedef void ( *PNGParserTensorRowFunction )( uint8_t* output, size_t planeBytes, const uint8_t* row, uint32_t count,
+                                              const float* scale, const float* bias );
+
+typedef struct {
+    PNGParserUnpackRowFunction unpack[ PNGPARSER_UNPACK_DEPTH_COUNT ];
+    /* To the byte order of the host. */
+    PNGParserConvertRowFunction swap16;
+    /* To 8 bit, keeping the high byte. */
+    PNGParserConvertRowFunction narrow16;
+    PNGParserPaletteRowFunction paletteRGB;
+    PNGParserPaletteRowFunction paletteRGBA;
+    /* By input sample bytes, input channels and output format, each counted from 1. */
+    PNGParserFormatRowFunction format[ 2 ][ 4 ][ PNGPARSER_OUTPUT_FORMAT_COUNT ];
+    /* By sample bytes and channels counted from 1, planar and sample type. */
+    PNGParserTensorRowFunction tensor[ 2 ][ 4 ][ 2 ][ PNGPARSER_SAMPLE_TYPE_COUNT ];
+} PNGParserPixelKernelsType;
+
+/***********************************************************************************************************************
+Function prototypes
+***********************************************************************************************************************/
+
+/**
+ * @brief Maps a bit depth of 1, 2 or 4 to its unpack table index.
+ * @param bitDepth 
+ * @return Index into the unpack table, PNGPARSER_UNPACK_DEPTH_COUNT for other depths
+ */
+extern uint32_t PNGParserUnpackDepthIndex( uint32_t bitDepth );
+/**
+ * @brief Returns the unpack kernel picked for this CPU for the bit depth.
+ * @param bitDepth 
+ * @return Row kernel, NULL if the depth is not packed
+ */
+extern PNGParserUnpackRowFunction PNGParserGetUnpackKernel( uint32_t bitDepth );
+/**
+ * @brief Returns the kernel picked for this CPU that converts 16 bit samples as the mode asks.
+ * @param mode 
+ * @return Row kernel
+ */
+extern PNGParserConvertRowFunction PNGParserGetSixteenBitKernel( PNGParserSixteenBitModeType mode );
+/**
+ * @brief Returns the palette kernel picked for this CPU that writes 3 or 4 channels.
+ * @param channels 
+ * @return Row kernel
+ */
+extern PNGParserPaletteRowFunction PNGParserGetPaletteKernel( uint32_t channels );
+/**
+ * @brief Returns the channel count of an output format other than Native.
+ * @param format 
+ * @return 3 or 4
+ */
+extern uint32_t PNGParserGetFormatChannels( PNGParserOutputFormatType format );
+/**
+ * @brief Returns for every channel of the output format the input channel it is read from, or PNGPARSER_FORMAT_FILL.
+ * @param channels Input channels, 1 to 4
+ * @param format Output format other than Native
+ * @return PNGParserGetFormatChannels( format ) entries
+ */
+extern const int8_t* PNGParserGetFormatSelect( uint32_t channels, PNGParserOutputFormatType format );
+/**
+ * @brief Returns the kernel picked for this CPU that converts pixels of the input layout to the output format.
+ * @param sampleBytes Input sample bytes, 1 or 2
+ * @param channels Input channels, 1 to 4
+ * @param format Output format other than Native
+ * @return Row kernel
+ */
+extern PNGParserFormatRowFunction PNGParserGetFormatKernel( uint32_t sampleBytes, uint32_t channels,
+                                                            PNGParserOutputFormatType format );
+/**
+ * @brief Returns the kernel picked for this CPU that converts pixels of the layout to tensor samples.
+ * @param sampleBytes 1 or 2
+ * @param channels 1 to 4
+ * @param planar 
+ * @param type 
+ * @return Row kernel
+ */
+extern PNGParserTensorRowFunction PNGParserGetTensorKernel( uint32_t sampleBytes, uint32_t channels, BOOL planar,
+                                                            PNGParserSampleType type );
+/**
+ * @brief Converts count pixels to tensor samples like the kernels do, for the pixels the vector loops leave over.
+ * @param output 
+ * @param planeBytes 
+ * @param row 
+ * @param count 
+ * @param scale Per channel, with the maximum sample folded in
+ * @param bias Per channel
+ * @param sampleBytes 
+ * @param channels 
+ * @param planar 
+ * @param type 
+ */
+extern void PNGParserTensorPixels( uint8_t* output, size_t planeBytes, const uint8_t* row, uint32_t count,
+                                   const float* scale, const float* bias, uint32_t sampleBytes, uint32_t channels,
+                                   BOOL planar, PNGParserSampleType type );
+/**
+ * @brief Copies count packed pixels to every step-th pixel of output.
+ * @param output 
+ * @param pixels 
+ * @param count 
+ * @param pixelBytes 
+ * @param step 
+ */
+extern void PNGParserScatterPixels( uint8_t* output, const uint8_t* pixels, uint32_t count, uint32_t pixelBytes,
+                                    uint32_t step );
+/**
+ * @brief Copies count pixels into row of a square tile stored in Z-order, from its first column on.
+ * @param tile 
+ * @param pixels 
+ * @param count At most the tile size, a power of two
+ * @param pixelBytes 
+ * @param row 
+ */
+extern void PNGParserSwizzlePixels( uint8_t* tile, const uint8_t* pixels, uint32_t count, uint32_t pixelBytes,
+                                    uint32_t row );
+/**
+ * @brief Adds count pixels, placed every step-th column from column first, to the sums of the output pixels their
+ *        columns fall into when downscaled by 2^shift.
+ * @param sums channels sums per output pixel
+ * @param pixels 8 bit or host order 16 bit samples
+ * @param count 
+ * @param channels 
+ * @param sampleBytes 
+ * @param first 
+ * @param step 
+ * @param shift 
+ */
+extern void PNGParserAccumulatePixels( uint32_t* sums, const uint8_t* pixels, uint32_t count, uint32_t channels,
+                                       uint32_t sampleBytes, uint32_t first, uint32_t step, uint32_t shift );
+/**
+ * @brief Writes the rounded averages of a row of sums and clears them for the next band.
+ * @param output count pixels of the sample size
+ * @param sums 
+ * @param count Output pixels
+ * @param channels 
+ * @param sampleBytes 
+ * @param width Columns of the full size image, the last block may be narrower
+ * @param shift 
+ * @param rows Rows summed into every block
+ */
+extern void PNGParserAveragePixels( uint8_t* output, uint32_t* sums, uint32_t count, uint32_t channels,
+                                    uint32_t sampleBytes, uint32_t width, uint32_t shift, uint32_t rows );
+/**
+ * @brief Fills the table with the portable kernels.
+ * @param kernels 
+ */
+extern void PNGParserPixelKernelsScalar( PNGParserPixelKernelsType* kernels );
+/**
+ * @brief Replaces the table entries that have SSE2 versions.
+ * @param kernels 
+ */
+extern void PNGParserPixelKernelsSSE2( PNGParserPixelKernelsType* kernels );
+/**
+ * @brief Replaces the table entries that have SSSE3 versions.
+ * @param kernels 
+ */
+extern void PNGParserPixelKernelsSSSE3( PNGParserPixelKernelsType* kernels );
+/**
+ * @brief Replaces the table entries that have AVX2 versions.
+ * @param kernels 
+ */
+extern void PNGParserPixelKernelsAVX2( PNGParserPixelKernelsType* kernels );
+/**
+ * @brief Replaces the tensor entries with AVX2 versions, which convert to half precision with F16C.
+ * @param kernels 
+ */
+extern void PNGParserPixelKernelsF16C( PNGParserPixelKernelsType* kernels );
+
+#endif// PNGPARSER_PIXEL_HEADER
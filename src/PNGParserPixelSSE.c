@@ -0,0 +1,517 @@
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * PNGParser SSE2, SSSE3, AVX2 and F16C Sample Conversion Kernels
+ */
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "PNGParserCPU.h"
+#include "PNGParserPixel.h"
+
+#if defined( PNGPARSER_X86 )
+#include <immintrin.h>
+
+/***********************************************************************************************************************
+Macro definitions
+***********************************************************************************************************************/
+
+#define PNGPARSER_DEFINE_SSSE3_FORMAT( bytes, channels, format )                                                      \
+    PNGPARSER_TARGET_SSSE3 static void PNGParserFormat##bytes##x##channels##format##SSSE3( uint8_t* output,           \
+                                                                                       const uint8_t* row,            \
+                                                                                       uint32_t count )               \
+    {                                                                                                                 \
+        PNGParserFormatSSSE3( output, row, count, bytes, channels, PNGParser_Format_##format );                       \
+    }
+
+#define PNGPARSER_DEFINE_SSSE3_FORMATS( bytes, channels )                                                             \
+    PNGPARSER_DEFINE_SSSE3_FORMAT( bytes, channels, RGBA8 )                                                           \
+    PNGPARSER_DEFINE_SSSE3_FORMAT( bytes, channels, BGRA8 )                                                           \
+    PNGPARSER_DEFINE_SSSE3_FORMAT( bytes, channels, RGB8 )                                                            \
+    PNGPARSER_DEFINE_SSSE3_FORMAT( bytes, channels, BGR8 )
+
+#define PNGPARSER_SET_SSSE3_FORMATS( kernels, bytes, channels )                                                       \
+    ( kernels )->format[ bytes - 1 ][ channels - 1 ][ 0 ] = PNGParserFormat##bytes##x##channels##RGBA8##SSSE3;        \
+    ( kernels )->format[ bytes - 1 ][ channels - 1 ][ 1 ] = PNGParserFormat##bytes##x##channels##BGRA8##SSSE3;        \
+    ( kernels )->format[ bytes - 1 ][ channels - 1 ][ 2 ] = PNGParserFormat##bytes##x##channels##RGB8##SSSE3;         \
+    ( kernels )->format[ bytes - 1 ][ channels - 1 ][ 3 ] = PNGParserFormat##bytes##x##channels##BGR8##SSSE3
+
+/* Only 8 bit samples have vector tensor kernels, 16 bit ones keep the portable kernels. */
+#define PNGPARSER_DEFINE_SSSE3_TENSOR( channels, planar, layout )                                                     \
+    PNGPARSER_TARGET_SSSE3 static void PNGParserTensor1x##channels##layout##Float32SSSE3(                             \
+            uint8_t* output, size_t planeBytes, const uint8_t* row, uint32_t count, const float* scale,               \
+            const float* bias )                                                                                       \
+    {                                                                                                                 \
+        PNGParserTensorSSSE3( output, planeBytes, row, count, scale, bias, channels, planar );                        \
+    }
+
+#define PNGPARSER_DEFINE_SSSE3_TENSORS( channels )                                                                    \
+    PNGPARSER_DEFINE_SSSE3_TENSOR( channels, FALSE, Pixels )                                                          \
+    PNGPARSER_DEFINE_SSSE3_TENSOR( channels, TRUE, Planes )
+
+#define PNGPARSER_SET_SSSE3_TENSORS( kernels, channels )                                                              \
+    ( kernels )->tensor[ 0 ][ channels - 1 ][ 0 ][ 1 ] = PNGParserTensor1x##channels##PixelsFloat32SSSE3;             \
+    ( kernels )->tensor[ 0 ][ channels - 1 ][ 1 ][ 1 ] = PNGParserTensor1x##channels##PlanesFloat32SSSE3
+
+#define PNGPARSER_DEFINE_F16C_TENSOR( channels, planar, layout, type )                                                \
+    PNGPARSER_TARGET_F16C static void PNGParserTensor1x##channels##layout##type##F16C(                                \
+            uint8_t* output, size_t planeBytes, const uint8_t* row, uint32_t count, const float* scale,               \
+            const float* bias )                                                                                       \
+    {                                                                                                                 \
+        PNGParserTensorF16C( output, planeBytes, row, count, scale, bias, channels, planar, PNGParser_Sample_##type ); \
+    }
+
+#define PNGPARSER_DEFINE_F16C_TENSORS( channels )                                                                     \
+    PNGPARSER_DEFINE_F16C_TENSOR( channels, FALSE, Pixels, Float32 )                                                  \
+    PNGPARSER_DEFINE_F16C_TENSOR( channels, FALSE, Pixels, Float16 )                                                  \
+    PNGPARSER_DEFINE_F16C_TENSOR( channels, TRUE, Planes, Float32 )                                                   \
+    PNGPARSER_DEFINE_F16C_TENSOR( channels, TRUE, Planes, Float16 )
+
+#define PNGPARSER_SET_F16C_TENSORS( kernels, channels )                                                               \
+    ( kernels )->tensor[ 0 ][ channels - 1 ][ 0 ][ 1 ] = PNGParserTensor1x##channels##PixelsFloat32F16C;              \
+    ( kernels )->tensor[ 0 ][ channels - 1 ][ 0 ][ 2 ] = PNGParserTensor1x##channels##PixelsFloat16F16C;              \
+    ( kernels )->tensor[ 0 ][ channels - 1 ][ 1 ][ 1 ] = PNGParserTensor1x##channels##PlanesFloat32F16C;              \
+    ( kernels )->tensor[ 0 ][ channels - 1 ][ 1 ][ 2 ] = PNGParserTensor1x##channels##PlanesFloat16F16C
+
+/***********************************************************************************************************************
+Static function Prototypes
+***********************************************************************************************************************/
+
+static inline void PNGParserUnpackTail( uint8_t* output, const uint8_t* row, uint32_t count, const uint8_t* map,
+                                        uint32_t bits );
+PNGPARSER_TARGET_SSSE3 static inline void PNGParserFormatSSSE3( uint8_t* output, const uint8_t* row, uint32_t count,
+                                                                uint32_t sampleBytes, uint32_t channels,
+                                                                PNGParserOutputFormatType format );
+PNGPARSER_TARGET_SSSE3 static inline void PNGParserTensorSSSE3( uint8_t* output, size_t planeBytes, const uint8_t* row,
+                                                                uint32_t count, const float* scale, const float* bias,
+                                                                uint32_t channels, BOOL planar );
+PNGPARSER_TARGET_F16C static inline void PNGParserTensorF16C( uint8_t* output, size_t planeBytes, const uint8_t* row,
+                                                              uint32_t count, const float* scale, const float* bias,
+                                                              uint32_t channels, BOOL planar,
+                                                              PNGParserSampleType type );
+
+/***********************************************************************************************************************
+Implementation
+***********************************************************************************************************************/
+
+static inline void PNGParserUnpackTail( uint8_t* output, const uint8_t* row, uint32_t count, const uint8_t* map,
+                                        uint32_t bits )
+{
+    const uint32_t mask = ( 1u << bits ) - 1u;
+    for ( uint32_t i = 0; i < count; i++ )
+    {
+        uint32_t bit = i * bits;
+        output[ i ] = map[ ( row[ bit >> 3 ] >> ( 8u - bits - ( bit & 7u ) ) ) & mask ];
+    }
+}
+
+/* Every input byte is broadcast to eight lanes and each lane tests its own bit, most significant first. The map is
+ * a 16 entry table, so PSHUFB looks up 16 samples at once. */
+PNGPARSER_TARGET_SSSE3 static void PNGParserUnpack1SSSE3( uint8_t* output, const uint8_t* row, uint32_t count,
+                                                          const uint8_t* map )
+{
+    const __m128i table = _mm_loadu_si128( ( const __m128i* ) map );
+    const __m128i bits = _mm_set_epi8( 1, 2, 4, 8, 16, 32, 64, ( char ) 0x80, 1, 2, 4, 8, 16, 32, 64, ( char ) 0x80 );
+    const __m128i pair = _mm_set_epi8( 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0 );
+    const __m128i one = _mm_set1_epi8( 1 );
+    uint32_t i = 0;
+    for ( ; i + 128u <= count; i += 128u, row += 16 )
+    {
+        __m128i x = _mm_loadu_si128( ( const __m128i* ) row );
+        for ( int32_t k = 0; k < 8; k++ )
+        {
+            __m128i spread = _mm_shuffle_epi8( x, _mm_add_epi8( pair, _mm_set1_epi8( ( char ) ( 2 * k ) ) ) );
+            __m128i sample = _mm_min_epu8( _mm_and_si128( spread, bits ), one );
+            _mm_storeu_si128( ( __m128i* ) &output[ i + 16u * k ], _mm_shuffle_epi8( table, sample ) );
+        }
+    }
+    PNGParserUnpackTail( &output[ i ], row, count - i, map, 1 );
+}
+
+/* The four 2 bit fields of every byte are shifted down into separate vectors, looked up, and interleaved back into
+ * sample order. */
+PNGPARSER_TARGET_SSSE3 static void PNGParserUnpack2SSSE3( uint8_t* output, const uint8_t* row, uint32_t count,
+                                                          const uint8_t* map )
+{
+    const __m128i table = _mm_loadu_si128( ( const __m128i* ) map );
+    const __m128i mask = _mm_set1_epi8( 3 );
+    uint32_t i = 0;
+    for ( ; i + 64u <= count; i += 64u, row += 16 )
+    {
+        __m128i x = _mm_loadu_si128( ( const __m128i* ) row );
+        __m128i a = _mm_shuffle_epi8( table, _mm_and_si128( _mm_srli_epi16( x, 6 ), mask ) );
+        __m128i b = _mm_shuffle_epi8( table, _mm_and_si128( _mm_srli_epi16( x, 4 ), mask ) );
+        __m128i c = _mm_shuffle_epi8( table, _mm_and_si128( _mm_srli_epi16( x, 2 ), mask ) );
+        __m128i d = _mm_shuffle_epi8( table, _mm_and_si128( x, mask ) );
+        __m128i abLow = _mm_unpacklo_epi8( a, b );
+        __m128i cdLow = _mm_unpacklo_epi8( c, d );
+        __m128i abHigh = _mm_unpackhi_epi8( a, b );
+        __m128i cdHigh = _mm_unpackhi_epi8( c, d );
+        _mm_storeu_si128( ( __m128i* ) &output[ i ], _mm_unpacklo_epi16( abLow, cdLow ) );
+        _mm_storeu_si128( ( __m128i* ) &output[ i + 16u ], _mm_unpackhi_epi16( abLow, cdLow ) );
+        _mm_storeu_si128( ( __m128i* ) &output[ i + 32u ], _mm_unpacklo_epi16( abHigh, cdHigh ) );
+        _mm_storeu_si128( ( __m128i* ) &output[ i + 48u ], _mm_unpackhi_epi16( abHigh, cdHigh ) );
+    }
+    PNGParserUnpackTail( &output[ i ], row, count - i, map, 2 );
+}
+
+PNGPARSER_TARGET_SSSE3 static void PNGParserUnpack4SSSE3( uint8_t* output, const uint8_t* row, uint32_t count,
+                                                          const uint8_t* map )
+{
+    const __m128i table = _mm_loadu_si128( ( const __m128i* ) map );
+    const __m128i mask = _mm_set1_epi8( 15 );
+    uint32_t i = 0;
+    for ( ; i + 32u <= count; i += 32u, row += 16 )
+    {
+        __m128i x = _mm_loadu_si128( ( const __m128i* ) row );
+        __m128i high = _mm_shuffle_epi8( table, _mm_and_si128( _mm_srli_epi16( x, 4 ), mask ) );
+        __m128i low = _mm_shuffle_epi8( table, _mm_and_si128( x, mask ) );
+        _mm_storeu_si128( ( __m128i* ) &output[ i ], _mm_unpacklo_epi8( high, low ) );
+        _mm_storeu_si128( ( __m128i* ) &output[ i + 16u ], _mm_unpackhi_epi8( high, low ) );
+    }
+    PNGParserUnpackTail( &output[ i ], row, count - i, map, 4 );
+}
+
+PNGPARSER_TARGET_SSE2 static void PNGParserSwap16SSE2( uint8_t* output, const uint8_t* row, uint32_t count )
+{
+    uint32_t i = 0;
+    for ( ; i + 8u <= count; i += 8u )
+    {
+        __m128i x = _mm_loadu_si128( ( const __m128i* ) &row[ 2u * i ] );
+        x = _mm_or_si128( _mm_slli_epi16( x, 8 ), _mm_srli_epi16( x, 8 ) );
+        _mm_storeu_si128( ( __m128i* ) &output[ 2u * i ], x );
+    }
+    for ( ; i < count; i++ )
+    {
+        output[ 2u * i ] = row[ 2u * i + 1u ];
+        output[ 2u * i + 1u ] = row[ 2u * i ];
+    }
+}
+
+/* The high byte comes first in the file, so it is the low byte of each 16 bit lane and a saturating pack keeps it. */
+PNGPARSER_TARGET_SSE2 static void PNGParserNarrow16SSE2( uint8_t* output, const uint8_t* row, uint32_t count )
+{
+    const __m128i mask = _mm_set1_epi16( 0x00FF );
+    uint32_t i = 0;
+    for ( ; i + 16u <= count; i += 16u )
+    {
+        __m128i a = _mm_and_si128( _mm_loadu_si128( ( const __m128i* ) &row[ 2u * i ] ), mask );
+        __m128i b = _mm_and_si128( _mm_loadu_si128( ( const __m128i* ) &row[ 2u * i + 16u ] ), mask );
+        _mm_storeu_si128( ( __m128i* ) &output[ i ], _mm_packus_epi16( a, b ) );
+    }
+    for ( ; i < count; i++ ) { output[ i ] = row[ 2u * i ]; }
+}
+
+/* Eight entries are gathered per step. The indices are loaded before the pixels are stored, so expanding in place
+ * from the end of the output row never overwrites an index that is still to be read. */
+PNGPARSER_TARGET_AVX2 static void PNGParserPaletteRGBAAVX2( uint8_t* output, const uint8_t* indices, uint32_t count,
+                                                            const uint8_t* palette )
+{
+    uint32_t i = 0;
+    for ( ; i + 8u <= count; i += 8u )
+    {
+        __m256i index = _mm256_cvtepu8_epi32( _mm_loadl_epi64( ( const __m128i* ) &indices[ i ] ) );
+        __m256i pixels = _mm256_i32gather_epi32( ( const int* ) palette, index, 4 );
+        _mm256_storeu_si256( ( __m256i* ) &output[ 4u * i ], pixels );
+    }
+    for ( ; i < count; i++ ) { PNGPARSER_MEMCPY( &output[ 4u * i ], &palette[ 4u * indices[ i ] ], 4u ); }
+}
+
+/* The gathered RGBA pixels lose their alpha bytes in each lane and the two 12 byte halves are moved together. */
+PNGPARSER_TARGET_AVX2 static void PNGParserPaletteRGBAVX2( uint8_t* output, const uint8_t* indices, uint32_t count,
+                                                           const uint8_t* palette )
+{
+    const __m256i dropAlpha = _mm256_setr_epi8( 0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+                                                0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1 );
+    const __m256i compact = _mm256_setr_epi32( 0, 1, 2, 4, 5, 6, 3, 7 );
+    uint32_t i = 0;
+    for ( ; i + 8u <= count; i += 8u )
+    {
+        __m256i index = _mm256_cvtepu8_epi32( _mm_loadl_epi64( ( const __m128i* ) &indices[ i ] ) );
+        __m256i pixels = _mm256_i32gather_epi32( ( const int* ) palette, index, 4 );
+        pixels = _mm256_permutevar8x32_epi32( _mm256_shuffle_epi8( pixels, dropAlpha ), compact );
+        _mm_storeu_si128( ( __m128i* ) &output[ 3u * i ], _mm256_castsi256_si128( pixels ) );
+        _mm_storel_epi64( ( __m128i* ) &output[ 3u * i + 16u ], _mm256_extracti128_si256( pixels, 1 ) );
+    }
+    for ( ; i + 1u < count; i++ ) { PNGPARSER_MEMCPY( &output[ 3u * i ], &palette[ 4u * indices[ i ] ], 4u ); }
+    if ( i < count ) { PNGPARSER_MEMCPY( &output[ 3u * i ], &palette[ 4u * indices[ i ] ], 3u ); }
+}
+
+/* A single PSHUFB moves as many whole pixels as fit into 16 bytes on both sides and an OR fills alpha. The loop runs
+ * while the full 16 byte load and store stay inside their rows, the bytes stored past the pixels of a step are
+ * written again by the next one. */
+PNGPARSER_TARGET_SSSE3 static inline void PNGParserFormatSSSE3( uint8_t* output, const uint8_t* row, uint32_t count,
+                                                                uint32_t sampleBytes, uint32_t channels,
+                                                                PNGParserOutputFormatType format )
+{
+    const int8_t* select = PNGParserGetFormatSelect( channels, format );
+    const uint32_t outputChannels = PNGParserGetFormatChannels( format );
+    const uint32_t pixelBytes = sampleBytes * channels;
+    const uint32_t widest = ( pixelBytes > outputChannels ) ? pixelBytes : outputChannels;
+    const uint32_t narrowest = ( pixelBytes < outputChannels ) ? pixelBytes : outputChannels;
+    /* Pixels moved per step, and pixels that have to be left for the 16 byte accesses. */
+    const uint32_t step = 16u / widest;
+    const uint32_t span = ( 15u + narrowest ) / narrowest;
+    int8_t shuffle[ 16 ];
+    int8_t fill[ 16 ];
+    for ( uint32_t j = 0; j < 16u; j++ )
+    {
+        shuffle[ j ] = -1;
+        fill[ j ] = 0;
+    }
+    for ( uint32_t p = 0; p < step; p++ )
+    {
+        for ( uint32_t k = 0; k < outputChannels; k++ )
+        {
+            uint32_t j = p * outputChannels + k;
+            if ( PNGPARSER_FORMAT_FILL == select[ k ] ) { fill[ j ] = -1; }
+            else { shuffle[ j ] = ( int8_t ) ( p * pixelBytes + ( uint32_t ) select[ k ] * sampleBytes ); }
+        }
+    }
+
+    const __m128i mask = _mm_loadu_si128( ( const __m128i* ) shuffle );
+    const __m128i alpha = _mm_loadu_si128( ( const __m128i* ) fill );
+    uint32_t i = 0;
+    for ( ; i + span <= count; i += step )
+    {
+        __m128i x = _mm_loadu_si128( ( const __m128i* ) &row[ i * pixelBytes ] );
+        x = _mm_or_si128( _mm_shuffle_epi8( x, mask ), alpha );
+        _mm_storeu_si128( ( __m128i* ) &output[ i * outputChannels ], x );
+    }
+    for ( ; i < count; i++ )
+    {
+        for ( uint32_t k = 0; k < outputChannels; k++ )
+        {
+            output[ i * outputChannels + k ] = ( PNGPARSER_FORMAT_FILL == select[ k ] )
+                                                       ? 0xFFu
+                                                       : row[ i * pixelBytes + ( uint32_t ) select[ k ] * sampleBytes ];
+        }
+    }
+}
+
+PNGPARSER_DEFINE_SSSE3_FORMATS( 1, 1 )
+PNGPARSER_DEFINE_SSSE3_FORMATS( 1, 2 )
+PNGPARSER_DEFINE_SSSE3_FORMATS( 1, 3 )
+PNGPARSER_DEFINE_SSSE3_FORMATS( 1, 4 )
+PNGPARSER_DEFINE_SSSE3_FORMATS( 2, 1 )
+PNGPARSER_DEFINE_SSSE3_FORMATS( 2, 2 )
+PNGPARSER_DEFINE_SSSE3_FORMATS( 2, 3 )
+PNGPARSER_DEFINE_SSSE3_FORMATS( 2, 4 )
+
+/* Each PSHUFB gathers four samples into the low bytes of four dwords, which convert straight to floats. A plane step
+ * takes four pixels of one channel, an interleaved step twelve samples, whole pixels for every channel count, so the
+ * scale and bias pattern lines up with every step. */
+PNGPARSER_TARGET_SSSE3 static inline void PNGParserTensorSSSE3( uint8_t* output, size_t planeBytes, const uint8_t* row,
+                                                                uint32_t count, const float* scale, const float* bias,
+                                                                uint32_t channels, BOOL planar )
+{
+    const uint32_t lanes = planar ? channels : 3u;
+    __m128i gather[ 4 ];
+    __m128 scales[ 4 ];
+    __m128 biases[ 4 ];
+    for ( uint32_t k = 0; k < lanes; k++ )
+    {
+        int8_t shuffle[ 16 ];
+        for ( uint32_t j = 0; j < 16u; j++ )
+        {
+            uint32_t sample = planar ? ( j >> 2 ) * channels + k : 4u * k + ( j >> 2 );
+            shuffle[ j ] = ( 0u == ( j & 3u ) ) ? ( int8_t ) sample : -1;
+        }
+        gather[ k ] = _mm_loadu_si128( ( const __m128i* ) shuffle );
+        scales[ k ] = planar ? _mm_set1_ps( scale[ k ] ) : _mm_loadu_ps( &scale[ 4u * k ] );
+        biases[ k ] = planar ? _mm_set1_ps( bias[ k ] ) : _mm_loadu_ps( &bias[ 4u * k ] );
+    }
+
+    uint32_t i = 0;
+    if ( planar )
+    {
+        /* Pixels that have to be left for the 16 byte load. */
+        const uint32_t span = ( 15u + channels ) / channels;
+        for ( ; i + span <= count; i += 4u )
+        {
+            __m128i x = _mm_loadu_si128( ( const __m128i* ) &row[ i * channels ] );
+            for ( uint32_t k = 0; k < channels; k++ )
+            {
+                __m128 value = _mm_cvtepi32_ps( _mm_shuffle_epi8( x, gather[ k ] ) );
+                value = _mm_add_ps( _mm_mul_ps( value, scales[ k ] ), biases[ k ] );
+                _mm_storeu_ps( ( float* ) &output[ k * planeBytes + ( size_t ) i * 4u ], value );
+            }
+        }
+    }
+    else
+    {
+        const uint32_t samples = count * channels;
+        uint32_t j = 0;
+        for ( ; j + 16u <= samples; j += 12u )
+        {
+            __m128i x = _mm_loadu_si128( ( const __m128i* ) &row[ j ] );
+            for ( uint32_t k = 0; k < 3u; k++ )
+            {
+                __m128 value = _mm_cvtepi32_ps( _mm_shuffle_epi8( x, gather[ k ] ) );
+                value = _mm_add_ps( _mm_mul_ps( value, scales[ k ] ), biases[ k ] );
+                _mm_storeu_ps( ( float* ) &output[ ( ( size_t ) j + 4u * k ) * 4u ], value );
+            }
+        }
+        i = j / channels;
+    }
+    PNGParserTensorPixels( &output[ ( size_t ) i * ( planar ? 4u : 4u * channels ) ], planeBytes, &row[ i * channels ],
+                           count - i, scale, bias, 1, channels, planar, PNGParser_Sample_Float32 );
+}
+
+/* Eight samples are widened to dwords per vector and F16C narrows the floats to half precision. A plane step gathers
+ * eight pixels of one channel from two loads of four, an interleaved step takes 24 samples. */
+PNGPARSER_TARGET_F16C static inline void PNGParserTensorF16C( uint8_t* output, size_t planeBytes, const uint8_t* row,
+                                                              uint32_t count, const float* scale, const float* bias,
+                                                              uint32_t channels, BOOL planar,
+                                                              PNGParserSampleType type )
+{
+    const uint32_t elementBytes = ( PNGParser_Sample_Float16 == type ) ? 2u : 4u;
+    const uint32_t lanes = planar ? channels : 3u;
+    __m128i gatherLow[ 4 ];
+    __m128i gatherHigh[ 4 ];
+    __m256 scales[ 4 ];
+    __m256 biases[ 4 ];
+    for ( uint32_t k = 0; k < lanes; k++ )
+    {
+        int8_t low[ 16 ];
+        int8_t high[ 16 ];
+        for ( uint32_t j = 0; j < 16u; j++ )
+        {
+            low[ j ] = ( j < 4u ) ? ( int8_t ) ( j * channels + k ) : -1;
+            high[ j ] = ( j >= 4u && j < 8u ) ? ( int8_t ) ( ( j - 4u ) * channels + k ) : -1;
+        }
+        gatherLow[ k ] = _mm_loadu_si128( ( const __m128i* ) low );
+        gatherHigh[ k ] = _mm_loadu_si128( ( const __m128i* ) high );
+        scales[ k ] = planar ? _mm256_set1_ps( scale[ k ] ) : _mm256_loadu_ps( &scale[ 8u * k ] );
+        biases[ k ] = planar ? _mm256_set1_ps( bias[ k ] ) : _mm256_loadu_ps( &bias[ 8u * k ] );
+    }
+
+    uint32_t i = 0;
+    if ( planar )
+    {
+        /* Pixels that have to be left for the second 16 byte load. */
+        const uint32_t span = 4u + ( 15u + channels ) / channels;
+        for ( ; i + span <= count; i += 8u )
+        {
+            __m128i low = _mm_loadu_si128( ( const __m128i* ) &row[ i * channels ] );
+            __m128i high = _mm_loadu_si128( ( const __m128i* ) &row[ ( i + 4u ) * channels ] );
+            for ( uint32_t k = 0; k < channels; k++ )
+            {
+                __m128i bytes = _mm_or_si128( _mm_shuffle_epi8( low, gatherLow[ k ] ),
+                                              _mm_shuffle_epi8( high, gatherHigh[ k ] ) );
+                __m256 value = _mm256_cvtepi32_ps( _mm256_cvtepu8_epi32( bytes ) );
+                value = _mm256_add_ps( _mm256_mul_ps( value, scales[ k ] ), biases[ k ] );
+                uint8_t* element = &output[ k * planeBytes + ( size_t ) i * elementBytes ];
+                if ( PNGParser_Sample_Float16 == type )
+                {
+                    _mm_storeu_si128( ( __m128i* ) element, _mm256_cvtps_ph( value, _MM_FROUND_TO_NEAREST_INT ) );
+                }
+                else { _mm256_storeu_ps( ( float* ) element, value ); }
+            }
+        }
+    }
+    else
+    {
+        const uint32_t samples = count * channels;
+        uint32_t j = 0;
+        for ( ; j + 24u <= samples; j += 24u )
+        {
+            for ( uint32_t k = 0; k < 3u; k++ )
+            {
+                __m128i bytes = _mm_loadl_epi64( ( const __m128i* ) &row[ j + 8u * k ] );
+                __m256 value = _mm256_cvtepi32_ps( _mm256_cvtepu8_epi32( bytes ) );
+                value = _mm256_add_ps( _mm256_mul_ps( value, scales[ k ] ), biases[ k ] );
+                uint8_t* element = &output[ ( ( size_t ) j + 8u * k ) * elementBytes ];
+                if ( PNGParser_Sample_Float16 == type )
+                {
+                    _mm_storeu_si128( ( __m128i* ) element, _mm256_cvtps_ph( value, _MM_FROUND_TO_NEAREST_INT ) );
+                }
+                else { _mm256_storeu_ps( ( float* ) element, value ); }
+            }
+        }
+        i = j / channels;
+    }
+    PNGParserTensorPixels( &output[ ( size_t ) i * ( planar ? 1u : channels ) * elementBytes ], planeBytes,
+                           &row[ i * channels ], count - i, scale, bias, 1, channels, planar, type );
+}
+
+PNGPARSER_DEFINE_SSSE3_TENSORS( 1 )
+PNGPARSER_DEFINE_SSSE3_TENSORS( 2 )
+PNGPARSER_DEFINE_SSSE3_TENSORS( 3 )
+PNGPARSER_DEFINE_SSSE3_TENSORS( 4 )
+
+PNGPARSER_DEFINE_F16C_TENSORS( 1 )
+PNGPARSER_DEFINE_F16C_TENSORS( 2 )
+PNGPARSER_DEFINE_F16C_TENSORS( 3 )
+PNGPARSER_DEFINE_F16C_TENSORS( 4 )
+
+void PNGParserPixelKernelsSSE2( PNGParserPixelKernelsType* kernels )
+{
+    kernels->swap16 = PNGParserSwap16SSE2;
+    kernels->narrow16 = PNGParserNarrow16SSE2;
+}
+
+void PNGParserPixelKernelsSSSE3( PNGParserPixelKernelsType* kernels )
+{
+    kernels->unpack[ PNGParserUnpackDepthIndex( 1 ) ] = PNGParserUnpack1SSSE3;
+    kernels->unpack[ PNGParserUnpackDepthIndex( 2 ) ] = PNGParserUnpack2SSSE3;
+    kernels->unpack[ PNGParserUnpackDepthIndex( 4 ) ] = PNGParserUnpack4SSSE3;
+    PNGPARSER_SET_SSSE3_FORMATS( kernels, 1, 1 );
+    PNGPARSER_SET_SSSE3_FORMATS( kernels, 1, 2 );
+    PNGPARSER_SET_SSSE3_FORMATS( kernels, 1, 3 );
+    PNGPARSER_SET_SSSE3_FORMATS( kernels, 1, 4 );
+    PNGPARSER_SET_SSSE3_FORMATS( kernels, 2, 1 );
+    PNGPARSER_SET_SSSE3_FORMATS( kernels, 2, 2 );
+    PNGPARSER_SET_SSSE3_FORMATS( kernels, 2, 3 );
+    PNGPARSER_SET_SSSE3_FORMATS( kernels, 2, 4 );
+    PNGPARSER_SET_SSSE3_TENSORS( kernels, 1 );
+    PNGPARSER_SET_SSSE3_TENSORS( kernels, 2 );
+    PNGPARSER_SET_SSSE3_TENSORS( kernels, 3 );
+    PNGPARSER_SET_SSSE3_TENSORS( kernels, 4 );
+}
+
+void PNGParserPixelKernelsAVX2( PNGParserPixelKernelsType* kernels )
+{
+    kernels->paletteRGB = PNGParserPaletteRGBAVX2;
+    kernels->paletteRGBA = PNGParserPaletteRGBAAVX2;
+}
+
+void PNGParserPixelKernelsF16C( PNGParserPixelKernelsType* kernels )
+{
+    PNGPARSER_SET_F16C_TENSORS( kernels, 1 );
+    PNGPARSER_SET_F16C_TENSORS( kernels, 2 );
+    PNGPARSER_SET_F16C_TENSORS( kernels, 3 );
+    PNGPARSER_SET_F16C_TENSORS( kernels, 4 );
+}
+
+#endif
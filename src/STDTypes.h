@@ -41,6 +41,11 @@
 Platform specific std type definitions
 ***********************************************************************************************************************/
 
+/* Pull in the hosted typedefs first so the system headers included after this one do not collide with the macros. */
+#if defined( __STDC_HOSTED__ ) && ( __STDC_HOSTED__ == 1 )
+#include <stdint.h>
+#endif
+
 #define BOOL char
 #define TRUE 1u == 1u
 #define FALSE 1u == 0u
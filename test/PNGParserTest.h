@@ -0,0 +1,120 @@
+#ifndef PNGPARSER_TEST_HEADER
+#define PNGPARSER_TEST_HEADER
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * PNGParser Test Helpers
+ */
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "PNGParser.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/***********************************************************************************************************************
+Macro definitions
+***********************************************************************************************************************/
+
+/* Counts and reports a failed check, the test goes on so one run shows every failure. */
+#define PNGPARSER_TEST_CHECK( condition, ... )                                                                         \
+    do {                                                                                                               \
+        if ( !( condition ) )                                                                                          \
+        {                                                                                                              \
+            printf( "%s:%d: ", __FILE__, __LINE__ );                                                                   \
+            printf( __VA_ARGS__ );                                                                                     \
+            printf( "\n" );                                                                                            \
+            sPNGParserTestFailures++;                                                                                  \
+        }                                                                                                              \
+    } while ( 0 )
+
+/***********************************************************************************************************************
+Static variables
+***********************************************************************************************************************/
+static uint32_t sPNGParserTestFailures = 0;
+static uint32_t sPNGParserTestRandomState = 0x2545F491u;
+
+static const char* sPNGParserTestLevelNames[] = { "Auto", "Scalar", "SSE2", "SSSE3", "AVX2", "AVX512" };
+
+/***********************************************************************************************************************
+Implementation
+***********************************************************************************************************************/
+
+/**
+ * @brief Xorshift, the same sequence on every run so a failure can be reproduced.
+ * @return 
+ */
+static inline uint32_t PNGParserTestRandom( void )
+{
+    sPNGParserTestRandomState ^= sPNGParserTestRandomState << 13;
+    sPNGParserTestRandomState ^= sPNGParserTestRandomState >> 17;
+    sPNGParserTestRandomState ^= sPNGParserTestRandomState << 5;
+    return sPNGParserTestRandomState;
+}
+
+static inline void PNGParserTestFill( uint8_t* buffer, uint32_t length )
+{
+    for ( uint32_t i = 0; i < length; i++ ) { buffer[ i ] = ( uint8_t ) ( PNGParserTestRandom() >> 24 ); }
+}
+
+/**
+ * @brief Allocates exactly length bytes, at least one, so reads and writes past the end show up under a sanitizer.
+ * @param length 
+ * @return 
+ */
+static inline uint8_t* PNGParserTestAllocate( uint32_t length )
+{
+    uint8_t* buffer = ( uint8_t* ) malloc( length ? length : 1u );
+    if ( NULL == buffer )
+    {
+        printf( "Out of memory\n" );
+        exit( EXIT_FAILURE );
+    }
+    return buffer;
+}
+
+static inline int PNGParserTestReport( const char* name )
+{
+    if ( sPNGParserTestFailures )
+    {
+        printf( "%s: %u checks failed\n", name, sPNGParserTestFailures );
+        return EXIT_FAILURE;
+    }
+    printf( "%s: passed\n", name );
+    return EXIT_SUCCESS;
+}
+
+#endif// PNGPARSER_TEST_HEADER
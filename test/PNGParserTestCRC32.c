@@ -0,0 +1,119 @@
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * PNGParser CRC32 Tests, every CPU level against zlib
+ */
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "PNGParserTest.h"
+
+#include <zlib.h>
+
+/***********************************************************************************************************************
+Macro definitions
+***********************************************************************************************************************/
+#define PNGPARSER_TEST_MAX_LENGTH 300u
+#define PNGPARSER_TEST_MAX_OFFSET 16u
+/* Long enough for the folding loops of every level to run many times. */
+#define PNGPARSER_TEST_LONG_LENGTH 70000u
+
+/***********************************************************************************************************************
+Static function Prototypes
+***********************************************************************************************************************/
+static void PNGParserTestCRC32( uint8_t* buffer );
+
+/***********************************************************************************************************************
+Implementation
+***********************************************************************************************************************/
+int main( void )
+{
+    uint8_t* buffer = PNGParserTestAllocate( PNGPARSER_TEST_LONG_LENGTH + PNGPARSER_TEST_MAX_OFFSET );
+    PNGParserTestFill( buffer, PNGPARSER_TEST_LONG_LENGTH + PNGPARSER_TEST_MAX_OFFSET );
+
+    for ( uint32_t level = PNGParser_CPU_Level_Scalar; level <= PNGParser_CPU_Level_AVX512; level++ )
+    {
+        PNGParserCPULevelType picked = PNGParserInitCPU( ( PNGParserCPULevelType ) level );
+        if ( picked != level )
+        {
+            printf( "%s: not supported by this CPU\n", sPNGParserTestLevelNames[ level ] );
+            continue;
+        }
+        uint32_t failures = sPNGParserTestFailures;
+        PNGParserTestCRC32( buffer );
+        printf( "%s: %s\n", sPNGParserTestLevelNames[ level ],
+                ( failures == sPNGParserTestFailures ) ? "ok" : "failed" );
+    }
+    PNGParserInitCPU( PNGParser_CPU_Level_Auto );
+
+    free( buffer );
+    return PNGParserTestReport( "CRC32" );
+}
+
+static void PNGParserTestCRC32( uint8_t* buffer )
+{
+    for ( uint32_t offset = 0; offset < PNGPARSER_TEST_MAX_OFFSET; offset++ )
+    {
+        for ( uint32_t length = 0; length <= PNGPARSER_TEST_MAX_LENGTH; length++ )
+        {
+            /* A copy of exactly length bytes, so a kernel reading past the end shows up under a sanitizer. */
+            uint8_t* data = PNGParserTestAllocate( length + offset ) + offset;
+            memcpy( data, buffer + offset, length );
+
+            uint32_t expected = ( uint32_t ) crc32( 0, data, length );
+            uint32_t actual = CRC32Update( 0, data, length );
+            PNGPARSER_TEST_CHECK( expected == actual, "length %u offset %u: %08X, zlib %08X", length, offset, actual,
+                                  expected );
+
+            /* Split in two updates, the way a chunk arrives in pieces. */
+            uint32_t split = length ? PNGParserTestRandom() % length : 0u;
+            actual = CRC32Update( CRC32Update( 0, data, split ), data + split, length - split );
+            PNGPARSER_TEST_CHECK( expected == actual, "length %u offset %u split at %u: %08X, zlib %08X", length,
+                                  offset, split, actual, expected );
+
+            free( data - offset );
+        }
+
+        uint8_t* data = buffer + offset;
+        uint32_t expected = ( uint32_t ) crc32( 0, data, PNGPARSER_TEST_LONG_LENGTH );
+        uint32_t actual = CRC32Update( 0, data, PNGPARSER_TEST_LONG_LENGTH );
+        PNGPARSER_TEST_CHECK( expected == actual, "length %u offset %u: %08X, zlib %08X", PNGPARSER_TEST_LONG_LENGTH,
+                              offset, actual, expected );
+    }
+
+    /* CRC32 is the same as an update from zero. */
+    uint32_t expected = ( uint32_t ) crc32( 0, buffer, PNGPARSER_TEST_MAX_LENGTH );
+    uint32_t actual = CRC32( buffer, PNGPARSER_TEST_MAX_LENGTH );
+    PNGPARSER_TEST_CHECK( expected == actual, "CRC32 %08X, zlib %08X", actual, expected );
+}
@@ -0,0 +1,1607 @@
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * PNGParser Decode Tests, generated images against a reference
+ */
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "PNGParserTest.h"
+
+#include <zlib.h>
+
+/***********************************************************************************************************************
+Macro definitions
+***********************************************************************************************************************/
+#define PNGPARSER_TEST_IMAGES_PER_FORMAT 12u
+#define PNGPARSER_TEST_MAX_WIDTH 40u
+#define PNGPARSER_TEST_MAX_HEIGHT 24u
+#define PNGPARSER_TEST_FORMAT_COUNT ( sizeof( sPNGParserTestFormats ) / sizeof( sPNGParserTestFormats[ 0 ] ) )
+/* IDAT chunks of random sizes, so rows and the zlib stream cross chunk boundaries. */
+#define PNGPARSER_TEST_IDAT_RANDOM 0u
+/* Several IDAT chunks for the 64x64 RGB image of the region errors. */
+#define PNGPARSER_TEST_REGION_IDAT_LENGTH 1024u
+#define PNGPARSER_TEST_SIGNATURE_LENGTH 8u
+/* Length, type and CRC around the data of a chunk. */
+#define PNGPARSER_TEST_CHUNK_OVERHEAD 12u
+#define PNGPARSER_TEST_MAX_PIECE 64u
+#define PNGPARSER_TEST_DECODER_IMAGES 16u
+#define PNGPARSER_TEST_MAX_PADDING 8u
+/* Written around the rows of PNGParseInto, none of it may change. */
+#define PNGPARSER_TEST_SENTINEL 0xA5u
+#define PNGPARSER_TEST_GUARD_LENGTH 16u
+/* Enough for the image, the scanlines and the 32K inflate window of the largest test image. */
+#define PNGPARSER_TEST_ARENA_CAPACITY ( 256u * 1024u )
+
+/***********************************************************************************************************************
+Type definitions
+***********************************************************************************************************************/
+typedef struct {
+    uint32_t width;
+    uint32_t height;
+    uint8_t colorType;
+    uint8_t bitDepth;
+    uint8_t interlaceMethod;
+    uint32_t channels;
+    /* One entry per sample of the file, palette indices for palette images. */
+    uint16_t* samples;
+    uint32_t paletteLength;
+    uint8_t palette[ PNGPARSER_PALETTE_MAX_ENTRIES ][ 3 ];
+    uint32_t transparencyLength;
+    uint8_t transparency[ PNGPARSER_PALETTE_MAX_ENTRIES ];
+} PNGParserTestImageType;
+
+typedef struct {
+    uint8_t* data;
+    uint32_t length;
+    uint32_t capacity;
+} PNGParserTestBufferType;
+
+/* What a decode has to produce. */
+/* Counts the live allocations and their bytes, and fails the allocation numbered failAt, 0 for none. */
+typedef struct {
+    uint32_t calls;
+    uint32_t failAt;
+    int32_t live;
+    uint64_t bytes;
+    uint64_t peakBytes;
+} PNGParserTestAllocatorType;
+
+typedef struct {
+    uint32_t width;
+    uint32_t height;
+    uint32_t channels;
+    uint32_t bytesPerSample;
+    uint32_t length;
+    uint8_t* data;
+} PNGParserTestOutputType;
+
+/* What the progress callback has seen of a decode so far. */
+typedef struct {
+    const PNGParserTestOutputType* expected;
+    const uint8_t* destination;
+    uint32_t bandRows;
+    uint32_t nextRow;
+    uint32_t lastPass;
+    uint32_t calls;
+    BOOL complete;
+} PNGParserTestProgressType;
+
+/* The rows a row callback has been handed so far. */
+typedef struct {
+    const PNGParserTestOutputType* expected;
+    uint32_t nextRow;
+    BOOL matches;
+} PNGParserTestRowsType;
+
+/***********************************************************************************************************************
+Static variables
+***********************************************************************************************************************/
+/* Color type and bit depth of every format tested. */
+static const uint8_t sPNGParserTestFormats[][ 2 ] = {
+        { 0, 1 }, { 0, 2 }, { 0, 4 }, { 0, 8 }, { 0, 16 }, { 2, 8 }, { 2, 16 }, { 3, 1 },
+        { 3, 2 }, { 3, 4 }, { 3, 8 }, { 4, 8 }, { 4, 16 }, { 6, 8 }, { 6, 16 },
+};
+
+static const char* const sPNGParserTestFormatNames[] = { "native", "RGBA8", "BGRA8", "RGB8", "BGR8" };
+static const char* const sPNGParserTestSampleTypeNames[] = { "planar integer tensor", "float tensor",
+                                                              "half float tensor" };
+
+/* First column, first row, column step and row step of each Adam7 pass. */
+static const uint8_t sPNGParserTestAdam7[ PNGPARSER_ADAM7_PASS_COUNT ][ 4 ] = {
+        { 0, 0, 8, 8 }, { 4, 0, 8, 8 }, { 0, 4, 4, 8 }, { 2, 0, 4, 4 }, { 0, 2, 2, 4 }, { 1, 0, 2, 2 }, { 0, 1, 1, 2 },
+};
+
+/***********************************************************************************************************************
+Static function Prototypes
+***********************************************************************************************************************/
+static void PNGParserTestCreateImage( PNGParserTestImageType* image, uint8_t colorType, uint8_t bitDepth,
+                                      uint32_t width, uint32_t height, uint8_t interlaceMethod );
+static void PNGParserTestEncode( const PNGParserTestImageType* image, PNGParserTestBufferType* file,
+                                 uint32_t idatLength );
+static void PNGParserTestAppend( PNGParserTestBufferType* buffer, const void* data, uint32_t length );
+static void PNGParserTestAppendWord( PNGParserTestBufferType* buffer, uint32_t word );
+static void PNGParserTestAppendChunk( PNGParserTestBufferType* file, const char* type, const uint8_t* data,
+                                      uint32_t length );
+static uint32_t PNGParserTestChunkLength( const PNGParserTestBufferType* file, uint32_t offset );
+static uint32_t PNGParserTestFindChunk( const PNGParserTestBufferType* file, const char* type );
+static void PNGParserTestUpdateCRC( PNGParserTestBufferType* file, uint32_t offset );
+static void PNGParserTestInsertChunk( PNGParserTestBufferType* file, uint32_t offset, const char* type,
+                                      const uint8_t* data, uint32_t length );
+static void PNGParserTestFilterRow( uint8_t* filtered, const uint8_t* row, const uint8_t* previous, uint32_t length,
+                                    uint32_t bpp, uint8_t filter );
+static uint32_t PNGParserTestOutputChannels( const PNGParserTestImageType* image,
+                                             const PNGParserOptionsType* options );
+static uint32_t PNGParserTestSample( const PNGParserTestImageType* image, const PNGParserOptionsType* options,
+                                     uint32_t x, uint32_t y, uint32_t channel );
+static void PNGParserTestReference( const PNGParserTestImageType* image, const PNGParserOptionsType* options,
+                                    PNGParserTestOutputType* expected );
+static void PNGParserTestTile( const PNGParserOptionsType* options, PNGParserTestOutputType* expected );
+static void PNGParserTestCheck( const PNGParserTestImageType* image, const PNGParserOptionsType* options,
+                                PNGParserResultType result, const PNGImage* decoded, const char* name );
+static void PNGParserTestDecode( const PNGParserTestImageType* image, PNGParserTestBufferType* file,
+                                 const PNGParserOptionsType* options, const char* name );
+static PNGParserResultType PNGParserTestFeed( PNGParserTestBufferType* file, const PNGParserOptionsType* options,
+                                              PNGImage* decoded );
+static void PNGParserTestDecodeInPieces( const PNGParserTestImageType* image, PNGParserTestBufferType* file,
+                                         const PNGParserOptionsType* options, const char* name );
+static void PNGParserTestDecodeInto( const PNGParserTestImageType* image, PNGParserTestBufferType* file,
+                                     const PNGParserOptionsType* options, uint32_t padding, const char* name );
+static void PNGParserTestProbe( const PNGParserTestImageType* image, PNGParserTestBufferType* file,
+                                const PNGParserOptionsType* options, const char* name );
+static void PNGParserTestExpectProbeError( PNGParserTestBufferType* file, const PNGParserOptionsType* options,
+                                           PNGParserResultType expected, const char* name );
+static void PNGParserTestBudget( const PNGParserTestImageType* image, PNGParserTestBufferType* file,
+                                 const PNGParserOptionsType* options );
+static void PNGParserTestOnProgress( void* context, const PNGParserProgressType* pProgress );
+static void PNGParserTestProgress( const PNGParserTestImageType* image, PNGParserTestBufferType* file,
+                                   const PNGParserOptionsType* options, uint32_t bandRows );
+static void PNGParserTestOnRow( void* context, const PNGParserRowType* pRow );
+static void PNGParserTestCheckRows( const PNGParserTestImageType* image, const PNGParserTestRowsType* rows,
+                                    PNGParserResultType result, const PNGImage* decoded, const char* name );
+static void PNGParserTestRows( const PNGParserTestImageType* image, PNGParserTestBufferType* file,
+                               const PNGParserOptionsType* options, const char* name );
+static void PNGParserTestTiles( const PNGParserTestImageType* image, PNGParserTestBufferType* file,
+                                const PNGParserOptionsType* options, const char* name );
+static float PNGParserTestHalfToFloat( uint16_t half );
+static BOOL PNGParserTestTensorMatches( const PNGParserOptionsType* options, const PNGParserTestOutputType* expected,
+                                       const uint8_t* data );
+static void PNGParserTestTensor( const PNGParserTestImageType* image, PNGParserTestBufferType* file,
+                                 const PNGParserOptionsType* options, const char* name );
+static void PNGParserTestImage( const PNGParserTestImageType* image );
+static void PNGParserTestExpectError( PNGParserTestBufferType* file, const PNGParserOptionsType* options,
+                                      PNGParserResultType expected, const char* name );
+static void PNGParserTestErrors( void );
+static void PNGParserTestRegionErrors( uint8_t interlaceMethod );
+static void PNGParserTestDecoder( PNGParserCRCModeType crcMode );
+static void* PNGParserTestAllocatorAllocate( void* context, uint32_t size );
+static void* PNGParserTestAllocatorReallocate( void* context, void* pointer, uint32_t oldSize, uint32_t newSize );
+static void PNGParserTestAllocatorFree( void* context, void* pointer, uint32_t size );
+static void PNGParserTestAllocators( uint8_t interlaceMethod );
+
+/***********************************************************************************************************************
+Implementation
+***********************************************************************************************************************/
+int main( void )
+{
+    for ( uint32_t level = PNGParser_CPU_Level_Auto; level <= PNGParser_CPU_Level_Scalar; level++ )
+    {
+        PNGParserCPULevelType picked = PNGParserInitCPU( ( PNGParserCPULevelType ) level );
+        uint32_t failures = sPNGParserTestFailures;
+
+        for ( uint32_t format = 0; format < PNGPARSER_TEST_FORMAT_COUNT; format++ )
+        {
+            for ( uint32_t i = 0; i < PNGPARSER_TEST_IMAGES_PER_FORMAT; i++ )
+            {
+                /* The first images are the edge cases, a single pixel and sizes where Adam7 passes are empty. */
+                uint32_t width = 1u + PNGParserTestRandom() % PNGPARSER_TEST_MAX_WIDTH;
+                uint32_t height = 1u + PNGParserTestRandom() % PNGPARSER_TEST_MAX_HEIGHT;
+                if ( i < 2u )
+                {
+                    width = ( 0u == i ) ? 1u : 5u;
+                    height = ( 0u == i ) ? 1u : 3u;
+                }
+                PNGParserTestImageType image;
+                PNGParserTestCreateImage( &image, sPNGParserTestFormats[ format ][ 0 ],
+                                          sPNGParserTestFormats[ format ][ 1 ], width, height, ( uint8_t ) ( i & 1u ) );
+                PNGParserTestImage( &image );
+                free( image.samples );
+            }
+        }
+        PNGParserTestErrors();
+        PNGParserTestRegionErrors( 0u );
+        PNGParserTestRegionErrors( 1u );
+        PNGParserTestDecoder( PNGParser_CRC_Mode_Full );
+        PNGParserTestDecoder( PNGParser_CRC_Mode_Parallel );
+        PNGParserTestAllocators( 0u );
+        PNGParserTestAllocators( 1u );
+
+        printf( "%s (%s): %s\n", sPNGParserTestLevelNames[ level ], sPNGParserTestLevelNames[ picked ],
+                ( failures == sPNGParserTestFailures ) ? "ok" : "failed" );
+    }
+    PNGParserInitCPU( PNGParser_CPU_Level_Auto );
+
+    return PNGParserTestReport( "Decode" );
+}
+
+static void PNGParserTestCreateImage( PNGParserTestImageType* image, uint8_t colorType, uint8_t bitDepth,
+                                      uint32_t width, uint32_t height, uint8_t interlaceMethod )
+{
+    static const uint32_t channels[ 7 ] = { 1u, 0u, 3u, 1u, 2u, 0u, 4u };
+
+    memset( image, 0, sizeof( *image ) );
+    image->width = width;
+    image->height = height;
+    image->colorType = colorType;
+    image->bitDepth = bitDepth;
+    image->interlaceMethod = interlaceMethod;
+    image->channels = channels[ colorType ];
+
+    uint32_t maxValue = ( 1u << bitDepth ) - 1u;
+    if ( PNGPARSER_COLOR_TYPE_PALETTE == colorType )
+    {
+        image->paletteLength = 1u + PNGParserTestRandom() % ( maxValue + 1u );
+        PNGParserTestFill( &image->palette[ 0 ][ 0 ], image->paletteLength * 3u );
+        /* Every other palette image has transparency, for some of the entries. */
+        if ( PNGParserTestRandom() & 1u )
+        {
+            image->transparencyLength = 1u + PNGParserTestRandom() % image->paletteLength;
+            PNGParserTestFill( image->transparency, image->transparencyLength );
+        }
+        maxValue = image->paletteLength - 1u;
+    }
+
+    uint32_t sampleCount = width * height * image->channels;
+    image->samples = ( uint16_t* ) PNGParserTestAllocate( sampleCount * ( uint32_t ) sizeof( uint16_t ) );
+    for ( uint32_t i = 0; i < sampleCount; i++ )
+    {
+        image->samples[ i ] = ( uint16_t ) ( PNGParserTestRandom() % ( maxValue + 1u ) );
+    }
+}
+
+static void PNGParserTestEncode( const PNGParserTestImageType* image, PNGParserTestBufferType* file,
+                                 uint32_t idatLength )
+{
+    static const uint8_t signature[ PNGPARSER_TEST_SIGNATURE_LENGTH ] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+    static const uint8_t plain[ 1 ][ 4 ] = { { 0, 0, 1, 1 } };
+
+    uint32_t pixelBits = image->channels * image->bitDepth;
+    uint32_t bpp = ( pixelBits + 7u ) / 8u;
+    uint32_t rowMax = ( image->width * pixelBits + 7u ) / 8u;
+    const uint8_t( *passes )[ 4 ] = image->interlaceMethod ? sPNGParserTestAdam7 : plain;
+    uint32_t passCount = image->interlaceMethod ? PNGPARSER_ADAM7_PASS_COUNT : 1u;
+
+    /* Every row gets a random filter, the first row of each pass is filtered against a zero row. */
+    PNGParserTestBufferType raw = { NULL, 0, 0 };
+    uint8_t* row = PNGParserTestAllocate( rowMax );
+    uint8_t* previous = PNGParserTestAllocate( rowMax );
+    uint8_t* filtered = PNGParserTestAllocate( rowMax + 1u );
+    for ( uint32_t pass = 0; pass < passCount; pass++ )
+    {
+        uint32_t x0 = passes[ pass ][ 0 ], y0 = passes[ pass ][ 1 ];
+        uint32_t dx = passes[ pass ][ 2 ], dy = passes[ pass ][ 3 ];
+        uint32_t passWidth = ( image->width > x0 ) ? ( image->width - x0 + dx - 1u ) / dx : 0u;
+        uint32_t passHeight = ( image->height > y0 ) ? ( image->height - y0 + dy - 1u ) / dy : 0u;
+        if ( 0u == passWidth || 0u == passHeight ) { continue; }
+
+        uint32_t rowLength = ( passWidth * pixelBits + 7u ) / 8u;
+        memset( previous, 0, rowMax );
+        for ( uint32_t py = 0; py < passHeight; py++ )
+        {
+            memset( row, 0, rowMax );
+            for ( uint32_t px = 0; px < passWidth; px++ )
+            {
+                const uint16_t* pixel =
+                        image->samples + ( ( y0 + py * dy ) * image->width + x0 + px * dx ) * image->channels;
+                for ( uint32_t c = 0; c < image->channels; c++ )
+                {
+                    uint32_t bit = ( px * image->channels + c ) * image->bitDepth;
+                    if ( 16u == image->bitDepth )
+                    {
+                        row[ bit / 8u ] = ( uint8_t ) ( pixel[ c ] >> 8 );
+                        row[ bit / 8u + 1u ] = ( uint8_t ) pixel[ c ];
+                    }
+                    else { row[ bit / 8u ] |= ( uint8_t ) ( pixel[ c ] << ( 8u - image->bitDepth - bit % 8u ) ); }
+                }
+            }
+            uint8_t filter = ( uint8_t ) ( PNGParserTestRandom() % 5u );
+            filtered[ 0 ] = filter;
+            PNGParserTestFilterRow( filtered + 1, row, previous, rowLength, bpp, filter );
+            PNGParserTestAppend( &raw, filtered, rowLength + 1u );
+            memcpy( previous, row, rowLength );
+        }
+    }
+    free( row );
+    free( previous );
+    free( filtered );
+
+    uLongf compressedLength = compressBound( raw.length );
+    uint8_t* compressed = PNGParserTestAllocate( ( uint32_t ) compressedLength );
+    compress2( compressed, &compressedLength, raw.data, raw.length, ( int ) ( PNGParserTestRandom() % 10u ) );
+    free( raw.data );
+
+    uint8_t header[ PNGPARSER_IHDR_LENGTH ];
+    header[ 0 ] = ( uint8_t ) ( image->width >> 24 );
+    header[ 1 ] = ( uint8_t ) ( image->width >> 16 );
+    header[ 2 ] = ( uint8_t ) ( image->width >> 8 );
+    header[ 3 ] = ( uint8_t ) image->width;
+    header[ 4 ] = ( uint8_t ) ( image->height >> 24 );
+    header[ 5 ] = ( uint8_t ) ( image->height >> 16 );
+    header[ 6 ] = ( uint8_t ) ( image->height >> 8 );
+    header[ 7 ] = ( uint8_t ) image->height;
+    header[ 8 ] = image->bitDepth;
+    header[ 9 ] = image->colorType;
+    header[ 10 ] = 0;
+    header[ 11 ] = 0;
+    header[ 12 ] = image->interlaceMethod;
+
+    file->length = 0;
+    PNGParserTestAppend( file, signature, sizeof( signature ) );
+    PNGParserTestAppendChunk( file, "IHDR", header, sizeof( header ) );
+    if ( image->paletteLength )
+    {
+        PNGParserTestAppendChunk( file, "PLTE", &image->palette[ 0 ][ 0 ], image->paletteLength * 3u );
+    }
+    if ( image->transparencyLength )
+    {
+        PNGParserTestAppendChunk( file, "tRNS", image->transparency, image->transparencyLength );
+    }
+    uint32_t offset = 0;
+    do {
+        uint32_t length = ( uint32_t ) compressedLength - offset;
+        if ( PNGPARSER_TEST_IDAT_RANDOM != idatLength && length > idatLength ) { length = idatLength; }
+        else if ( PNGPARSER_TEST_IDAT_RANDOM == idatLength && length > 1u && ( PNGParserTestRandom() & 1u ) )
+        {
+            length = 1u + PNGParserTestRandom() % length;
+        }
+        PNGParserTestAppendChunk( file, "IDAT", compressed + offset, length );
+        offset += length;
+    } while ( offset < compressedLength );
+    PNGParserTestAppendChunk( file, "IEND", NULL, 0 );
+    free( compressed );
+}
+
+static void PNGParserTestAppend( PNGParserTestBufferType* buffer, const void* data, uint32_t length )
+{
+    if ( buffer->length + length > buffer->capacity )
+    {
+        buffer->capacity = ( buffer->length + length ) * 2u;
+        buffer->data = ( uint8_t* ) realloc( buffer->data, buffer->capacity );
+        if ( NULL == buffer->data )
+        {
+            printf( "Out of memory\n" );
+            exit( EXIT_FAILURE );
+        }
+    }
+    if ( length ) { memcpy( buffer->data + buffer->length, data, length ); }
+    buffer->length += length;
+}
+
+static void PNGParserTestAppendWord( PNGParserTestBufferType* buffer, uint32_t word )
+{
+    uint8_t bytes[ 4 ] = { ( uint8_t ) ( word >> 24 ), ( uint8_t ) ( word >> 16 ), ( uint8_t ) ( word >> 8 ),
+                           ( uint8_t ) word };
+    PNGParserTestAppend( buffer, bytes, sizeof( bytes ) );
+}
+
+static void PNGParserTestAppendChunk( PNGParserTestBufferType* file, const char* type, const uint8_t* data,
+                                      uint32_t length )
+{
+    PNGParserTestAppendWord( file, length );
+    uint32_t typeOffset = file->length;
+    PNGParserTestAppend( file, type, PNGPARSER_CHUNK_TYPE_LENGTH );
+    PNGParserTestAppend( file, data, length );
+    PNGParserTestAppendWord(
+            file, ( uint32_t ) crc32( 0, file->data + typeOffset, PNGPARSER_CHUNK_TYPE_LENGTH + length ) );
+}
+
+/**
+ * @brief Offset of the last chunk of the type, the file length if there is none.
+ */
+static uint32_t PNGParserTestFindChunk( const PNGParserTestBufferType* file, const char* type )
+{
+    uint32_t found = file->length;
+    for ( uint32_t offset = PNGPARSER_TEST_SIGNATURE_LENGTH; offset + PNGPARSER_TEST_CHUNK_OVERHEAD <= file->length; )
+    {
+        if ( 0 == memcmp( file->data + offset + 4u, type, PNGPARSER_CHUNK_TYPE_LENGTH ) ) { found = offset; }
+        offset += PNGParserTestChunkLength( file, offset ) + PNGPARSER_TEST_CHUNK_OVERHEAD;
+    }
+    return found;
+}
+
+static uint32_t PNGParserTestChunkLength( const PNGParserTestBufferType* file, uint32_t offset )
+{
+    const uint8_t* chunk = file->data + offset;
+    return ( ( uint32_t ) chunk[ 0 ] << 24 ) | ( ( uint32_t ) chunk[ 1 ] << 16 ) | ( ( uint32_t ) chunk[ 2 ] << 8 ) |
+           chunk[ 3 ];
+}
+
+/**
+ * @brief Writes the right CRC for the chunk at offset after its data has been changed.
+ */
+static void PNGParserTestUpdateCRC( PNGParserTestBufferType* file, uint32_t offset )
+{
+    uint32_t length = PNGParserTestChunkLength( file, offset );
+    uint8_t* crc = file->data + offset + 8u + length;
+    uint32_t value = ( uint32_t ) crc32( 0, file->data + offset + 4u, PNGPARSER_CHUNK_TYPE_LENGTH + length );
+    crc[ 0 ] = ( uint8_t ) ( value >> 24 );
+    crc[ 1 ] = ( uint8_t ) ( value >> 16 );
+    crc[ 2 ] = ( uint8_t ) ( value >> 8 );
+    crc[ 3 ] = ( uint8_t ) value;
+}
+
+static void PNGParserTestInsertChunk( PNGParserTestBufferType* file, uint32_t offset, const char* type,
+                                      const uint8_t* data, uint32_t length )
+{
+    PNGParserTestBufferType chunk = { NULL, 0, 0 };
+    PNGParserTestAppendChunk( &chunk, type, data, length );
+    uint32_t tail = file->length - offset;
+    PNGParserTestAppend( file, chunk.data, chunk.length );
+    memmove( file->data + offset + chunk.length, file->data + offset, tail );
+    memcpy( file->data + offset, chunk.data, chunk.length );
+    free( chunk.data );
+}
+
+static void PNGParserTestFilterRow( uint8_t* filtered, const uint8_t* row, const uint8_t* previous, uint32_t length,
+                                    uint32_t bpp, uint8_t filter )
+{
+    for ( uint32_t i = 0; i < length; i++ )
+    {
+        int32_t a = ( i >= bpp ) ? row[ i - bpp ] : 0;
+        int32_t b = previous[ i ];
+        int32_t c = ( i >= bpp ) ? previous[ i - bpp ] : 0;
+        int32_t predictor = 0;
+        switch ( filter )
+        {
+            case PNGParser_Filtering_Sub:
+                predictor = a;
+                break;
+            case PNGParser_Filtering_Up:
+                predictor = b;
+                break;
+            case PNGParser_Filtering_Average:
+                predictor = ( a + b ) / 2;
+                break;
+            case PNGParser_Filtering_Paeth: {
+                int32_t p = a + b - c;
+                int32_t pa = abs( p - a ), pb = abs( p - b ), pc = abs( p - c );
+                predictor = ( pa <= pb && pa <= pc ) ? a : ( pb <= pc ) ? b : c;
+                break;
+            }
+            default:
+                break;
+        }
+        filtered[ i ] = ( uint8_t ) ( row[ i ] - predictor );
+    }
+}
+
+static uint32_t PNGParserTestOutputChannels( const PNGParserTestImageType* image,
+                                             const PNGParserOptionsType* options )
+{
+    if ( PNGParser_Format_RGBA8 == options->outputFormat || PNGParser_Format_BGRA8 == options->outputFormat )
+    {
+        return 4u;
+    }
+    if ( PNGParser_Format_Native != options->outputFormat ) { return 3u; }
+    if ( PNGPARSER_COLOR_TYPE_PALETTE != image->colorType ) { return image->channels; }
+    if ( PNGParser_Palette_Indices == options->paletteMode ) { return 1u; }
+    if ( PNGParser_Palette_Expand_RGBA == options->paletteMode ) { return 4u; }
+    return image->transparencyLength ? 4u : 3u;
+}
+
+/**
+ * @brief The output sample of a pixel of the full image.
+ */
+static uint32_t PNGParserTestSample( const PNGParserTestImageType* image, const PNGParserOptionsType* options,
+                                     uint32_t x, uint32_t y, uint32_t channel )
+{
+    const uint16_t* pixel = image->samples + ( y * image->width + x ) * image->channels;
+    if ( PNGParser_Format_Native != options->outputFormat )
+    {
+        /* Taken from the 8 bit expanded image: BGR swaps red and blue, gray is repeated, a missing alpha is 255. */
+        PNGParserOptionsType expanded = *options;
+        expanded.outputFormat = PNGParser_Format_Native;
+        expanded.sixteenBitMode = PNGParser_Sixteen_Bit_Narrow;
+        expanded.paletteMode = PNGParser_Palette_Expand_RGBA;
+        if ( ( PNGParser_Format_BGRA8 == options->outputFormat || PNGParser_Format_BGR8 == options->outputFormat ) &&
+             channel != 1u && channel != 3u )
+        {
+            channel = 2u - channel;
+        }
+        uint32_t channels = PNGParserTestOutputChannels( image, &expanded );
+        if ( 3u == channel && 0u == ( channels & 1u ) ) { channel = channels - 1u; }
+        else if ( 3u == channel ) { return 255u; }
+        else if ( channels < 3u ) { channel = 0u; }
+        return PNGParserTestSample( image, &expanded, x, y, channel );
+    }
+    if ( PNGPARSER_COLOR_TYPE_PALETTE == image->colorType )
+    {
+        if ( PNGParser_Palette_Indices == options->paletteMode ) { return pixel[ 0 ]; }
+        if ( channel < 3u ) { return image->palette[ pixel[ 0 ] ][ channel ]; }
+        return ( pixel[ 0 ] < image->transparencyLength ) ? image->transparency[ pixel[ 0 ] ] : 255u;
+    }
+    uint32_t value = pixel[ channel ];
+    if ( image->bitDepth < 8u ) { value = value * 255u / ( ( 1u << image->bitDepth ) - 1u ); }
+    if ( 16u == image->bitDepth && PNGParser_Sixteen_Bit_Narrow == options->sixteenBitMode ) { value >>= 8; }
+    return value;
+}
+
+/**
+ * @brief Builds the expected output straight from the samples of the image: the region cut to the image, box averaged
+ *        in blocks from its top left corner that are cut at the right and bottom edges when it is downscaled, then
+ *        rearranged into tiles padded with zeros.
+ */
+static void PNGParserTestReference( const PNGParserTestImageType* image, const PNGParserOptionsType* options,
+                                    PNGParserTestOutputType* expected )
+{
+    /* Indices cannot be averaged, so a downscaled palette image is expanded. */
+    PNGParserOptionsType effective = *options;
+    if ( PNGParser_Scale_Full != options->scale && PNGParser_Palette_Indices == options->paletteMode )
+    {
+        effective.paletteMode = PNGParser_Palette_Expand;
+    }
+    options = &effective;
+    uint32_t x0 = 0, y0 = 0, x1 = image->width, y1 = image->height;
+    if ( options->region.width && options->region.height )
+    {
+        x0 = options->region.x;
+        y0 = options->region.y;
+        if ( options->region.width < x1 - x0 ) { x1 = x0 + options->region.width; }
+        if ( options->region.height < y1 - y0 ) { y1 = y0 + options->region.height; }
+    }
+    uint32_t block = 1u << options->scale;
+    expected->width = ( x1 - x0 + block - 1u ) / block;
+    expected->height = ( y1 - y0 + block - 1u ) / block;
+    expected->channels = PNGParserTestOutputChannels( image, options );
+    expected->bytesPerSample = 1u;
+    if ( 16u == image->bitDepth && PNGParser_Sixteen_Bit_Native == options->sixteenBitMode &&
+         PNGParser_Format_Native == options->outputFormat )
+    {
+        expected->bytesPerSample = 2u;
+    }
+    uint32_t pixelBytes = expected->channels * expected->bytesPerSample;
+    expected->length = expected->width * expected->height * pixelBytes;
+    expected->data = PNGParserTestAllocate( expected->length );
+
+    for ( uint32_t y = 0; y < expected->height; y++ )
+    {
+        for ( uint32_t x = 0; x < expected->width; x++ )
+        {
+            uint8_t* pixel = expected->data + ( y * expected->width + x ) * pixelBytes;
+            for ( uint32_t c = 0; c < expected->channels; c++ )
+            {
+                uint32_t sum = 0, count = 0;
+                for ( uint32_t sy = y0 + y * block; sy < y0 + ( y + 1u ) * block && sy < y1; sy++ )
+                {
+                    for ( uint32_t sx = x0 + x * block; sx < x0 + ( x + 1u ) * block && sx < x1; sx++, count++ )
+                    {
+                        sum += PNGParserTestSample( image, options, sx, sy, c );
+                    }
+                }
+                uint32_t value = ( sum + count / 2u ) / count;
+                if ( 2u == expected->bytesPerSample )
+                {
+                    /* 16 bit samples come out in the byte order of the host. */
+                    uint16_t value16 = ( uint16_t ) value;
+                    memcpy( pixel + c * 2u, &value16, 2u );
+                }
+                else { pixel[ c ] = ( uint8_t ) value; }
+            }
+        }
+    }
+    if ( PNGParser_Layout_Linear != options->layout ) { PNGParserTestTile( options, expected ); }
+}
+
+/**
+ * @brief Moves every pixel of the linear output to its tile, in row order or in Z-order inside the tile with the bits
+ *        of x at the even and those of y at the odd positions of the index.
+ */
+static void PNGParserTestTile( const PNGParserOptionsType* options, PNGParserTestOutputType* expected )
+{
+    uint32_t size = options->tileSize;
+    uint32_t pixelBytes = expected->channels * expected->bytesPerSample;
+    uint32_t tilesX = ( expected->width + size - 1u ) / size;
+    uint32_t tilesY = ( expected->height + size - 1u ) / size;
+    uint32_t length = tilesX * tilesY * size * size * pixelBytes;
+    uint8_t* tiles = PNGParserTestAllocate( length );
+    memset( tiles, 0, length );
+
+    for ( uint32_t y = 0; y < expected->height; y++ )
+    {
+        for ( uint32_t x = 0; x < expected->width; x++ )
+        {
+            uint32_t tx = x % size, ty = y % size, inside = ty * size + tx;
+            if ( PNGParser_Layout_Morton == options->layout )
+            {
+                inside = 0;
+                for ( uint32_t bit = 0; ( 1u << bit ) < size; bit++ )
+                {
+                    inside |= ( ( tx >> bit ) & 1u ) << ( 2u * bit );
+                    inside |= ( ( ty >> bit ) & 1u ) << ( 2u * bit + 1u );
+                }
+            }
+            uint32_t index = ( ( y / size ) * tilesX + x / size ) * size * size + inside;
+            memcpy( tiles + index * pixelBytes, expected->data + ( y * expected->width + x ) * pixelBytes,
+                    pixelBytes );
+        }
+    }
+    free( expected->data );
+    expected->data = tiles;
+    expected->length = length;
+}
+
+static void PNGParserTestCheck( const PNGParserTestImageType* image, const PNGParserOptionsType* options,
+                                PNGParserResultType result, const PNGImage* decoded, const char* name )
+{
+    PNGParserTestOutputType expected;
+    PNGParserTestReference( image, options, &expected );
+
+    PNGPARSER_TEST_CHECK( PNGParser_Result_OK == result, "%s, %ux%u type %u depth %u interlace %u: result %d", name,
+                          image->width, image->height, image->colorType, image->bitDepth, image->interlaceMethod,
+                          result );
+    if ( PNGParser_Result_OK == result )
+    {
+        PNGPARSER_TEST_CHECK( decoded->width == expected.width && decoded->height == expected.height &&
+                                      decoded->channels == expected.channels &&
+                                      decoded->bytesPerSample == expected.bytesPerSample &&
+                                      decoded->length == expected.length,
+                              "%s, %ux%u type %u depth %u interlace %u: %ux%ux%u of %u bytes in %u bytes, expected "
+                              "%ux%ux%u of %u bytes in %u bytes",
+                              name, image->width, image->height, image->colorType, image->bitDepth,
+                              image->interlaceMethod, decoded->width, decoded->height, decoded->channels,
+                              decoded->bytesPerSample, decoded->length, expected.width, expected.height,
+                              expected.channels, expected.bytesPerSample, expected.length );
+        PNGPARSER_TEST_CHECK( NULL == decoded->data || decoded->length != expected.length ||
+                                      0 == memcmp( decoded->data, expected.data, expected.length ),
+                              "%s, %ux%u type %u depth %u interlace %u: pixels differ", name, image->width,
+                              image->height, image->colorType, image->bitDepth, image->interlaceMethod );
+
+        /* The palette comes back as RGBA in every palette mode. */
+        BOOL paletteMatches = ( decoded->paletteLength == image->paletteLength );
+        for ( uint32_t i = 0; paletteMatches && i < image->paletteLength; i++ )
+        {
+            uint8_t alpha = ( i < image->transparencyLength ) ? image->transparency[ i ] : 255u;
+            paletteMatches = ( 0 == memcmp( decoded->palette[ i ], image->palette[ i ], 3u ) &&
+                               decoded->palette[ i ][ 3 ] == alpha );
+        }
+        PNGPARSER_TEST_CHECK( paletteMatches, "%s, %ux%u type %u depth %u: palette of %u entries differs, expected %u",
+                              name, image->width, image->height, image->colorType, image->bitDepth,
+                              decoded->paletteLength, image->paletteLength );
+    }
+    free( expected.data );
+}
+
+static void PNGParserTestDecode( const PNGParserTestImageType* image, PNGParserTestBufferType* file,
+                                 const PNGParserOptionsType* options, const char* name )
+{
+    PNGImage decoded;
+    memset( &decoded, 0, sizeof( decoded ) );
+    PNGParserResultType result = PNGParseWithOptions( file->data, file->length, &decoded, options );
+    PNGParserTestCheck( image, options, result, &decoded, name );
+    if ( PNGParser_Result_OK == result )
+    {
+        PNGImageFreeWithAllocator( &options->allocator, decoded.data, decoded.length );
+    }
+}
+
+/**
+ * @brief Feeds the file to the push parser in random pieces.
+ */
+static PNGParserResultType PNGParserTestFeed( PNGParserTestBufferType* file, const PNGParserOptionsType* options,
+                                              PNGImage* decoded )
+{
+    memset( decoded, 0, sizeof( *decoded ) );
+    PNGParser* parser = PNGParserCreateWithOptions( options );
+    if ( NULL == parser ) { return PNGParser_Error_Allocating_Memory; }
+
+    PNGParserResultType result = PNGParser_Result_OK;
+    for ( uint32_t offset = 0; offset < file->length && PNGParser_Result_OK == result; )
+    {
+        uint32_t piece = 1u + PNGParserTestRandom() % PNGPARSER_TEST_MAX_PIECE;
+        if ( piece > file->length - offset ) { piece = file->length - offset; }
+        result = PNGParserFeed( parser, file->data + offset, piece );
+        offset += piece;
+    }
+    PNGParserResultType finished = PNGParserFinish( parser, decoded );
+    if ( PNGParser_Result_OK == result ) { result = finished; }
+    return result;
+}
+
+/**
+ * @brief Same as PNGParserTestDecode, with the file fed to the push parser in random pieces.
+ */
+static void PNGParserTestDecodeInPieces( const PNGParserTestImageType* image, PNGParserTestBufferType* file,
+                                         const PNGParserOptionsType* options, const char* name )
+{
+    PNGImage decoded;
+    PNGParserResultType result = PNGParserTestFeed( file, options, &decoded );
+    PNGParserTestCheck( image, options, result, &decoded, name );
+    if ( PNGParser_Result_OK == result )
+    {
+        PNGImageFreeWithAllocator( &options->allocator, decoded.data, decoded.length );
+    }
+}
+
+/**
+ * @brief Decodes into a buffer with padding bytes after each row, 0 for rows back to back, and checks the rows, that
+ *        the padding and the bytes after the buffer stay untouched, and that a buffer or row pitch one byte short is
+ *        refused.
+ */
+static void PNGParserTestDecodeInto( const PNGParserTestImageType* image, PNGParserTestBufferType* file,
+                                     const PNGParserOptionsType* options, uint32_t padding, const char* name )
+{
+    PNGParserTestOutputType expected;
+    PNGParserTestReference( image, options, &expected );
+    uint32_t rowLength = expected.width * expected.channels * expected.bytesPerSample;
+    uint32_t rowStride = rowLength + padding;
+    uint32_t capacity = rowStride * ( expected.height - 1u ) + rowLength;
+    uint8_t* destination = PNGParserTestAllocate( capacity + PNGPARSER_TEST_GUARD_LENGTH );
+    memset( destination, PNGPARSER_TEST_SENTINEL, capacity + PNGPARSER_TEST_GUARD_LENGTH );
+
+    PNGImage decoded;
+    memset( &decoded, 0, sizeof( decoded ) );
+    PNGParserResultType result = PNGParseInto( file->data, file->length, &decoded, destination, capacity,
+                                               padding ? rowStride : 0u, options );
+    PNGPARSER_TEST_CHECK( PNGParser_Result_OK == result && decoded.data == destination &&
+                                  decoded.width == expected.width && decoded.height == expected.height &&
+                                  decoded.channels == expected.channels && decoded.length == capacity,
+                          "%s, %ux%u padded by %u: result %d, %ux%ux%u of %u bytes", name, image->width,
+                          image->height, padding, result, decoded.width, decoded.height, decoded.channels,
+                          decoded.length );
+
+    uint32_t untouched = 0;
+    for ( uint32_t y = 0; PNGParser_Result_OK == result && y < expected.height; y++ )
+    {
+        const uint8_t* row = destination + y * rowStride;
+        PNGPARSER_TEST_CHECK( 0 == memcmp( row, expected.data + y * rowLength, rowLength ),
+                              "%s, %ux%u padded by %u: row %u differs", name, image->width, image->height, padding, y );
+        uint32_t end = ( y + 1u < expected.height ) ? rowStride : rowLength + PNGPARSER_TEST_GUARD_LENGTH;
+        for ( uint32_t i = rowLength; i < end; i++ ) { untouched += ( PNGPARSER_TEST_SENTINEL == row[ i ] ); }
+    }
+    uint32_t outside = ( expected.height - 1u ) * padding + PNGPARSER_TEST_GUARD_LENGTH;
+    PNGPARSER_TEST_CHECK( PNGParser_Result_OK != result || untouched == outside,
+                          "%s, %ux%u padded by %u: %u of %u bytes between the rows written", name, image->width,
+                          image->height, padding, outside - untouched, outside );
+
+    result = PNGParseInto( file->data, file->length, &decoded, destination, capacity - 1u, rowStride, options );
+    PNGPARSER_TEST_CHECK( PNGParser_Error_Output_Too_Small == result, "%s, %ux%u one byte short: result %d", name,
+                          image->width, image->height, result );
+    if ( rowLength > 1u )
+    {
+        result = PNGParseInto( file->data, file->length, &decoded, destination, capacity, rowLength - 1u, options );
+        PNGPARSER_TEST_CHECK( PNGParser_Error_Output_Too_Small == result, "%s, %ux%u row pitch too short: result %d",
+                              name, image->width, image->height, result );
+    }
+
+    free( destination );
+    free( expected.data );
+}
+
+/**
+ * @brief Checks that PNGParseHeader reports the image and the output size the decode gives.
+ */
+static void PNGParserTestProbe( const PNGParserTestImageType* image, PNGParserTestBufferType* file,
+                                const PNGParserOptionsType* options, const char* name )
+{
+    PNGParserTestOutputType expected;
+    PNGParserTestReference( image, options, &expected );
+    /* The probe cannot see the tRNS chunk, so an expanded palette image is counted as RGBA. */
+    if ( PNGPARSER_COLOR_TYPE_PALETTE == image->colorType && PNGParser_Format_Native == options->outputFormat &&
+         3u == expected.channels )
+    {
+        expected.length = expected.length / 3u * 4u;
+    }
+    PNGProbe probe;
+    PNGParserResultType result = PNGParseHeader( file->data, file->length, &probe, options );
+    PNGPARSER_TEST_CHECK( PNGParser_Result_OK == result && probe.imageSpec.width == image->width &&
+                                  probe.imageSpec.height == image->height && probe.width == expected.width &&
+                                  probe.height == expected.height && probe.outputBytes == expected.length,
+                          "%s probe, %ux%u: result %d, %ux%u to %ux%u of %u bytes, expected %ux%u of %u bytes", name,
+                          image->width, image->height, result, probe.imageSpec.width, probe.imageSpec.height,
+                          probe.width, probe.height, ( uint32_t ) probe.outputBytes, expected.width, expected.height,
+                          expected.length );
+    free( expected.data );
+}
+
+static void PNGParserTestExpectProbeError( PNGParserTestBufferType* file, const PNGParserOptionsType* options,
+                                           PNGParserResultType expected, const char* name )
+{
+    PNGProbe probe;
+    PNGParserResultType result = PNGParseHeader( file->data, file->length, &probe, options );
+    PNGPARSER_TEST_CHECK( expected == result, "%s probe: result %d, expected %d", name, result, expected );
+}
+
+/**
+ * @brief A budget of exactly the probed scratch and output bytes has to be enough, one byte less has to stop the
+ *        decode.
+ */
+static void PNGParserTestBudget( const PNGParserTestImageType* image, PNGParserTestBufferType* file,
+                                 const PNGParserOptionsType* options )
+{
+    PNGParserOptionsType budgeted = *options;
+    PNGProbe probe;
+    PNGParseHeader( file->data, file->length, &probe, options );
+    budgeted.memoryBudget = probe.scratchBytes + probe.outputBytes;
+    PNGParserTestDecode( image, file, &budgeted, "exact budget" );
+    PNGParserTestDecodeInPieces( image, file, &budgeted, "exact budget in pieces" );
+
+    budgeted.memoryBudget--;
+    PNGParserTestExpectError( file, &budgeted, PNGParser_Error_Memory_Budget, "budget one byte short" );
+    PNGParserTestExpectProbeError( file, &budgeted, PNGParser_Error_Memory_Budget, "budget one byte short" );
+    PNGImage decoded;
+    PNGParserResultType result = PNGParserTestFeed( file, &budgeted, &decoded );
+    PNGPARSER_TEST_CHECK( PNGParser_Error_Memory_Budget == result, "budget one byte short in pieces: result %d",
+                          result );
+}
+
+/**
+ * @brief Checks every report against the reference: a plain image in bands that follow each other from row 0, an
+ *        interlaced one as whole frames in pass order, and the rows reported have to be final.
+ */
+static void PNGParserTestOnProgress( void* context, const PNGParserProgressType* pProgress )
+{
+    PNGParserTestProgressType* progress = ( PNGParserTestProgressType* ) context;
+    const PNGParserTestOutputType* expected = progress->expected;
+    uint32_t rowLength = expected->width * expected->channels * expected->bytesPerSample;
+    const uint8_t* data = progress->destination + pProgress->firstRow * rowLength;
+    progress->calls++;
+
+    PNGPARSER_TEST_CHECK( pProgress->data == data && pProgress->rowStride == rowLength,
+                          "progress data %p stride %u, expected %p stride %u", ( const void* ) pProgress->data,
+                          pProgress->rowStride, ( const void* ) data, rowLength );
+    if ( 0u == pProgress->pass )
+    {
+        BOOL last = ( pProgress->firstRow + pProgress->rowCount == expected->height );
+        PNGPARSER_TEST_CHECK( pProgress->firstRow == progress->nextRow && pProgress->rowCount > 0u &&
+                                      ( pProgress->rowCount == progress->bandRows ||
+                                        ( last && pProgress->rowCount < progress->bandRows ) ),
+                              "progress rows %u to %u after %u, bands of %u", pProgress->firstRow,
+                              pProgress->firstRow + pProgress->rowCount, progress->nextRow, progress->bandRows );
+        PNGPARSER_TEST_CHECK( 0 == memcmp( pProgress->data, expected->data + pProgress->firstRow * rowLength,
+                                           pProgress->rowCount * rowLength ),
+                              "progress rows %u to %u differ", pProgress->firstRow,
+                              pProgress->firstRow + pProgress->rowCount );
+        progress->nextRow = pProgress->firstRow + pProgress->rowCount;
+        progress->complete = ( progress->nextRow == expected->height );
+    }
+    else
+    {
+        PNGPARSER_TEST_CHECK( pProgress->pass > progress->lastPass && pProgress->pass <= PNGPARSER_ADAM7_PASS_COUNT &&
+                                      0u == pProgress->firstRow && pProgress->rowCount == expected->height,
+                              "progress pass %u rows %u to %u after pass %u", pProgress->pass, pProgress->firstRow,
+                              pProgress->firstRow + pProgress->rowCount, progress->lastPass );
+        progress->lastPass = pProgress->pass;
+        progress->complete = ( 0 == memcmp( pProgress->data, expected->data, expected->length ) );
+    }
+}
+
+static void PNGParserTestProgress( const PNGParserTestImageType* image, PNGParserTestBufferType* file,
+                                   const PNGParserOptionsType* options, uint32_t bandRows )
+{
+    PNGParserTestOutputType expected;
+    PNGParserTestReference( image, options, &expected );
+    uint8_t* destination = PNGParserTestAllocate( expected.length );
+    PNGParserTestProgressType progress = { &expected, destination, bandRows ? bandRows : 1u, 0, 0, 0, FALSE };
+
+    PNGParserOptionsType reporting = *options;
+    reporting.progress = PNGParserTestOnProgress;
+    reporting.progressContext = &progress;
+    reporting.progressRows = bandRows;
+    PNGImage decoded;
+    PNGParserResultType result =
+            PNGParseInto( file->data, file->length, &decoded, destination, expected.length, 0u, &reporting );
+    PNGPARSER_TEST_CHECK( PNGParser_Result_OK == result && progress.complete,
+                          "progress in bands of %u, %ux%u interlace %u: result %d after %u calls, %s", bandRows,
+                          image->width, image->height, image->interlaceMethod, result, progress.calls,
+                          progress.complete ? "complete" : "incomplete" );
+
+    free( destination );
+    free( expected.data );
+}
+
+/**
+ * @brief Each row has to come in order and match the reference while the callback runs.
+ */
+static void PNGParserTestOnRow( void* context, const PNGParserRowType* pRow )
+{
+    PNGParserTestRowsType* rows = ( PNGParserTestRowsType* ) context;
+    const PNGParserTestOutputType* expected = rows->expected;
+    uint32_t rowLength = expected->width * expected->channels * expected->bytesPerSample;
+
+    if ( pRow->row != rows->nextRow || pRow->row >= expected->height || pRow->width != expected->width ||
+         pRow->channels != expected->channels || pRow->bytesPerSample != expected->bytesPerSample ||
+         0 != memcmp( pRow->data, expected->data + pRow->row * rowLength, rowLength ) )
+    {
+        rows->matches = FALSE;
+    }
+    rows->nextRow++;
+}
+
+static void PNGParserTestCheckRows( const PNGParserTestImageType* image, const PNGParserTestRowsType* rows,
+                                    PNGParserResultType result, const PNGImage* decoded, const char* name )
+{
+    const PNGParserTestOutputType* expected = rows->expected;
+    PNGPARSER_TEST_CHECK( PNGParser_Result_OK == result && NULL == decoded->data &&
+                                  decoded->width == expected->width && decoded->height == expected->height &&
+                                  decoded->channels == expected->channels &&
+                                  decoded->bytesPerSample == expected->bytesPerSample,
+                          "%s, %ux%u type %u depth %u interlace %u: result %d, %ux%ux%u of %u bytes at %p", name,
+                          image->width, image->height, image->colorType, image->bitDepth, image->interlaceMethod,
+                          result, decoded->width, decoded->height, decoded->channels, decoded->bytesPerSample,
+                          ( const void* ) decoded->data );
+    PNGPARSER_TEST_CHECK( rows->matches && rows->nextRow == expected->height,
+                          "%s, %ux%u type %u depth %u interlace %u: %u rows handed over, %s", name, image->width,
+                          image->height, image->colorType, image->bitDepth, image->interlaceMethod, rows->nextRow,
+                          rows->matches ? "in order" : "out of order or differing" );
+}
+
+static void PNGParserTestRows( const PNGParserTestImageType* image, PNGParserTestBufferType* file,
+                               const PNGParserOptionsType* options, const char* name )
+{
+    /* Rows are handed over linear whatever the layout. */
+    PNGParserOptionsType linear = *options;
+    linear.layout = PNGParser_Layout_Linear;
+    PNGParserTestOutputType expected;
+    PNGParserTestReference( image, &linear, &expected );
+    PNGParserTestRowsType rows = { &expected, 0, TRUE };
+    PNGImage decoded;
+    memset( &decoded, 0, sizeof( decoded ) );
+    PNGParserResultType result =
+            PNGParseRows( file->data, file->length, &decoded, PNGParserTestOnRow, &rows, options );
+    PNGParserTestCheckRows( image, &rows, result, &decoded, name );
+    free( expected.data );
+}
+
+static void PNGParserTestTiles( const PNGParserTestImageType* image, PNGParserTestBufferType* file,
+                                const PNGParserOptionsType* options, const char* name )
+{
+    PNGParserTestDecode( image, file, options, name );
+    PNGParserTestDecodeInPieces( image, file, options, name );
+    PNGParserTestProbe( image, file, options, name );
+    PNGParserTestRows( image, file, options, name );
+
+    /* The padding of the edge tiles has to be cleared in a caller's buffer that is not. */
+    PNGParserTestOutputType expected;
+    PNGParserTestReference( image, options, &expected );
+    uint8_t* destination = PNGParserTestAllocate( expected.length );
+    memset( destination, PNGPARSER_TEST_SENTINEL, expected.length );
+    PNGImage decoded;
+    memset( &decoded, 0, sizeof( decoded ) );
+    PNGParserResultType result =
+            PNGParseInto( file->data, file->length, &decoded, destination, expected.length, 0u, options );
+    PNGPARSER_TEST_CHECK( PNGParser_Result_OK == result && decoded.length == expected.length &&
+                                  0 == memcmp( destination, expected.data, expected.length ),
+                          "%s into, %ux%u tiles of %u: result %d, %u bytes, expected %u", name, image->width,
+                          image->height, options->tileSize, result, decoded.length, expected.length );
+    result = PNGParseInto( file->data, file->length, &decoded, destination, expected.length - 1u, 0u, options );
+    PNGPARSER_TEST_CHECK( PNGParser_Error_Output_Too_Small == result, "%s into, %ux%u one byte short: result %d",
+                          name, image->width, image->height, result );
+    free( destination );
+    free( expected.data );
+}
+
+static float PNGParserTestHalfToFloat( uint16_t half )
+{
+    uint32_t sign = ( uint32_t ) ( half >> 15 ) << 31;
+    uint32_t exponent = ( half >> 10 ) & 0x1Fu;
+    uint32_t mantissa = half & 0x3FFu;
+    float value;
+    if ( 0u == exponent )
+    {
+        /* Zero or subnormal, the mantissa in units of 2^-24. */
+        value = ( float ) mantissa / 16777216.0f;
+        if ( sign ) { value = -value; }
+    }
+    else
+    {
+        uint32_t bits = sign | ( ( 31u == exponent ) ? 0xFFu : exponent - 15u + 127u ) << 23 | mantissa << 13;
+        memcpy( &value, &bits, sizeof( value ) );
+    }
+    return value;
+}
+
+/**
+ * @brief Compares a tensor with the integer interleaved reference. Floats have to be within rounding of
+ *        sample / maximum * scale + bias: a few float ulps of its terms, which may cancel, plus half an ulp of a half.
+ */
+static BOOL PNGParserTestTensorMatches( const PNGParserOptionsType* options, const PNGParserTestOutputType* expected,
+                                       const uint8_t* data )
+{
+    uint32_t pixels = expected->width * expected->height;
+    float maximum = ( 2u == expected->bytesPerSample ) ? 65535.0f : 255.0f;
+    for ( uint32_t i = 0; i < pixels; i++ )
+    {
+        for ( uint32_t c = 0; c < expected->channels; c++ )
+        {
+            uint32_t source = i * expected->channels + c;
+            uint32_t target = options->planar ? c * pixels + i : source;
+            uint32_t sample = expected->data[ source ];
+            if ( 2u == expected->bytesPerSample )
+            {
+                uint16_t sample16;
+                memcpy( &sample16, expected->data + source * 2u, 2u );
+                sample = sample16;
+            }
+
+            if ( PNGParser_Sample_Integer == options->sampleType )
+            {
+                uint32_t actual = data[ target ];
+                if ( 2u == expected->bytesPerSample )
+                {
+                    uint16_t actual16;
+                    memcpy( &actual16, data + target * 2u, 2u );
+                    actual = actual16;
+                }
+                if ( actual != sample ) { return FALSE; }
+                continue;
+            }
+            float product = ( float ) sample / maximum * options->sampleScale[ c ];
+            float bias = options->sampleBias[ c ];
+            float value = product + bias;
+            float terms = ( ( product < 0.0f ) ? -product : product ) + ( ( bias < 0.0f ) ? -bias : bias );
+            float tolerance = 1e-6f * terms;
+            float actual;
+            if ( PNGParser_Sample_Float32 == options->sampleType ) { memcpy( &actual, data + target * 4u, 4u ); }
+            else
+            {
+                uint16_t half;
+                memcpy( &half, data + target * 2u, 2u );
+                actual = PNGParserTestHalfToFloat( half );
+                /* Half of the 2^-24 spacing of the subnormals, or of an ulp of 11 bits. */
+                tolerance += ( ( value < 0.0f ) ? -value : value ) / 2048.0f + 1.0f / 33554432.0f;
+            }
+            float difference = ( actual < value ) ? value - actual : actual - value;
+            if ( !( difference <= tolerance ) ) { return FALSE; }
+        }
+    }
+    return TRUE;
+}
+
+static void PNGParserTestTensor( const PNGParserTestImageType* image, PNGParserTestBufferType* file,
+                                 const PNGParserOptionsType* options, const char* name )
+{
+    PNGParserOptionsType integer = *options;
+    integer.sampleType = PNGParser_Sample_Integer;
+    integer.planar = FALSE;
+    integer.layout = PNGParser_Layout_Linear;
+    PNGParserTestOutputType expected;
+    PNGParserTestReference( image, &integer, &expected );
+    uint32_t elementBytes = expected.bytesPerSample;
+    if ( PNGParser_Sample_Float32 == options->sampleType ) { elementBytes = 4u; }
+    if ( PNGParser_Sample_Float16 == options->sampleType ) { elementBytes = 2u; }
+    uint32_t length = expected.width * expected.height * expected.channels * elementBytes;
+
+    for ( uint32_t pieces = 0; pieces <= 1u; pieces++ )
+    {
+        PNGImage decoded;
+        memset( &decoded, 0, sizeof( decoded ) );
+        PNGParserResultType result = pieces ? PNGParserTestFeed( file, options, &decoded )
+                                            : PNGParseWithOptions( file->data, file->length, &decoded, options );
+        PNGPARSER_TEST_CHECK( PNGParser_Result_OK == result && decoded.width == expected.width &&
+                                      decoded.height == expected.height && decoded.channels == expected.channels &&
+                                      decoded.bytesPerSample == elementBytes && decoded.length == length &&
+                                      decoded.sampleType == options->sampleType && decoded.planar == options->planar,
+                              "%s%s, %ux%u type %u depth %u: result %d, %ux%ux%u of %u bytes in %u bytes, expected "
+                              "%ux%ux%u of %u bytes in %u bytes",
+                              name, pieces ? " in pieces" : "", image->width, image->height, image->colorType,
+                              image->bitDepth, result, decoded.width, decoded.height, decoded.channels,
+                              decoded.bytesPerSample, decoded.length, expected.width, expected.height,
+                              expected.channels, elementBytes, length );
+        if ( PNGParser_Result_OK == result )
+        {
+            PNGPARSER_TEST_CHECK( decoded.length != length ||
+                                          PNGParserTestTensorMatches( options, &expected, decoded.data ),
+                                  "%s%s, %ux%u type %u depth %u interlace %u: samples differ", name,
+                                  pieces ? " in pieces" : "", image->width, image->height, image->colorType,
+                                  image->bitDepth, image->interlaceMethod );
+            PNGImageFreeWithAllocator( &options->allocator, decoded.data, decoded.length );
+        }
+    }
+    free( expected.data );
+}
+
+static void PNGParserTestImage( const PNGParserTestImageType* image )
+{
+    PNGParserTestBufferType file = { NULL, 0, 0 };
+    PNGParserTestEncode( image, &file, PNGPARSER_TEST_IDAT_RANDOM );
+
+    PNGParserOptionsType options;
+    PNGParserGetDefaultOptions( &options );
+    PNGParserTestDecode( image, &file, &options, "default" );
+    PNGParserTestProbe( image, &file, &options, "default" );
+    PNGParserTestBudget( image, &file, &options );
+    PNGParserTestProgress( image, &file, &options, 0u );
+    PNGParserTestProgress( image, &file, &options, 1u + PNGParserTestRandom() % 8u );
+    PNGParserTestDecodeInPieces( image, &file, &options, "pieces" );
+    PNGParserTestDecodeInto( image, &file, &options, PNGParserTestRandom() % PNGPARSER_TEST_MAX_PADDING, "into" );
+    PNGParserTestRows( image, &file, &options, "rows" );
+
+    options.crcMode = PNGParser_CRC_Mode_Parallel;
+    PNGParserTestDecode( image, &file, &options, "parallel CRC" );
+    PNGParserTestDecodeInPieces( image, &file, &options, "parallel CRC in pieces" );
+    options.crcMode = PNGParser_CRC_Mode_Skip;
+    PNGParserTestDecode( image, &file, &options, "skipped CRC" );
+    options.crcMode = PNGParser_CRC_Mode_Full;
+    options.checkAdler32 = FALSE;
+    PNGParserTestDecode( image, &file, &options, "unchecked Adler-32" );
+    PNGParserTestDecodeInPieces( image, &file, &options, "unchecked Adler-32 in pieces" );
+    options.checkAdler32 = TRUE;
+
+    if ( PNGPARSER_COLOR_TYPE_PALETTE == image->colorType )
+    {
+        options.paletteMode = PNGParser_Palette_Expand_RGBA;
+        PNGParserTestDecode( image, &file, &options, "RGBA palette" );
+        PNGParserTestProbe( image, &file, &options, "RGBA palette" );
+        options.paletteMode = PNGParser_Palette_Indices;
+        PNGParserTestDecode( image, &file, &options, "palette indices" );
+        PNGParserTestDecodeInPieces( image, &file, &options, "palette indices in pieces" );
+        PNGParserTestProbe( image, &file, &options, "palette indices" );
+        options.paletteMode = PNGParser_Palette_Expand;
+    }
+    if ( 16u == image->bitDepth )
+    {
+        options.sixteenBitMode = PNGParser_Sixteen_Bit_Narrow;
+        PNGParserTestDecode( image, &file, &options, "narrow" );
+        PNGParserTestDecodeInPieces( image, &file, &options, "narrow in pieces" );
+        PNGParserTestProbe( image, &file, &options, "narrow" );
+        options.sixteenBitMode = PNGParser_Sixteen_Bit_Native;
+    }
+
+    /* Palette images are asked for as indices to check that a downscale expands them. */
+    options.paletteMode = PNGParser_Palette_Indices;
+    for ( uint32_t scale = PNGParser_Scale_Half; scale <= PNGParser_Scale_Eighth; scale++ )
+    {
+        options.scale = ( PNGParserScaleType ) scale;
+        PNGParserTestDecode( image, &file, &options, "scaled" );
+        PNGParserTestDecodeInPieces( image, &file, &options, "scaled in pieces" );
+        PNGParserTestDecodeInto( image, &file, &options, PNGParserTestRandom() % PNGPARSER_TEST_MAX_PADDING,
+                                 "scaled into" );
+        PNGParserTestProbe( image, &file, &options, "scaled" );
+        PNGParserTestProgress( image, &file, &options, 1u + PNGParserTestRandom() % 8u );
+        PNGParserTestRows( image, &file, &options, "scaled rows" );
+    }
+    options.scale = PNGParser_Scale_Full;
+
+    /* Any region inside the image, it may reach past the right and bottom edges. */
+    options.region.x = PNGParserTestRandom() % image->width;
+    options.region.y = PNGParserTestRandom() % image->height;
+    options.region.width = 1u + PNGParserTestRandom() % image->width;
+    options.region.height = 1u + PNGParserTestRandom() % image->height;
+    PNGParserTestDecode( image, &file, &options, "region" );
+    PNGParserTestDecodeInPieces( image, &file, &options, "region in pieces" );
+    PNGParserTestDecodeInto( image, &file, &options, PNGParserTestRandom() % PNGPARSER_TEST_MAX_PADDING,
+                             "region into" );
+    PNGParserTestProbe( image, &file, &options, "region" );
+    PNGParserTestProgress( image, &file, &options, 1u + PNGParserTestRandom() % 8u );
+    PNGParserTestRows( image, &file, &options, "region rows" );
+    options.scale = ( PNGParserScaleType ) ( 1u + PNGParserTestRandom() % PNGParser_Scale_Eighth );
+    PNGParserTestDecode( image, &file, &options, "scaled region" );
+    PNGParserTestDecodeInPieces( image, &file, &options, "scaled region in pieces" );
+    PNGParserTestProbe( image, &file, &options, "scaled region" );
+    options.layout = PNGParser_Layout_Morton;
+    options.tileSize = 1u << ( PNGParserTestRandom() % 5u );
+    PNGParserTestTiles( image, &file, &options, "scaled region in Morton tiles" );
+    options.scale = PNGParser_Scale_Full;
+    memset( &options.region, 0, sizeof( options.region ) );
+
+    options.layout = PNGParser_Layout_Tiled;
+    options.tileSize = 1u + PNGParserTestRandom() % 12u;
+    PNGParserTestTiles( image, &file, &options, "tiles" );
+    options.layout = PNGParser_Layout_Morton;
+    options.tileSize = 1u << ( PNGParserTestRandom() % 5u );
+    PNGParserTestTiles( image, &file, &options, "Morton tiles" );
+    options.layout = PNGParser_Layout_Linear;
+    options.tileSize = PNGPARSER_TILE_DEFAULT_SIZE;
+
+    /* The formats override the palette and 16 bit modes, so the indices have to be expanded anyway. */
+    for ( uint32_t format = PNGParser_Format_RGBA8; format <= PNGParser_Format_BGR8; format++ )
+    {
+        options.outputFormat = ( PNGParserOutputFormatType ) format;
+        PNGParserTestDecode( image, &file, &options, sPNGParserTestFormatNames[ format ] );
+        PNGParserTestDecodeInPieces( image, &file, &options, sPNGParserTestFormatNames[ format ] );
+        PNGParserTestProbe( image, &file, &options, sPNGParserTestFormatNames[ format ] );
+        PNGParserTestRows( image, &file, &options, sPNGParserTestFormatNames[ format ] );
+    }
+
+    /* Every sample type planar and interleaved, with a scale and bias of each channel that normalize it. */
+    PNGParserGetDefaultOptions( &options );
+    for ( uint32_t c = 0; c < 4u; c++ )
+    {
+        options.sampleScale[ c ] = ( float ) ( 1u + PNGParserTestRandom() % 1000u ) / 250.0f;
+        options.sampleBias[ c ] = ( float ) ( PNGParserTestRandom() % 1000u ) / 500.0f - 1.0f;
+    }
+    for ( uint32_t sampleType = PNGParser_Sample_Integer; sampleType <= PNGParser_Sample_Float16; sampleType++ )
+    {
+        options.sampleType = ( PNGParserSampleType ) sampleType;
+        options.planar = ( PNGParser_Sample_Integer == sampleType ) ? TRUE : ( BOOL ) ( PNGParserTestRandom() & 1u );
+        PNGParserTestTensor( image, &file, &options, sPNGParserTestSampleTypeNames[ sampleType ] );
+        PNGParserTestRows( image, &file, &options, sPNGParserTestSampleTypeNames[ sampleType ] );
+    }
+    /* A tensor takes the place of tiles, downscaled in a region and in an output format too. */
+    options.layout = PNGParser_Layout_Tiled;
+    options.scale = PNGParser_Scale_Half;
+    options.region.x = PNGParserTestRandom() % image->width;
+    options.region.width = image->width;
+    options.region.height = image->height;
+    options.outputFormat = PNGParser_Format_BGR8;
+    PNGParserTestTensor( image, &file, &options, "scaled region BGR8 tensor instead of tiles" );
+
+    free( file.data );
+}
+
+static void PNGParserTestExpectError( PNGParserTestBufferType* file, const PNGParserOptionsType* options,
+                                      PNGParserResultType expected, const char* name )
+{
+    PNGImage decoded;
+    memset( &decoded, 0, sizeof( decoded ) );
+    PNGParserResultType result = PNGParseWithOptions( file->data, file->length, &decoded, options );
+    PNGPARSER_TEST_CHECK( expected == result, "%s: result %d, expected %d", name, result, expected );
+    if ( PNGParser_Result_OK == result )
+    {
+        PNGImageFreeWithAllocator( &options->allocator, decoded.data, decoded.length );
+    }
+}
+
+static void PNGParserTestErrors( void )
+{
+    PNGParserTestImageType image;
+    PNGParserTestCreateImage( &image, 2u, 8u, 9u, 7u, 0u );
+    PNGParserTestBufferType file = { NULL, 0, 0 };
+    PNGParserTestBufferType broken = { NULL, 0, 0 };
+    PNGParserTestEncode( &image, &file, PNGPARSER_TEST_IDAT_RANDOM );
+    PNGParserOptionsType options;
+    PNGParserGetDefaultOptions( &options );
+    uint32_t header = PNGParserTestFindChunk( &file, "IHDR" );
+    uint32_t headerEnd = header + PNGPARSER_TEST_CHUNK_OVERHEAD + PNGPARSER_IHDR_LENGTH;
+    const uint8_t gamma[ 4 ] = { 0, 0, 0xB1, 0x8F };
+
+    broken.length = 0;
+    PNGParserTestAppend( &broken, file.data, file.length );
+    broken.data[ 1 ] ^= 0x20u;
+    PNGParserTestExpectError( &broken, &options, PNGParser_Error_Wrong_Signature, "wrong signature" );
+    PNGParserTestExpectProbeError( &broken, &options, PNGParser_Error_Wrong_Signature, "wrong signature" );
+
+    /* The probe needs the signature and the whole IHDR. */
+    broken.length = 0;
+    PNGParserTestAppend( &broken, file.data, headerEnd );
+    PNGParserTestExpectProbeError( &broken, &options, PNGParser_Result_OK, "IHDR alone" );
+    broken.length = headerEnd - 1u;
+    PNGParserTestExpectProbeError( &broken, &options, PNGParser_Error_Buffer_Length, "IHDR cut short" );
+
+    broken.length = 0;
+    PNGParserTestAppend( &broken, file.data, file.length );
+    broken.data[ headerEnd - 1u ] ^= 0x01u;
+    PNGParserTestExpectProbeError( &broken, &options, PNGParser_Error_Corrupted_Data, "corrupted IHDR CRC" );
+    PNGParserTestExpectError( &broken, &options, PNGParser_Error_Corrupted_Data, "corrupted IHDR CRC" );
+    options.crcMode = PNGParser_CRC_Mode_Skip;
+    PNGParserTestExpectProbeError( &broken, &options, PNGParser_Result_OK, "corrupted IHDR CRC skipped" );
+    options.crcMode = PNGParser_CRC_Mode_Full;
+
+    /* A wrong IHDR length with a CRC that matches it. */
+    for ( uint32_t headerLength = PNGPARSER_IHDR_LENGTH - 1u; headerLength <= PNGPARSER_IHDR_LENGTH + 1u;
+          headerLength += 2u )
+    {
+        broken.length = 0;
+        PNGParserTestAppend( &broken, file.data, file.length );
+        broken.data[ header + 3u ] = ( uint8_t ) headerLength;
+        PNGParserTestUpdateCRC( &broken, header );
+        PNGParserTestExpectProbeError( &broken, &options, PNGParser_Error_Corrupted_Data, "wrong IHDR length" );
+        PNGParserTestExpectError( &broken, &options, PNGParser_Error_Corrupted_Data, "wrong IHDR length" );
+    }
+
+    /* The CRC of the last IDAT ends right before the 12 bytes of IEND. */
+    broken.length = 0;
+    PNGParserTestAppend( &broken, file.data, file.length );
+    broken.data[ broken.length - PNGPARSER_TEST_CHUNK_OVERHEAD - 1u ] ^= 0x10u;
+    for ( uint32_t crcMode = PNGParser_CRC_Mode_Full; crcMode <= PNGParser_CRC_Mode_Parallel; crcMode++ )
+    {
+        options.crcMode = ( PNGParserCRCModeType ) crcMode;
+        PNGParserTestExpectError( &broken, &options, PNGParser_Error_Corrupted_Data, "corrupted IDAT CRC" );
+        PNGImage decoded;
+        PNGParserResultType result = PNGParserTestFeed( &broken, &options, &decoded );
+        PNGPARSER_TEST_CHECK( PNGParser_Error_Corrupted_Data == result, "corrupted IDAT CRC in pieces, CRC mode %u: %d",
+                              crcMode, result );
+        if ( PNGParser_Result_OK == result )
+        {
+            PNGImageFreeWithAllocator( &options.allocator, decoded.data, decoded.length );
+        }
+    }
+    options.crcMode = PNGParser_CRC_Mode_Skip;
+    PNGParserTestDecode( &image, &broken, &options, "corrupted IDAT CRC skipped" );
+    options.crcMode = PNGParser_CRC_Mode_Full;
+
+    /* The Adler-32 is the last 4 bytes of the zlib stream, the chunk CRC is made to match so only zlib can tell. */
+    broken.length = 0;
+    PNGParserTestAppend( &broken, file.data, file.length );
+    uint32_t lastData = PNGParserTestFindChunk( &broken, "IDAT" );
+    broken.data[ lastData + 8u + PNGParserTestChunkLength( &broken, lastData ) - 1u ] ^= 0x01u;
+    PNGParserTestUpdateCRC( &broken, lastData );
+    PNGParserTestExpectError( &broken, &options, PNGParser_Error_During_Decompression, "corrupted Adler-32" );
+    options.checkAdler32 = FALSE;
+    PNGParserTestDecode( &image, &broken, &options, "corrupted Adler-32 unchecked" );
+    options.checkAdler32 = TRUE;
+
+    broken.length = 0;
+    PNGParserTestAppend( &broken, file.data, file.length );
+    PNGParserTestInsertChunk( &broken, header, "gAMA", gamma, sizeof( gamma ) );
+    PNGParserTestExpectError( &broken, &options, PNGParser_Error_Corrupted_Data, "chunk before IHDR" );
+
+    broken.length = 0;
+    PNGParserTestAppend( &broken, file.data, file.length );
+    PNGParserTestInsertChunk( &broken, headerEnd, "IHDR", file.data + header + 8u, PNGPARSER_IHDR_LENGTH );
+    PNGParserTestExpectError( &broken, &options, PNGParser_Error_Corrupted_Data, "second IHDR" );
+
+    /* Morton order needs a power of two, and no tile may be empty or larger than the maximum. */
+    const uint32_t tileSizes[][ 2 ] = { { PNGParser_Layout_Morton, 6u },
+                                        { PNGParser_Layout_Tiled, 0u },
+                                        { PNGParser_Layout_Tiled, PNGPARSER_TILE_MAX_SIZE + 1u } };
+    for ( uint32_t i = 0; i < sizeof( tileSizes ) / sizeof( tileSizes[ 0 ] ); i++ )
+    {
+        options.layout = ( PNGParserLayoutType ) tileSizes[ i ][ 0 ];
+        options.tileSize = tileSizes[ i ][ 1 ];
+        PNGParserTestExpectError( &file, &options, PNGParser_Error_Tile_Size, "wrong tile size" );
+        PNGParserTestExpectProbeError( &file, &options, PNGParser_Error_Tile_Size, "wrong tile size" );
+    }
+    options.layout = PNGParser_Layout_Tiled;
+    options.tileSize = 6u;
+    PNGParserTestDecode( &image, &file, &options, "tiles of 6" );
+    options.layout = PNGParser_Layout_Linear;
+    options.tileSize = PNGPARSER_TILE_DEFAULT_SIZE;
+
+    broken.length = 0;
+    PNGParserTestAppend( &broken, file.data, file.length - PNGPARSER_TEST_CHUNK_OVERHEAD - 1u );
+    PNGParserTestExpectError( &broken, &options, PNGParser_Error_Buffer_Length, "file cut short" );
+
+    PNGImage decoded;
+    memset( &decoded, 0, sizeof( decoded ) );
+    PNGParser* parser = PNGParserCreateWithOptions( &options );
+    PNGParserResultType result = PNGParserFeed( parser, broken.data, broken.length );
+    PNGPARSER_TEST_CHECK( PNGParser_Result_OK == result, "fed file cut short: result %d", result );
+    result = PNGParserFinish( parser, &decoded );
+    PNGPARSER_TEST_CHECK( PNGParser_Error_Buffer_Length == result, "finished file cut short: result %d", result );
+
+    free( broken.data );
+    free( file.data );
+    free( image.samples );
+}
+
+/**
+ * @brief Decodes images that alternate between large and small with one decoder, so its buffers both grow and get
+ *        reused for smaller images, with a corrupted file in between.
+ */
+/**
+ * @brief A region has to start inside the image, and the IDAT chunk its last row ends in is still checked while the
+ *        chunks after it are not read.
+ */
+static void PNGParserTestRegionErrors( uint8_t interlaceMethod )
+{
+    /* Random samples do not compress, so the first rows end in the first of several IDAT chunks. */
+    PNGParserTestImageType image;
+    PNGParserTestCreateImage( &image, 2u, 8u, 64u, 64u, interlaceMethod );
+    PNGParserTestBufferType file = { NULL, 0, 0 };
+    PNGParserTestBufferType broken = { NULL, 0, 0 };
+    PNGParserTestEncode( &image, &file, PNGPARSER_TEST_REGION_IDAT_LENGTH );
+    PNGParserOptionsType options;
+    PNGParserGetDefaultOptions( &options );
+
+    options.region.x = image.width;
+    options.region.width = 1u;
+    options.region.height = 1u;
+    PNGParserTestExpectError( &file, &options, PNGParser_Error_Region_Outside_Image, "region right of the image" );
+    PNGParserTestExpectProbeError( &file, &options, PNGParser_Error_Region_Outside_Image, "region right of the image" );
+    options.region.x = 0;
+    options.region.y = image.height;
+    PNGParserTestExpectError( &file, &options, PNGParser_Error_Region_Outside_Image, "region below the image" );
+
+    /* The top left pixel comes first in an interlaced image as well, so either region ends in the first IDAT. */
+    options.region.y = 0;
+    options.region.width = interlaceMethod ? 1u : image.width;
+    options.region.height = 1u;
+    /* An RGB image has no PLTE, so its first IDAT follows IHDR. */
+    uint32_t first = PNGPARSER_TEST_SIGNATURE_LENGTH + PNGPARSER_TEST_CHUNK_OVERHEAD + PNGPARSER_IHDR_LENGTH;
+    uint32_t firstCRC = first + 8u + PNGParserTestChunkLength( &file, first );
+    PNGParserTestAppend( &broken, file.data, file.length );
+    broken.data[ firstCRC ] ^= 0x01u;
+    PNGParserTestExpectError( &broken, &options, PNGParser_Error_Corrupted_Data, "region ending in a corrupted IDAT" );
+    options.crcMode = PNGParser_CRC_Mode_Skip;
+    PNGParserTestDecode( &image, &broken, &options, "region ending in a corrupted IDAT, CRC skipped" );
+    options.crcMode = PNGParser_CRC_Mode_Full;
+
+    /* Nothing after the IDAT the region ends in is read, not even IEND. */
+    broken.length = 0;
+    PNGParserTestAppend( &broken, file.data, file.length );
+    broken.data[ broken.length - PNGPARSER_TEST_CHUNK_OVERHEAD - 1u ] ^= 0x01u;
+    broken.data[ broken.length - 1u ] ^= 0x01u;
+    PNGParserTestDecode( &image, &broken, &options, "region before a corrupted IDAT" );
+    broken.length = firstCRC + 4u;
+    PNGParserTestDecode( &image, &broken, &options, "region before the end of the file" );
+    options.region.height = image.height;
+    PNGParserTestExpectError( &broken, &options, PNGParser_Error_Buffer_Length, "region past the end of the file" );
+
+    free( broken.data );
+    free( file.data );
+    free( image.samples );
+}
+
+static void PNGParserTestDecoder( PNGParserCRCModeType crcMode )
+{
+    PNGParserOptionsType options;
+    PNGParserGetDefaultOptions( &options );
+    options.crcMode = crcMode;
+    PNGDecoder* decoder = PNGDecoderCreate( &options );
+    PNGPARSER_TEST_CHECK( NULL != decoder, "no decoder" );
+    if ( NULL == decoder ) { return; }
+
+    PNGParserTestBufferType file = { NULL, 0, 0 };
+    for ( uint32_t i = 0; i < PNGPARSER_TEST_DECODER_IMAGES; i++ )
+    {
+        uint32_t format = PNGParserTestRandom() % PNGPARSER_TEST_FORMAT_COUNT;
+        uint32_t width = ( i & 1u ) ? 1u + PNGParserTestRandom() % 4u : PNGPARSER_TEST_MAX_WIDTH - i;
+        uint32_t height = ( i & 1u ) ? 1u + PNGParserTestRandom() % 4u : PNGPARSER_TEST_MAX_HEIGHT - i / 2u;
+        PNGParserTestImageType image;
+        PNGParserTestCreateImage( &image, sPNGParserTestFormats[ format ][ 0 ], sPNGParserTestFormats[ format ][ 1 ],
+                                  width, height, ( uint8_t ) ( ( i >> 1 ) & 1u ) );
+        PNGParserTestEncode( &image, &file, PNGPARSER_TEST_IDAT_RANDOM );
+
+        PNGImage decoded;
+        memset( &decoded, 0, sizeof( decoded ) );
+        if ( 5u == i )
+        {
+            file.data[ file.length - PNGPARSER_TEST_CHUNK_OVERHEAD - 1u ] ^= 0x10u;
+            PNGParserResultType result = PNGDecoderDecode( decoder, file.data, file.length, &decoded );
+            PNGPARSER_TEST_CHECK( PNGParser_Error_Corrupted_Data == result, "decoder, corrupted IDAT CRC: %d",
+                                  result );
+        }
+        else if ( 2u == i % 3u )
+        {
+            PNGParserTestOutputType expected;
+            PNGParserTestReference( &image, &options, &expected );
+            uint8_t* destination = PNGParserTestAllocate( expected.length );
+            PNGParserResultType result = PNGDecoderDecodeInto( decoder, file.data, file.length, &decoded, destination,
+                                                               expected.length, 0u );
+            PNGParserTestCheck( &image, &options, result, &decoded, "decoder into" );
+            free( destination );
+            free( expected.data );
+        }
+        else if ( 1u == i % 3u )
+        {
+            PNGParserTestOutputType expected;
+            PNGParserTestReference( &image, &options, &expected );
+            PNGParserTestRowsType rows = { &expected, 0, TRUE };
+            PNGParserResultType result =
+                    PNGDecoderDecodeRows( decoder, file.data, file.length, &decoded, PNGParserTestOnRow, &rows );
+            PNGParserTestCheckRows( &image, &rows, result, &decoded, "decoder rows" );
+            free( expected.data );
+        }
+        else
+        {
+            PNGParserResultType result = PNGDecoderDecode( decoder, file.data, file.length, &decoded );
+            PNGParserTestCheck( &image, &options, result, &decoded, "decoder" );
+        }
+        free( image.samples );
+    }
+    free( file.data );
+    PNGDecoderDestroy( decoder );
+}
+
+static void* PNGParserTestAllocatorAllocate( void* context, uint32_t size )
+{
+    PNGParserTestAllocatorType* allocator = ( PNGParserTestAllocatorType* ) context;
+    if ( ++allocator->calls == allocator->failAt ) { return NULL; }
+    allocator->live++;
+    allocator->bytes += size;
+    if ( allocator->bytes > allocator->peakBytes ) { allocator->peakBytes = allocator->bytes; }
+    return PNGParserTestAllocate( size );
+}
+
+static void* PNGParserTestAllocatorReallocate( void* context, void* pointer, uint32_t oldSize, uint32_t newSize )
+{
+    PNGParserTestAllocatorType* allocator = ( PNGParserTestAllocatorType* ) context;
+    if ( ++allocator->calls == allocator->failAt ) { return NULL; }
+    if ( NULL == pointer ) { allocator->live++; }
+    allocator->bytes += ( uint64_t ) newSize - oldSize;
+    if ( allocator->bytes > allocator->peakBytes ) { allocator->peakBytes = allocator->bytes; }
+    return realloc( pointer, newSize ? newSize : 1u );
+}
+
+static void PNGParserTestAllocatorFree( void* context, void* pointer, uint32_t size )
+{
+    PNGParserTestAllocatorType* allocator = ( PNGParserTestAllocatorType* ) context;
+    allocator->live--;
+    allocator->bytes -= size;
+    free( pointer );
+}
+
+static void PNGParserTestAllocators( uint8_t interlaceMethod )
+{
+    PNGParserTestImageType image;
+    PNGParserTestCreateImage( &image, 6u, 8u, PNGPARSER_TEST_MAX_WIDTH, PNGPARSER_TEST_MAX_HEIGHT, interlaceMethod );
+    PNGParserTestBufferType file = { NULL, 0, 0 };
+    PNGParserTestEncode( &image, &file, PNGPARSER_TEST_IDAT_RANDOM );
+    PNGParserOptionsType options;
+    PNGParserGetDefaultOptions( &options );
+
+    /* Fail each allocation in turn until the decode needs no more, every failure has to give back the rest. */
+    PNGParserTestAllocatorType counter = { 0, 0, 0, 0, 0 };
+    options.allocator.allocate = PNGParserTestAllocatorAllocate;
+    options.allocator.reallocate = PNGParserTestAllocatorReallocate;
+    options.allocator.free = PNGParserTestAllocatorFree;
+    options.allocator.context = &counter;
+    PNGParserResultType result = PNGParser_Error_Allocating_Memory;
+    for ( uint32_t failAt = 1; PNGParser_Error_Allocating_Memory == result; failAt++ )
+    {
+        counter.calls = 0;
+        counter.failAt = failAt;
+        PNGImage decoded;
+        memset( &decoded, 0, sizeof( decoded ) );
+        result = PNGParseWithOptions( file.data, file.length, &decoded, &options );
+        if ( PNGParser_Error_Allocating_Memory == result )
+        {
+            PNGPARSER_TEST_CHECK( 0 == counter.live, "allocation %u failed: %d blocks left", failAt, counter.live );
+        }
+        else
+        {
+            PNGPARSER_TEST_CHECK( failAt > counter.calls, "allocation %u of %u failed: %d", failAt, counter.calls,
+                                  result );
+            PNGParserTestCheck( &image, &options, result, &decoded, "counted allocator" );
+            PNGImageFreeWithAllocator( &options.allocator, decoded.data, decoded.length );
+            PNGPARSER_TEST_CHECK( 0 == counter.live && 0 == counter.bytes, "counted allocator: %d blocks left",
+                                  counter.live );
+
+            /* The probe is what the budget is checked against, the decode must not allocate more. */
+            PNGProbe probe;
+            PNGParseHeader( file.data, file.length, &probe, &options );
+            PNGPARSER_TEST_CHECK( counter.peakBytes <= probe.scratchBytes + probe.outputBytes,
+                                  "counted allocator: %u bytes at the peak, %u probed",
+                                  ( uint32_t ) counter.peakBytes,
+                                  ( uint32_t ) ( probe.scratchBytes + probe.outputBytes ) );
+        }
+    }
+
+    PNGParserArenaType arena;
+    uint8_t* memory = PNGParserTestAllocate( PNGPARSER_TEST_ARENA_CAPACITY );
+    PNGParserArenaInit( &arena, memory, PNGPARSER_TEST_ARENA_CAPACITY );
+    PNGParserGetArenaAllocator( &arena, &options.allocator );
+    PNGParserTestDecode( &image, &file, &options, "arena" );
+    PNGParserArenaReset( &arena );
+    PNGParserTestDecode( &image, &file, &options, "arena after reset" );
+
+    PNGParserArenaInit( &arena, memory, image.width * image.height * image.channels );
+    PNGParserTestExpectError( &file, &options, PNGParser_Error_Allocating_Memory, "arena too small" );
+
+    free( memory );
+    free( file.data );
+    free( image.samples );
+}
@@ -0,0 +1,324 @@
+/**
+ * @file
+ * @author Krusto Stoyanov ( k.stoianov2@gmail.com )
+ * @brief 
+ * @version 1.0
+ * @date 
+ * 
+ * @section LICENSE
+ * MIT License
+ * 
+ * Copyright (c) 2024 Krusto
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * @section DESCRIPTION
+ * 
+ * PNGParser Kernel Tests, every CPU level against the scalar kernels
+ */
+
+
+/***********************************************************************************************************************
+Includes
+***********************************************************************************************************************/
+#include "PNGParserTest.h"
+
+#include "PNGParserCPU.h"
+
+/***********************************************************************************************************************
+Macro definitions
+***********************************************************************************************************************/
+/* Past the widest vector loop of every kernel, so each one runs its main loop, its tail and rows shorter than a
+ * vector. */
+#define PNGPARSER_TEST_MAX_COUNT 200u
+
+/***********************************************************************************************************************
+Static variables
+***********************************************************************************************************************/
+static const uint32_t sPNGParserTestBytesPerPixel[ PNGPARSER_FILTER_BPP_COUNT ] = { 1u, 2u, 3u, 4u, 6u, 8u };
+static const uint32_t sPNGParserTestUnpackDepths[ PNGPARSER_UNPACK_DEPTH_COUNT ] = { 1u, 2u, 4u };
+static const uint32_t sPNGParserTestFormatChannels[ PNGPARSER_OUTPUT_FORMAT_COUNT ] = { 4u, 4u, 3u, 3u };
+static const uint32_t sPNGParserTestSampleTypeBytes[ PNGPARSER_SAMPLE_TYPE_COUNT ] = { 0u, 4u, 2u };
+
+/***********************************************************************************************************************
+Static function Prototypes
+***********************************************************************************************************************/
+static void PNGParserTestUnfilter( const PNGParserKernelsType* scalar, const PNGParserKernelsType* kernels );
+static void PNGParserTestUnpack( const PNGParserKernelsType* scalar, const PNGParserKernelsType* kernels );
+static void PNGParserTestSixteenBit( const PNGParserKernelsType* scalar, const PNGParserKernelsType* kernels );
+static void PNGParserTestPalette( const PNGParserKernelsType* scalar, const PNGParserKernelsType* kernels );
+static void PNGParserTestFormat( const PNGParserKernelsType* scalar, const PNGParserKernelsType* kernels );
+static void PNGParserTestTensor( const PNGParserKernelsType* scalar, const PNGParserKernelsType* kernels );
+
+/***********************************************************************************************************************
+Implementation
+***********************************************************************************************************************/
+int main( void )
+{
+    PNGParserInitCPU( PNGParser_CPU_Level_Scalar );
+    PNGParserKernelsType scalar = *PNGParserGetKernels();
+
+    for ( uint32_t level = PNGParser_CPU_Level_SSE2; level <= PNGParser_CPU_Level_AVX512; level++ )
+    {
+        PNGParserCPULevelType picked = PNGParserInitCPU( ( PNGParserCPULevelType ) level );
+        if ( picked != level )
+        {
+            /* A lower level than asked for has already been compared. */
+            printf( "%s: not supported by this CPU\n", sPNGParserTestLevelNames[ level ] );
+            continue;
+        }
+        const PNGParserKernelsType* kernels = PNGParserGetKernels();
+        uint32_t failures = sPNGParserTestFailures;
+        PNGPARSER_TEST_CHECK( kernels->level == picked, "%s: kernels of level %u in use",
+                              sPNGParserTestLevelNames[ level ], kernels->level );
+
+        PNGParserTestUnfilter( &scalar, kernels );
+        PNGParserTestUnpack( &scalar, kernels );
+        PNGParserTestSixteenBit( &scalar, kernels );
+        PNGParserTestPalette( &scalar, kernels );
+        PNGParserTestFormat( &scalar, kernels );
+        PNGParserTestTensor( &scalar, kernels );
+
+        printf( "%s: %s\n", sPNGParserTestLevelNames[ level ],
+                ( failures == sPNGParserTestFailures ) ? "ok" : "failed" );
+    }
+    PNGParserInitCPU( PNGParser_CPU_Level_Auto );
+
+    return PNGParserTestReport( "Kernels" );
+}
+
+static void PNGParserTestUnfilter( const PNGParserKernelsType* scalar, const PNGParserKernelsType* kernels )
+{
+    for ( uint32_t bppIndex = 0; bppIndex < PNGPARSER_FILTER_BPP_COUNT; bppIndex++ )
+    {
+        uint32_t bpp = sPNGParserTestBytesPerPixel[ bppIndex ];
+        PNGPARSER_TEST_CHECK( PNGParserFilterBppIndex( bpp ) == bppIndex, "bpp %u has index %u", bpp,
+                              PNGParserFilterBppIndex( bpp ) );
+
+        for ( uint32_t filter = 0; filter < PNGPARSER_FILTER_COUNT; filter++ )
+        {
+            PNGParserUnfilterRowFunction reference = scalar->unfilter.unfilter[ bppIndex ][ filter ];
+            PNGParserUnfilterRowFunction kernel = kernels->unfilter.unfilter[ bppIndex ][ filter ];
+
+            for ( uint32_t pixels = 1; pixels <= PNGPARSER_TEST_MAX_COUNT; pixels++ )
+            {
+                uint32_t length = pixels * bpp;
+                uint8_t* previous = PNGParserTestAllocate( length );
+                uint8_t* expected = PNGParserTestAllocate( length );
+                uint8_t* actual = PNGParserTestAllocate( length );
+                PNGParserTestFill( previous, length );
+                PNGParserTestFill( expected, length );
+                memcpy( actual, expected, length );
+
+                reference( expected, previous, length );
+                kernel( actual, previous, length );
+                PNGPARSER_TEST_CHECK( 0 == memcmp( expected, actual, length ), "unfilter %u bpp %u length %u", filter,
+                                      bpp, length );
+
+                free( previous );
+                free( expected );
+                free( actual );
+            }
+        }
+    }
+}
+
+static void PNGParserTestUnpack( const PNGParserKernelsType* scalar, const PNGParserKernelsType* kernels )
+{
+    uint8_t map[ PNGPARSER_SAMPLE_MAP_LENGTH ];
+    PNGParserTestFill( map, sizeof( map ) );
+
+    for ( uint32_t depthIndex = 0; depthIndex < PNGPARSER_UNPACK_DEPTH_COUNT; depthIndex++ )
+    {
+        uint32_t bitDepth = sPNGParserTestUnpackDepths[ depthIndex ];
+        for ( uint32_t count = 0; count <= PNGPARSER_TEST_MAX_COUNT; count++ )
+        {
+            uint32_t rowLength = ( count * bitDepth + 7u ) / 8u;
+            uint8_t* row = PNGParserTestAllocate( rowLength );
+            uint8_t* expected = PNGParserTestAllocate( count );
+            uint8_t* actual = PNGParserTestAllocate( count );
+            PNGParserTestFill( row, rowLength );
+
+            scalar->pixel.unpack[ depthIndex ]( expected, row, count, map );
+            kernels->pixel.unpack[ depthIndex ]( actual, row, count, map );
+            PNGPARSER_TEST_CHECK( 0 == memcmp( expected, actual, count ), "unpack depth %u count %u", bitDepth, count );
+
+            free( row );
+            free( expected );
+            free( actual );
+        }
+    }
+}
+
+static void PNGParserTestSixteenBit( const PNGParserKernelsType* scalar, const PNGParserKernelsType* kernels )
+{
+    for ( uint32_t count = 0; count <= PNGPARSER_TEST_MAX_COUNT; count++ )
+    {
+        uint32_t length = count * 2u;
+        uint8_t* row = PNGParserTestAllocate( length );
+        uint8_t* expected = PNGParserTestAllocate( length );
+        uint8_t* actual = PNGParserTestAllocate( length );
+        PNGParserTestFill( row, length );
+
+        scalar->pixel.swap16( expected, row, count );
+        kernels->pixel.swap16( actual, row, count );
+        PNGPARSER_TEST_CHECK( 0 == memcmp( expected, actual, length ), "swap16 count %u", count );
+
+        scalar->pixel.narrow16( expected, row, count );
+        kernels->pixel.narrow16( actual, row, count );
+        PNGPARSER_TEST_CHECK( 0 == memcmp( expected, actual, count ), "narrow16 count %u", count );
+
+        free( row );
+        free( expected );
+        free( actual );
+    }
+}
+
+static void PNGParserTestPalette( const PNGParserKernelsType* scalar, const PNGParserKernelsType* kernels )
+{
+    uint8_t palette[ PNGPARSER_PALETTE_MAX_ENTRIES * 4u ];
+    PNGParserTestFill( palette, sizeof( palette ) );
+
+    for ( uint32_t channels = 3; channels <= 4; channels++ )
+    {
+        BOOL rgb = ( 3u == channels );
+        PNGParserPaletteRowFunction reference = rgb ? scalar->pixel.paletteRGB : scalar->pixel.paletteRGBA;
+        PNGParserPaletteRowFunction kernel = rgb ? kernels->pixel.paletteRGB : kernels->pixel.paletteRGBA;
+
+        for ( uint32_t count = 0; count <= PNGPARSER_TEST_MAX_COUNT; count++ )
+        {
+            uint32_t length = count * channels;
+            uint8_t* indices = PNGParserTestAllocate( count );
+            uint8_t* expected = PNGParserTestAllocate( length );
+            uint8_t* actual = PNGParserTestAllocate( length );
+            PNGParserTestFill( indices, count );
+
+            reference( expected, indices, count, palette );
+            kernel( actual, indices, count, palette );
+            PNGPARSER_TEST_CHECK( 0 == memcmp( expected, actual, length ), "palette %u channels count %u", channels,
+                                  count );
+
+            /* In place, the way the parser expands a row, with the indices at the end of the output. */
+            memset( actual, 0, length );
+            if ( count ) { memcpy( actual + length - count, indices, count ); }
+            kernel( actual, actual + length - count, count, palette );
+            PNGPARSER_TEST_CHECK( 0 == memcmp( expected, actual, length ), "in place palette %u channels count %u",
+                                  channels, count );
+
+            free( indices );
+            free( expected );
+            free( actual );
+        }
+    }
+}
+
+static void PNGParserTestFormat( const PNGParserKernelsType* scalar, const PNGParserKernelsType* kernels )
+{
+    for ( uint32_t bytes = 1; bytes <= 2; bytes++ )
+    {
+        for ( uint32_t channels = 1; channels <= 4; channels++ )
+        {
+            for ( uint32_t format = 0; format < PNGPARSER_OUTPUT_FORMAT_COUNT; format++ )
+            {
+                PNGParserFormatRowFunction reference = scalar->pixel.format[ bytes - 1u ][ channels - 1u ][ format ];
+                PNGParserFormatRowFunction kernel = kernels->pixel.format[ bytes - 1u ][ channels - 1u ][ format ];
+
+                for ( uint32_t count = 0; count <= PNGPARSER_TEST_MAX_COUNT; count++ )
+                {
+                    uint32_t rowLength = count * channels * bytes;
+                    uint32_t length = count * sPNGParserTestFormatChannels[ format ];
+                    uint8_t* row = PNGParserTestAllocate( rowLength );
+                    uint8_t* expected = PNGParserTestAllocate( length );
+                    uint8_t* actual = PNGParserTestAllocate( length );
+                    PNGParserTestFill( row, rowLength );
+
+                    reference( expected, row, count );
+                    kernel( actual, row, count );
+                    PNGPARSER_TEST_CHECK( 0 == memcmp( expected, actual, length ),
+                                          "format %u from %u channels of %u bytes count %u", format + 1u, channels,
+                                          bytes, count );
+
+                    free( row );
+                    free( expected );
+                    free( actual );
+                }
+            }
+        }
+    }
+}
+
+static void PNGParserTestTensor( const PNGParserKernelsType* scalar, const PNGParserKernelsType* kernels )
+{
+    float scale[ PNGPARSER_TENSOR_PATTERN_LENGTH ];
+    float bias[ PNGPARSER_TENSOR_PATTERN_LENGTH ];
+
+    for ( uint32_t bytes = 1; bytes <= 2; bytes++ )
+    {
+        for ( uint32_t channels = 1; channels <= 4; channels++ )
+        {
+            /* One value per channel repeated over the pattern, the way the parser fills it. */
+            for ( uint32_t i = 0; i < PNGPARSER_TENSOR_PATTERN_LENGTH; i++ )
+            {
+                if ( i < channels )
+                {
+                    scale[ i ] = ( float ) ( PNGParserTestRandom() % 1000u ) / ( 1u == bytes ? 255.0f : 65535.0f );
+                    bias[ i ] = ( float ) ( PNGParserTestRandom() % 1000u ) / 500.0f - 1.0f;
+                }
+                else
+                {
+                    scale[ i ] = scale[ i - channels ];
+                    bias[ i ] = bias[ i - channels ];
+                }
+            }
+
+            for ( uint32_t planar = 0; planar <= 1; planar++ )
+            {
+                for ( uint32_t type = 0; type < PNGPARSER_SAMPLE_TYPE_COUNT; type++ )
+                {
+                    PNGParserTensorRowFunction reference =
+                            scalar->pixel.tensor[ bytes - 1u ][ channels - 1u ][ planar ][ type ];
+                    PNGParserTensorRowFunction kernel =
+                            kernels->pixel.tensor[ bytes - 1u ][ channels - 1u ][ planar ][ type ];
+                    uint32_t sampleBytes = type ? sPNGParserTestSampleTypeBytes[ type ] : bytes;
+
+                    for ( uint32_t count = 0; count <= PNGPARSER_TEST_MAX_COUNT; count++ )
+                    {
+                        uint32_t rowLength = count * channels * bytes;
+                        uint32_t planeBytes = count * sampleBytes;
+                        uint32_t length = planeBytes * channels;
+                        uint8_t* row = PNGParserTestAllocate( rowLength );
+                        uint8_t* expected = PNGParserTestAllocate( length );
+                        uint8_t* actual = PNGParserTestAllocate( length );
+                        PNGParserTestFill( row, rowLength );
+
+                        reference( expected, planeBytes, row, count, scale, bias );
+                        kernel( actual, planeBytes, row, count, scale, bias );
+                        PNGPARSER_TEST_CHECK( 0 == memcmp( expected, actual, length ),
+                                              "tensor type %u planar %u from %u channels of %u bytes count %u", type,
+                                              planar, channels, bytes, count );
+
+                        free( row );
+                        free( expected );
+                        free( actual );
+                    }
+                }
+            }
+        }
+    }
+}